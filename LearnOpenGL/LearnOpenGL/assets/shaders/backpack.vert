@@ -5,7 +5,17 @@ layout (location = 2) in vec2 aTexCoords;
 
 out vec2 TexCoords;
 
-uniform mat4 u_camera; // Projection * view
+layout (std140) uniform FrameData
+{
+   mat4 u_view;
+   mat4 u_projection;
+   mat4 u_camera; // Projection * view
+   vec3 u_viewPos;
+   float u_time;
+   uvec4 u_clusterCount;
+   vec4 u_clusterScale;
+};
+
 uniform mat4 u_model;
 
 void main()
@@ -1,8 +1,10 @@
 #version 330 core
 #define normalise normalize
 
-const int NR_POINT_LIGHTS = 10;
-const int NR_SPOT_LIGHTS = 10;
+// Must match LightRegistry
+const int MAX_POINT_LIGHTS = 192;
+const int MAX_SPOT_LIGHTS = 32;
+const uint SPOT_BIT = 0x8000u; // Set on cluster indices of spot lights
 
 // I/O
 out vec4 FragCol;
@@ -16,58 +18,54 @@ struct Material {
 	float shininess;
 };
 
-struct Colour {
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
+// A point or spot light, packed into vec4s to keep the std140 layout simple
+struct Light {
+	vec4 colour;
+	vec4 position;	// w is the linear attenuation
+	vec4 direction;	// w is the quadratic attenuation
+	vec4 cone;		// x is the cosine of the cutoff, y is the sine of the blur
 };
 
-struct LightDirectional {
-	Colour colour;
-	vec4 direction;
-};
-
-struct LightPoint {
-	Colour colour;
-	vec4 position;
-	float linear;
-	float quadratic;
+layout (std140) uniform FrameData
+{
+	mat4 u_view;
+	mat4 u_projection;
+	mat4 u_camera; // Projection * view
+	vec3 u_viewPos;
+	float u_time;
+	uvec4 u_clusterCount;	// Tiles across, tiles up, depth slices, then whether clustered shading is on
+	vec4 u_clusterScale;	// Pixels to tiles in xy, log of depth to slice in zw
 };
 
-struct LightSpot {
-	Colour colour;
-	vec4 position;
-	vec4 direction;
-	float linear;
-	float quadratic;
-	float cutoff;
-	float blur;
+layout (std140) uniform LightData
+{
+	vec4 u_directionalColour;	// a is the ambient strength
+	vec4 u_directionalDirection;
+	uvec4 u_lightCounts;		// x is the point lights, y is the spot lights
+	Light u_pointLights[MAX_POINT_LIGHTS];
+	Light u_spotLights[MAX_SPOT_LIGHTS];
 };
 
-uniform vec3 u_viewPos;
 uniform Material u_material;
-
-uniform LightDirectional u_directional;
-uniform LightPoint[NR_POINT_LIGHTS] u_pointLights;
-uniform LightSpot[NR_SPOT_LIGHTS] u_spotLights;
+uniform usamplerBuffer u_clusterGrid;		// The offset then count of each cell's lights
+uniform usamplerBuffer u_clusterIndices;	// Every cell's lights one after another
 
 vec3 m_normal;
 vec3 m_viewDir;
+vec3 m_diffuseTex;
+vec3 m_specularTex;
 
-vec3 PhongShading(Colour pColour, vec3 pLightDir, float pIntensity)
-{	
-	//Textures
-	vec3 diffuseTex = texture(u_material.texture_diffuse0, TexCoords).rgb;
-	vec3 specularTex = texture(u_material.texture_specular0, TexCoords).rgb;
+vec3 PhongShading(vec3 pAmbient, vec3 pColour, vec3 pLightDir, float pIntensity)
+{
 	// Diffuse shading
 	float diff = max(dot(m_normal, pLightDir), 0.0);
 	// Specular shading
 	vec3 reflectDir = reflect(-pLightDir, m_normal);
 	float spec = pow(max(dot(m_viewDir, reflectDir), 0.0), u_material.shininess);
 	// Combine results
-	vec3 ambient = pColour.ambient * diffuseTex;
-	vec3 diffuse = pColour.diffuse * diffuseTex * diff * pIntensity;
-	vec3 specular = pColour.specular * specularTex * spec * pIntensity;
+	vec3 ambient = pAmbient * m_diffuseTex;
+	vec3 diffuse = pColour * m_diffuseTex * diff * pIntensity;
+	vec3 specular = pColour * m_specularTex * spec * pIntensity;
 	return ambient + diffuse + specular;
 }
 
@@ -76,49 +74,39 @@ float CalculateAttentuation(float pDist, float pLinear, float pQuadratic)
 	return 1.0 / (1.0 + pLinear * pDist + pQuadratic * (pDist * pDist));
 }
 
-vec3 CalculateDirectionalLighting(LightDirectional pLight)
+vec3 CalculateDirectionalLighting()
 {
-	vec3 lightDir = normalise(u_directional.direction.xyz);
-	return PhongShading(pLight.colour, lightDir, 1);
+	vec3 lightDir = normalise(u_directionalDirection.xyz);
+	return PhongShading(u_directionalColour.rgb * u_directionalColour.a, u_directionalColour.rgb, lightDir, 1);
 }
 
-vec3 CalculatePointLight(LightPoint pLight)
+vec3 CalculatePointLight(Light pLight)
 {
-	// Skip over "dead" lights
-	if (length(pLight.linear) == 0)
-		return vec3(0);
-
-	// Point or spotlight
 	vec3 lightDiff = pLight.position.xyz - FragPos;
 	vec3 lightDir = normalise(lightDiff);
 	// Light fading over distance
 	float lightDist = length(lightDiff);
-	float attenuation = CalculateAttentuation(lightDist, pLight.linear, pLight.quadratic);
+	float attenuation = CalculateAttentuation(lightDist, pLight.position.w, pLight.direction.w);
 
-	return PhongShading(pLight.colour, lightDir, 1) * attenuation;
+	return PhongShading(vec3(0), pLight.colour.rgb, lightDir, 1) * attenuation;
 }
 
-vec3 CalculateSpotLight(LightSpot pLight)
+vec3 CalculateSpotLight(Light pLight)
 {
-	// Skip over "dead" lights
-	if (length(pLight.linear) == 0)
-		return vec3(0);
-
-	// Point or spotlight
 	vec3 lightDiff = pLight.position.xyz - FragPos;
 	vec3 lightDir = normalise(lightDiff);
 	// Light fading over distance
 	float lightDist = length(lightDiff);
-	float attenuation = CalculateAttentuation(lightDist, pLight.linear, pLight.quadratic);
+	float attenuation = CalculateAttentuation(lightDist, pLight.position.w, pLight.direction.w);
 
 	// Soft edges
-	float intensity = 1;
+	float cutoff = pLight.cone.x;
 	float theta = dot(lightDir, normalise(pLight.direction.xyz));
 	// l(1-c)+c scales light.blur from 0-1 to light.cutoff-1
-	float epsilon = (pLight.blur * (1 - pLight.cutoff) + pLight.cutoff) - pLight.cutoff;
-	intensity = clamp((theta - pLight.cutoff) / epsilon, 0.0, 1.0);
+	float epsilon = (pLight.cone.y * (1 - cutoff) + cutoff) - cutoff;
+	float intensity = clamp((theta - cutoff) / epsilon, 0.0, 1.0);
 
-	return PhongShading(pLight.colour, lightDir, intensity) * attenuation;
+	return PhongShading(vec3(0), pLight.colour.rgb, lightDir, intensity) * attenuation;
 }
 
 void main()
@@ -126,15 +114,40 @@ void main()
 	// Important vectors
 	m_normal = normalise(Normal);
 	m_viewDir = normalise(u_viewPos - FragPos);
+	// Sampled once instead of once per light
+	m_diffuseTex = texture(u_material.texture_diffuse0, TexCoords).rgb;
+	m_specularTex = texture(u_material.texture_specular0, TexCoords).rgb;
 
 	// Only one directional light allowed
-	vec3 result = CalculateDirectionalLighting(u_directional);
-
-	for (int i = 0; i < NR_POINT_LIGHTS; ++i)
-		result += CalculatePointLight(u_pointLights[i]);
-
-	for (int i = 0; i < NR_SPOT_LIGHTS; ++i)
-		result += CalculateSpotLight(u_spotLights[i]);
+	vec3 result = CalculateDirectionalLighting();
+
+	if (u_clusterCount.w != 0u)
+	{
+		// Only the lights binned into this fragment's cluster
+		uvec2 tile = min(uvec2(gl_FragCoord.xy * u_clusterScale.xy), u_clusterCount.xy - 1u);
+		float depth = -(u_view * vec4(FragPos, 1)).z;
+		int slice = clamp(int(floor(log(max(depth, 1e-4)) * u_clusterScale.z + u_clusterScale.w)), 0, int(u_clusterCount.z) - 1);
+		int cell = int(tile.x + tile.y * u_clusterCount.x) + slice * int(u_clusterCount.x * u_clusterCount.y);
+		uvec2 range = texelFetch(u_clusterGrid, cell).xy;
+
+		for (uint i = 0u; i < range.y; ++i)
+		{
+			uint index = texelFetch(u_clusterIndices, int(range.x + i)).x;
+			if ((index & SPOT_BIT) != 0u)
+				result += CalculateSpotLight(u_spotLights[index & ~SPOT_BIT]);
+			else
+				result += CalculatePointLight(u_pointLights[index]);
+		}
+	}
+	else
+	{
+		// Only the live lights are looped over
+		for (uint i = 0u; i < u_lightCounts.x; ++i)
+			result += CalculatePointLight(u_pointLights[i]);
+
+		for (uint i = 0u; i < u_lightCounts.y; ++i)
+			result += CalculateSpotLight(u_spotLights[i]);
+	}
 
 	FragCol = vec4(result, 1);
 	return;
@@ -6,8 +6,20 @@ layout (location = 2) in vec2 aTexCoords;
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+// Must come out the same as the depth pre-pass for its depth to test equal
+invariant gl_Position;
+
+layout (std140) uniform FrameData
+{
+   mat4 u_view;
+   mat4 u_projection;
+   mat4 u_camera; // Projection * view
+   vec3 u_viewPos;
+   float u_time;
+   uvec4 u_clusterCount;
+   vec4 u_clusterScale;
+};
 
-uniform mat4 u_camera; // Projection * view
 uniform mat4 u_model;
 uniform mat3 u_transposeInverseOfModel;
 
@@ -0,0 +1,97 @@
+#version 330 core
+#define normalise normalize
+
+// Must match LightRegistry
+const int MAX_POINT_LIGHTS = 192;
+const int MAX_SPOT_LIGHTS = 32;
+
+// I/O
+out vec4 FragCol;
+// A point or spot light, packed into vec4s to keep the std140 layout simple
+struct Light {
+	vec4 colour;
+	vec4 position;	// w is the linear attenuation
+	vec4 direction;	// w is the quadratic attenuation
+	vec4 cone;		// x is the cosine of the cutoff, y is the sine of the blur
+};
+
+layout (std140) uniform FrameData
+{
+	mat4 u_view;
+	mat4 u_projection;
+	mat4 u_camera; // Projection * view
+	vec3 u_viewPos;
+	float u_time;
+	uvec4 u_clusterCount;
+	vec4 u_clusterScale;
+};
+
+layout (std140) uniform LightData
+{
+	vec4 u_directionalColour;	// a is the ambient strength
+	vec4 u_directionalDirection;
+	uvec4 u_lightCounts;		// x is the point lights, y is the spot lights
+	Light u_pointLights[MAX_POINT_LIGHTS];
+	Light u_spotLights[MAX_SPOT_LIGHTS];
+};
+
+// Written by the geometry pass
+uniform sampler2D u_gAlbedoSpec;
+uniform sampler2D u_gNormal;
+uniform sampler2D u_gDepth;
+
+vec3 m_position;
+vec3 m_normal;
+vec3 m_viewDir;
+vec3 m_diffuseTex;
+float m_specular;
+float m_shininess;
+
+// Reads the surface under this pixel, false where nothing was drawn
+bool ReadSurface()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(u_gDepth, pixel, 0).r;
+	if (depth == 1.0)
+		return false;
+
+	// Back from the depth buffer to view space, then to world space. The view matrix only rotates and moves
+	// so its inverse is the transposed rotation
+	vec3 ndc = vec3(gl_FragCoord.xy / vec2(textureSize(u_gDepth, 0)), depth) * 2.0 - 1.0;
+	float viewZ = -u_projection[3][2] / (ndc.z + u_projection[2][2]);
+	vec3 viewPos = vec3(ndc.x * -viewZ / u_projection[0][0], ndc.y * -viewZ / u_projection[1][1], viewZ);
+	m_position = transpose(mat3(u_view)) * (viewPos - u_view[3].xyz);
+
+	vec4 albedoSpec = texelFetch(u_gAlbedoSpec, pixel, 0);
+	vec4 normal = texelFetch(u_gNormal, pixel, 0);
+	m_diffuseTex = albedoSpec.rgb;
+	m_specular = albedoSpec.a;
+	m_normal = normal.xyz;
+	m_shininess = normal.w;
+	m_viewDir = normalise(u_viewPos - m_position);
+	return true;
+}
+
+vec3 PhongShading(vec3 pAmbient, vec3 pColour, vec3 pLightDir, float pIntensity)
+{
+	// Diffuse shading
+	float diff = max(dot(m_normal, pLightDir), 0.0);
+	// Specular shading
+	vec3 reflectDir = reflect(-pLightDir, m_normal);
+	float spec = pow(max(dot(m_viewDir, reflectDir), 0.0), m_shininess);
+	// Combine results
+	vec3 ambient = pAmbient * m_diffuseTex;
+	vec3 diffuse = pColour * m_diffuseTex * diff * pIntensity;
+	vec3 specular = pColour * m_specular * spec * pIntensity;
+	return ambient + diffuse + specular;
+}
+
+void main()
+{
+	if (!ReadSurface())
+		discard;
+
+	// Only one directional light allowed, it also brings the ambient light
+	vec3 lightDir = normalise(u_directionalDirection.xyz);
+	FragCol = vec4(PhongShading(u_directionalColour.rgb * u_directionalColour.a, u_directionalColour.rgb, lightDir, 1), 1);
+}
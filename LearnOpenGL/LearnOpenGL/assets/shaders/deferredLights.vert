@@ -0,0 +1,55 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+flat out int LightIndex;	// Point lights first, then spot lights
+
+// Must match LightRegistry
+const int MAX_POINT_LIGHTS = 192;
+const int MAX_SPOT_LIGHTS = 32;
+
+struct Light {
+	vec4 colour;
+	vec4 position;	// w is the linear attenuation
+	vec4 direction;	// w is the quadratic attenuation
+	vec4 cone;		// x is the cosine of the cutoff, y is the sine of the blur
+};
+
+layout (std140) uniform FrameData
+{
+	mat4 u_view;
+	mat4 u_projection;
+	mat4 u_camera; // Projection * view
+	vec3 u_viewPos;
+	float u_time;
+	uvec4 u_clusterCount;
+	vec4 u_clusterScale;
+};
+
+layout (std140) uniform LightData
+{
+	vec4 u_directionalColour;	// a is the ambient strength
+	vec4 u_directionalDirection;
+	uvec4 u_lightCounts;		// x is the point lights, y is the spot lights
+	Light u_pointLights[MAX_POINT_LIGHTS];
+	Light u_spotLights[MAX_SPOT_LIGHTS];
+};
+
+// Where the light falls to 1/256 of its brightness, the same cutoff as LightClusters::GetLightRange
+float GetLightRange(float pLinear, float pQuadratic)
+{
+	if (pQuadratic > 0.0)
+		return (-pLinear + sqrt(pLinear * pLinear + 4.0 * pQuadratic * 255.0)) / (2.0 * pQuadratic);
+	return 255.0 / max(pLinear, 1e-4);
+}
+
+void main()
+{
+	// Every light is one instance of the volume
+	int points = int(u_lightCounts.x);
+	Light light = (gl_InstanceID < points ? u_pointLights[gl_InstanceID] : u_spotLights[gl_InstanceID - points]);
+	LightIndex = gl_InstanceID;
+
+	// The unit cube reaches half a unit each way so it is doubled to hold the whole range
+	vec3 position = light.position.xyz + aPos * 2.0 * GetLightRange(light.position.w, light.direction.w);
+	gl_Position = u_camera * vec4(position, 1.0);
+}
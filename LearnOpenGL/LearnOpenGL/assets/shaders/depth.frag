@@ -0,0 +1,6 @@
+#version 330 core
+
+// Only depth is written, colour writes are masked off
+void main()
+{
+}
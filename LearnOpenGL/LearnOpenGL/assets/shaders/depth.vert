@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// Must come out the same as the shading pass for its depth to test equal
+invariant gl_Position;
+
+layout (std140) uniform FrameData
+{
+   mat4 u_view;
+   mat4 u_projection;
+   mat4 u_camera; // Projection * view
+   vec3 u_viewPos;
+   float u_time;
+   uvec4 u_clusterCount;
+   vec4 u_clusterScale;
+};
+
+uniform mat4 u_model;
+
+void main()
+{
+   gl_Position = u_camera * u_model * vec4(aPos, 1.0);
+}
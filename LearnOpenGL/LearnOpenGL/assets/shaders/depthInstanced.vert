@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel; // Per instance, takes up locations 3 to 6
+
+// Must come out the same as the shading pass for its depth to test equal
+invariant gl_Position;
+
+layout (std140) uniform FrameData
+{
+   mat4 u_view;
+   mat4 u_projection;
+   mat4 u_camera; // Projection * view
+   vec3 u_viewPos;
+   float u_time;
+   uvec4 u_clusterCount;
+   vec4 u_clusterScale;
+};
+
+void main()
+{
+   vec4 worldPos = aModel * vec4(aPos, 1.0);
+   gl_Position = u_camera * worldPos;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+#define normalise normalize
+
+// Writes what the deferred light passes need to know about the nearest surface, lighting happens later
+layout (location = 0) out vec4 gAlbedoSpec;	// a is the specular strength
+layout (location = 1) out vec4 gNormal;		// World space, w is the shininess
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+struct Material {
+	sampler2D texture_diffuse0;
+	sampler2D texture_specular0;
+	float shininess;
+};
+
+uniform Material u_material;
+
+void main()
+{
+	gAlbedoSpec.rgb = texture(u_material.texture_diffuse0, TexCoords).rgb;
+	gAlbedoSpec.a = texture(u_material.texture_specular0, TexCoords).r;
+	gNormal = vec4(normalise(Normal), u_material.shininess);
+}
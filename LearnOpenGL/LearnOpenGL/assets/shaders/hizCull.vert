@@ -0,0 +1,60 @@
+#version 330 core
+layout (location = 0) in mat4 aModel; // One point per instance, takes up locations 0 to 3
+
+// I/O
+out mat4 CulledModel; // Captured with transform feedback at the same index as the copy
+
+uniform mat4 u_lastCamera;		// Projection * view of the frame the pyramid was built from
+uniform vec3 u_boundsMin;		// The mesh's box, in model space
+uniform vec3 u_boundsMax;
+uniform sampler2D u_pyramid;	// The farthest depth of each 2x2 pixels, then of each 2x2 of those, and so on
+uniform vec2 u_depthSize;		// Pixels of the depth buffer the first level was built from
+uniform int u_levels;
+
+bool IsVisible()
+{
+	vec3 nearest = vec3(1e30);
+	vec3 farthest = vec3(-1e30);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 corner = vec3((i & 1) != 0 ? u_boundsMax.x : u_boundsMin.x, (i & 2) != 0 ? u_boundsMax.y : u_boundsMin.y,
+			(i & 4) != 0 ? u_boundsMax.z : u_boundsMin.z);
+		vec4 clip = u_lastCamera * aModel * vec4(corner, 1.0);
+		// Reaching past the near plane, nothing can be in front of it
+		if (clip.w <= 0.0 || clip.z < -clip.w)
+			return true;
+		vec3 window = clip.xyz / clip.w * 0.5 + 0.5;
+		nearest = min(nearest, window);
+		farthest = max(farthest, window);
+	}
+
+	// Nothing is known about what was off screen last frame
+	vec2 pixelMin = nearest.xy * u_depthSize;
+	vec2 pixelMax = farthest.xy * u_depthSize;
+	if (any(lessThan(pixelMin, vec2(0.0))) || any(greaterThanEqual(pixelMax, u_depthSize)))
+		return true;
+
+	// The first level whose texels are at least as wide as the box, so 4 texels cover it
+	vec2 extent = pixelMax - pixelMin;
+	float span = max(extent.x, extent.y);
+	int level = 0;
+	while (float(2 << level) < span)
+	{
+		if (++level >= u_levels)
+			return true;
+	}
+
+	// Every level is the one before halved and rounded down, the same as shifting the full size
+	ivec2 size = max(ivec2(u_depthSize) >> (level + 1), ivec2(1));
+	ivec2 first = min(ivec2(pixelMin) >> (level + 1), size - 1);
+	ivec2 last = min(ivec2(pixelMax) >> (level + 1), size - 1);
+	float depth = max(max(texelFetch(u_pyramid, first, level).r, texelFetch(u_pyramid, ivec2(last.x, first.y), level).r),
+		max(texelFetch(u_pyramid, ivec2(first.x, last.y), level).r, texelFetch(u_pyramid, last, level).r));
+	return nearest.z <= depth;
+}
+
+void main()
+{
+	// A culled copy collapses to a point, so its triangles have no area and are never rasterised
+	CulledModel = (IsVisible() ? aModel : mat4(0.0));
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// I/O
+out float FragDepth;
+
+// The pyramid itself, or the depth buffer for the first level
+uniform sampler2D u_source;
+uniform int u_sourceLevel;	// The level below the one being drawn
+
+void main()
+{
+	ivec2 size = textureSize(u_source, u_sourceLevel);
+	ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+	// The last texel of an odd size has no pair of its own, the texel before folds it in
+	ivec2 last = ivec2(((size.x & 1) != 0 && base.x + 3 == size.x) ? 2 : 1, ((size.y & 1) != 0 && base.y + 3 == size.y) ? 2 : 1);
+
+	// The farthest depth of every texel covered
+	float depth = 0.0;
+	for (int y = 0; y <= last.y; ++y)
+	{
+		for (int x = 0; x <= last.x; ++x)
+			depth = max(depth, texelFetch(u_source, min(base + ivec2(x, y), size - 1), u_sourceLevel).r);
+	}
+	FragDepth = depth;
+}
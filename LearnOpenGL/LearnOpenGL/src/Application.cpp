@@ -1,10 +1,16 @@
 #pragma region
 #include "Application.hpp"
+#include "GLState.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers, must come before glfw
 #include <GLFW/glfw3.h>
-#include "glad/glad.h" // Include glad to get all the required OpenGL headers
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <Windows.h>	// Needed for Sleep()
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#ifdef _WIN32
+ #include <Windows.h>	// Needed for MoveWindow()
+#endif
 #ifdef _DEBUG
  #include <iostream>
  using std::cout;
@@ -14,8 +20,14 @@
 // Called when the user resizes the window
 void framebuffer_size_callback(GLFWwindow* pWindow, int pWidth, int pHeight)
 {
+	// The viewport is applied by the renderer, the context may be current on the render thread
 	Engine::Application::GetApplication()->SetDimensions(pWidth, pHeight);
-	glViewport(0, 0, pWidth, pHeight);
+}
+
+// Called when the window contents are damaged, such as being uncovered
+void window_refresh_callback(GLFWwindow* pWindow)
+{
+	Engine::Application::GetApplication()->RefreshCallback();
 }
 
 void mouse_callback(GLFWwindow* pWindow, double pPosX, double pPosY)
@@ -27,6 +39,11 @@ void scroll_callback(GLFWwindow* window, double pOffsetX, double pOffsetY)
 {
 	Engine::Application::GetApplication()->ScrollCallback(pOffsetX, pOffsetY);
 }
+
+void key_callback(GLFWwindow* pWindow, int pKey, int pScancode, int pAction, int pMods)
+{
+	Engine::Application::GetApplication()->KeyCallback(pKey, pAction);
+}
 #pragma endregion
 
 namespace Engine
@@ -61,16 +78,57 @@ namespace Engine
 
 		if (Init(pTitle, pFullscreen))
 		{
-			m_currentTime = glfwGetTime() - 0.02f;
+			// Replays keep their own clock, both runs animate from zero once the loop starts
+			m_currentTime = (m_inputRecorder.GetReplaying() ? 0.0 : GetTime() - 0.02f);
+			m_rendererInst->StartClock(m_currentTime);
 
 			const float radius = 10.0f;
 			const float speed = 0.5f;
 
+			// Baked offline so no frame waits on it, the loop never runs
+			if (m_pvsBake && !m_rendererInst->BakePvs())
+				std::fprintf(stderr, "Could not bake the potentially visible sets\n");
+
+			// The context can only be current on one thread, hand it over before the loop starts
+			if (m_renderThreaded)
+			{
+				MakeContextCurrent(false);
+				m_renderThread.Start([this] { MakeContextCurrent(true); },
+					[this](const FrameSnapshot& pSnapshot)
+					{
+						m_renderStats.BeginFrame();
+						m_renderStats.BeginPhase(FramePhase::GpuWait);
+						m_frameLimiter.WaitForFrame();
+						RenderFrame(pSnapshot, m_renderStats);
+						m_renderStats.EndFrame();
+					},
+					[this] { MakeContextCurrent(false); });
+			}
+
 			// Render loop
-			while (!glfwWindowShouldClose(m_window))
+			while (!ShouldClose())
 			{
+				m_benchmark.BeginFrame();
+				m_frameStats.BeginFrame();
+
+				// Holding back before input is read keeps the queued frames from adding to input latency.
+				// With a render thread the wait happens there and the snapshot slots pass it on
+				if (!m_renderThreaded)
+				{
+					m_frameStats.BeginPhase(FramePhase::GpuWait);
+					m_frameLimiter.WaitForFrame();
+					m_frameStats.EndPhase();
+				}
+
 				m_prevTime = m_currentTime;
-				m_currentTime = glfwGetTime();
+				if (m_inputRecorder.GetReplaying())
+				{
+					// Every frame gets the delta time it was recorded with, independent of how fast this machine is
+					m_inputRecorder.NextFrame(m_replayFrame);
+					m_currentTime += m_replayFrame.deltaTime;
+				}
+				else
+					m_currentTime = GetTime();
 				m_deltaTime = m_currentTime - m_prevTime;
 				m_fixedTimer += m_deltaTime;
 				m_frameTimer += m_deltaTime;
@@ -91,36 +149,114 @@ namespace Engine
 					}
 				}
 
-				// Input
-				glfwPollEvents();
-				ProcessInput();
-
-				// Calls fixed update 60 times per second
-				if (m_fixedTimer >= m_fixedDeltaTime)
+				// Input, there is none without a window. While idle the events were already collected by the wait
+				m_frameStats.BeginPhase(FramePhase::Input);
+				if (!m_headless && !m_idle)
+					glfwPollEvents();
+				if (!m_headless || m_inputRecorder.GetReplaying())
+					ProcessInput();
+				m_frameStats.EndPhase();
+
+				// Calls fixed update as many times as the simulation has fallen behind, up to the cap
+				m_frameStats.BeginPhase(FramePhase::FixedUpdate);
+				unsigned int fixedSteps = 0U;
+				while (m_fixedTimer >= m_fixedDeltaTime && fixedSteps < m_maxFixedSteps)
 				{
 					m_fixedTimer -= m_fixedDeltaTime;
 					FixedUpdate(m_fixedDeltaTime);
+					++fixedSteps;
 				}
+				m_frameStats.EndPhase();
 
+				// Anything still owed after the cap is dropped, the simulation slows down instead of never catching up
+				if (m_fixedTimer >= m_fixedDeltaTime)
+					m_fixedTimer = std::fmod(m_fixedTimer, m_fixedDeltaTime);
+				m_fixedAlpha = m_fixedTimer / m_fixedDeltaTime;
+
+				m_frameStats.BeginPhase(FramePhase::Update);
 				Update(m_deltaTime);
+				m_frameStats.EndPhase();
 
-				// Skip drawing if minimised, restricts fps to 15
-				if (glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) == GLFW_TRUE)
+				// Skip drawing if minimised. The frame isn't committed to the stats
+				if (!m_headless && glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) == GLFW_TRUE)
 				{
-					if (m_deltaTime < 50)
-						Sleep(50);
+					IdleWait(m_framePacer.GetIdleTimeout());
+					continue;
+				}
 
+				// Skip drawing and swapping if the last image is still correct, sleeping until input or the keepalive
+				if (!m_headless && !m_rendererInst->NeedsDraw(m_currentTime))
+				{
+					double untilKeepAlive = m_rendererInst->GetTimeUntilKeepAlive(m_currentTime);
+					IdleWait(std::min(m_framePacer.GetIdleTimeout(), untilKeepAlive));
 					continue;
 				}
 
-				m_rendererInst->Draw(m_currentTime);
+				m_frameStats.BeginPhase(FramePhase::Draw);
+				if (m_renderThreaded)
+				{
+					// Only builds the snapshot, waiting here means the render thread is a full frame behind
+					FrameSnapshot& snapshot = m_renderThread.BeginWrite();
+					// After the wait, the render thread may have held the frame back for a while
+					LatchCamera();
+					m_rendererInst->BuildSnapshot(snapshot, m_currentTime);
+					snapshot.frame = m_benchmark.GetFrameIndex();
+					m_renderThread.Publish();
+					m_frameStats.EndPhase();
+				}
+				else
+				{
+					FrameSnapshot& snapshot = m_rendererInst->m_snapshot;
+					LatchCamera();
+					m_rendererInst->BuildSnapshot(snapshot, m_currentTime);
+					snapshot.frame = m_benchmark.GetFrameIndex();
+					RenderFrame(snapshot, m_frameStats);
+				}
+
+				m_frameStats.EndFrame();
+				m_benchmark.EndFrame();
 
-				// Check and call events and swap the buffers
-				glfwSwapBuffers(m_window);
+				// Unfocused windows still draw but only wake for events or the idle rate
+				if (!m_headless && glfwGetWindowAttrib(m_window, GLFW_FOCUSED) == GLFW_FALSE)
+					IdleWait(m_framePacer.GetIdleTimeout());
+				else
+				{
+					m_idle = false;
+					m_framePacer.Wait();
+				}
 			}
 		}
 
+		// Finishes drawing whatever was published and takes the context back
+		if (m_renderThread.GetRunning())
+		{
+			m_renderThread.Stop();
+			MakeContextCurrent(true);
+		}
+
 		Shutdown();
+		m_inputRecorder.Finish();
+		// Every frame still in flight is waited on so its latency is included
+		m_frameLimiter.Destroy(m_gladLoaded);
+		// Average fps hides hitches so the percentiles are what gets reported
+		m_frameStats.PrintReport();
+		if (m_renderThreaded)
+			m_renderStats.PrintReport("Render thread timings");
+		m_frameLimiter.PrintReport();
+		m_framePacer.PrintReport();
+		GLState::PrintReport(m_frames);
+		m_rendererInst->PrintPrepassReport();
+		m_rendererInst->m_graph.PrintReport();
+		m_rendererInst->m_culler.PrintReport();
+		m_rendererInst->m_occlusion.PrintReport();
+		m_rendererInst->m_hiz.PrintReport();
+		m_rendererInst->m_pvs.PrintReport();
+		if (!m_statsPath.empty())
+			m_frameStats.WriteCsv(m_statsPath);
+		// Needs the context to still be alive to read back the gpu timings
+		m_benchmark.Destroy(m_gladLoaded);
+		if (m_headless)
+			m_headlessContext.Destroy();
 		glfwTerminate();
 
 		return;
@@ -128,11 +264,34 @@ namespace Engine
 
 	bool Application::Init(string pTitle, bool pFullscreen)
 	{
-		#ifdef _DEBUG
+		#if defined(_DEBUG) && defined(_WIN32)
 		 // Moves the console window
 		 MoveWindow(GetConsoleWindow(), -7, 0, 1000, 600, TRUE);
 		#endif
 
+		m_startTime = std::chrono::steady_clock::now();
+
+		if (m_headless)
+		{
+			// No glfw at all, the pbuffer stands in for the window
+			if (!m_headlessContext.Create(m_winWidth, m_winHeight))
+				return false;
+
+			if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::GetProcAddress))
+			{
+				#ifdef _DEBUG
+				 cout << "Failed to initialise GLAD" << endl;
+				#endif
+				return false;
+			}
+			m_gladLoaded = true;
+
+			m_rendererInst->Init((float)m_winWidth / (float)m_winHeight);
+			m_benchmark.Init();
+
+			return Startup();
+		}
+
 #pragma region glfw
 		// glfw: initialise and configure
 		if (glfwInit() == GLFW_FALSE)
@@ -177,14 +336,20 @@ namespace Engine
 		glfwSetWindowAspectRatio(m_window, 16, 9);
 
 		glfwSetFramebufferSizeCallback(m_window, framebuffer_size_callback);
+		glfwSetWindowRefreshCallback(m_window, window_refresh_callback);
 
 		glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 		glfwSetCursorPosCallback(m_window, mouse_callback);
-		glfwGetCursorPos(m_window, &m_mouseLastX, &m_mouseLastY);
+		{
+			double cursorX, cursorY;
+			glfwGetCursorPos(m_window, &cursorX, &cursorY);
+			m_inputInst->SetCursorOrigin(cursorX, cursorY);
+		}
 		if (glfwRawMouseMotionSupported())
 			glfwSetInputMode(m_window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
 
 		glfwSetScrollCallback(m_window, scroll_callback);
+		glfwSetKeyCallback(m_window, key_callback);
 
 		//glfwSetWindowAspectRatio(m_window, 16, 9);
 		//int* monCount = 0;
@@ -203,6 +368,7 @@ namespace Engine
 
 		// Initialises the renderer
 		m_rendererInst->Init((float)m_winWidth / (float)m_winHeight);
+		m_benchmark.Init();
 
 		// if (!Startup())
 		// 	return false;
@@ -216,28 +382,230 @@ namespace Engine
 	{
 		m_winWidth = pWidth;
 		m_winHeight = pHeight;
+		m_rendererInst->SetViewport(pWidth, pHeight);
 
 		if (m_rendererInst->m_cameraRef != nullptr && pWidth > 0 && pHeight > 0)
 			UpdateCamera();
 	}
 
+	void Application::SetHeadless(bool pValue)
+	{
+		m_headless = pValue;
+	}
+
+	void Application::SetBenchmark(unsigned int pFrames, double pSeconds, string pOutputPath)
+	{
+		m_benchmark.Enable(pFrames, pSeconds, pOutputPath);
+	}
+
+	void Application::SetFixedDeltaTime(double pFixedDeltaTime)
+	{
+		if (pFixedDeltaTime <= 0.0)
+			return;
+
+		m_fixedDeltaTime = pFixedDeltaTime;
+	}
+
+	void Application::SetMaxFixedSteps(unsigned int pMaxSteps)
+	{
+		m_maxFixedSteps = (pMaxSteps > 0U ? pMaxSteps : 1U);
+	}
+
+	void Application::SetTargetFrameRate(double pFramesPerSecond)
+	{
+		m_framePacer.SetTargetFrameRate(pFramesPerSecond);
+	}
+
+	void Application::SetIdleFrameRate(double pFramesPerSecond)
+	{
+		m_framePacer.SetIdleFrameRate(pFramesPerSecond);
+	}
+
+	void Application::SetRenderOnDemand(bool pValue, double pKeepAlive)
+	{
+		m_rendererInst->SetRenderOnDemand(pValue, pKeepAlive);
+	}
+
+	void Application::SetAnimating(bool pValue)
+	{
+		m_rendererInst->SetAnimating(pValue);
+	}
+
+	void Application::SetBoxCount(unsigned int pCount)
+	{
+		m_rendererInst->SetBoxCount(pCount);
+	}
+
+	void Application::SetPointLightCount(unsigned int pCount)
+	{
+		m_rendererInst->SetPointLightCount(pCount);
+	}
+
+	void Application::SetClustered(bool pValue)
+	{
+		m_rendererInst->SetClustered(pValue);
+	}
+
+	void Application::SetDeferred(bool pValue)
+	{
+		m_rendererInst->SetDeferred(pValue);
+	}
+
+	void Application::SetDepthPrepass(bool pValue)
+	{
+		m_rendererInst->SetDepthPrepass(pValue);
+	}
+
+	void Application::SetOcclusionCulling(bool pValue)
+	{
+		m_rendererInst->SetOcclusionCulling(pValue);
+	}
+
+	void Application::SetGpuOcclusion(bool pValue)
+	{
+		m_rendererInst->SetGpuOcclusion(pValue);
+	}
+
+	void Application::SetPvsCulling(bool pValue)
+	{
+		m_rendererInst->SetPvsCulling(pValue);
+	}
+
+	void Application::SetPvsBake(bool pValue)
+	{
+		m_pvsBake = pValue;
+	}
+
+	void Application::SetMaxFramesInFlight(unsigned int pFrames)
+	{
+		m_frameLimiter.SetMaxFramesInFlight(pFrames);
+	}
+
+	void Application::SetInputRecording(string pPath)
+	{
+		m_inputRecorder.StartRecording(pPath);
+	}
+
+	bool Application::SetInputReplay(string pPath)
+	{
+		return m_inputRecorder.LoadReplay(pPath);
+	}
+
+	void Application::SetLateLatch(bool pValue)
+	{
+		m_lateLatch = pValue;
+	}
+
+	void Application::SetRenderThreaded(bool pValue)
+	{
+		m_renderThreaded = pValue;
+	}
+
+	void Application::SetStatsOutput(string pPath)
+	{
+		m_statsPath = pPath;
+	}
+
 	void Application::UpdateCamera()
 	{
 		m_rendererInst->m_cameraRef->SetAspectRatio((float)m_winWidth / (float)m_winHeight);
 		m_rendererInst->m_cameraRef->UpdateFovV();
 	}
 
+	bool Application::ShouldClose()
+	{
+		if (m_pvsBake || m_benchmark.GetFinished() || m_inputRecorder.GetFinished())
+			return true;
+
+		if (m_headless)
+			return false;
+
+		return glfwWindowShouldClose(m_window);
+	}
+
+	void Application::IdleWait(double pTimeout)
+	{
+		// Any input wakes the loop straight away so this adds no latency
+		glfwWaitEventsTimeout(pTimeout);
+		m_idle = true;
+		// The paced deadline is stale after waiting, start over once active again
+		m_framePacer.Reset();
+	}
+
+	double Application::GetTime() const
+	{
+		if (!m_headless)
+			return glfwGetTime();
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	}
+
+	void Application::LatchCamera()
+	{
+		// Extra movement mid frame can't be recorded or replayed
+		if (!m_lateLatch || m_headless || m_inputRecorder.GetRecording() || m_inputRecorder.GetReplaying())
+			return;
+
+		// The cursor is disabled so its position only moves with events, any motion since the top of the
+		// frame is queued by the poll and turns the camera once
+		glfwPollEvents();
+		ApplyMouseLook(m_inputInst->LatchMouseDelta());
+	}
+
+	void Application::RenderFrame(const FrameSnapshot& pSnapshot, FrameStats& pStats)
+	{
+		pStats.BeginPhase(FramePhase::Draw);
+		m_benchmark.BeginGpu(pSnapshot.frame);
+		m_rendererInst->DrawSnapshot(pSnapshot);
+		m_benchmark.EndGpu();
+
+		// Swap the buffers then fence the frame so the cpu can't get too far ahead of it
+		pStats.BeginPhase(FramePhase::Swap);
+		if (m_headless)
+			m_headlessContext.SwapBuffers();
+		else
+			glfwSwapBuffers(m_window);
+		m_frameLimiter.EndFrame();
+		pStats.EndPhase();
+	}
+
+	void Application::MakeContextCurrent(bool pCurrent)
+	{
+		if (m_headless)
+			m_headlessContext.MakeCurrent(pCurrent);
+		else
+			glfwMakeContextCurrent(pCurrent ? m_window : nullptr);
+	}
+
 	void Application::MouseCallback(double pPosX, double pPosY)
 	{
-		double offsetX = pPosX - m_mouseLastX;
-		double offsetY = pPosY - m_mouseLastY;
-		m_mouseLastX = pPosX;
-		m_mouseLastY = pPosY;
+		// Only queued, the camera is turned once per frame from the summed movement
+		m_inputInst->PushCursor(pPosX, pPosY, glfwGetTime());
+	}
+
+	void Application::KeyCallback(int pKey, int pAction)
+	{
+		m_inputInst->PushKey(pKey, pAction != GLFW_RELEASE, glfwGetTime());
+	}
+
+	void Application::RefreshCallback()
+	{
+		m_rendererInst->MarkDirty();
+	}
+
+	void Application::ScrollCallback(double pOffsetX, double pOffsetY)
+	{
+		m_inputInst->PushScroll(pOffsetX, pOffsetY, glfwGetTime());
+	}
+
+	void Application::ApplyMouseLook(vec2 pDelta)
+	{
+		if (pDelta == vec2(0.0f))
+			return;
+
 		const double sens = 0.05f;
-		offsetX *= sens;
-		offsetY *= sens;
-		m_yaw += offsetX;
-		m_pitch += offsetY;
+		m_yaw += pDelta.x * sens;
+		m_pitch += pDelta.y * sens;
 		if (m_pitch > 89.0f)
 			m_pitch = 89.0f;
 		else if (m_pitch < -89.0f)
@@ -252,27 +620,38 @@ namespace Engine
 		vec3 right = glm::normalize(glm::cross(vec3(0, 1, 0), forward));
 		vec3 up = glm::cross(forward, right);
 
-		m_rendererInst->m_cameraRef->SetRight(right);
-		m_rendererInst->m_cameraRef->SetUp(up);
-		m_rendererInst->m_cameraRef->SetForward(forward);
-	}
-
-	void Application::ScrollCallback(double pOffsetX, double pOffsetY)
-	{
-		m_rendererInst->m_cameraRef->ModifyFovH((float)pOffsetY * -3.0f);
+		m_rendererInst->m_cameraRef->SetOrientation(right, up, forward);
 	}
 
 	void Application::ProcessInput()
 	{
+		// Resolve this frame's actions and movement from the queued events, or the recording
+		if (m_inputRecorder.GetReplaying())
+			m_inputInst->Apply(m_replayFrame);
+		else
+		{
+			m_inputInst->Update();
+			m_inputRecorder.RecordFrame(m_inputInst->Capture(m_deltaTime));
+		}
+		ApplyMouseLook(m_inputInst->GetMouseDelta());
+		if (m_inputInst->GetScroll().y != 0.0f)
+			m_rendererInst->m_cameraRef->ModifyFovH(m_inputInst->GetScroll().y * -3.0f);
+
 		// End application
-		if (glfwGetKey(m_window, GLFW_KEY_END) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::Quit) && m_window != nullptr)
 			glfwSetWindowShouldClose(m_window, true);
 		// Render triangles normally
-		if (glfwGetKey(m_window, GLFW_KEY_F1) == GLFW_PRESS)
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		if (m_inputInst->GetAction(Action::WireframeOff))
+			m_rendererInst->SetWireframe(false);
 		// Render triangles as lines
-		if (glfwGetKey(m_window, GLFW_KEY_F2) == GLFW_PRESS)
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		if (m_inputInst->GetAction(Action::WireframeOn))
+			m_rendererInst->SetWireframe(true);
+		// Light every surface with every light
+		if (m_inputInst->GetAction(Action::ForwardShading))
+			m_rendererInst->SetDeferred(false);
+		// Light surfaces after drawing them, each light only where it reaches
+		if (m_inputInst->GetAction(Action::DeferredShading))
+			m_rendererInst->SetDeferred(true);
 		// Toggle fullscreen
 		// if (glfwGetKey(m_window, GLFW_KEY_F11) == GLFW_PRESS)
 		// {
@@ -281,7 +660,7 @@ namespace Engine
 
 		const float spotlightSpeed = 0.005f;
 		// Spotlight cone
-		if (glfwGetKey(m_window, GLFW_KEY_T) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::SpotAngleUp))
 		{
 			Light* spotLight = m_rendererInst->m_lightSpot;
 			float current = spotLight->GetAngleRaw();
@@ -292,7 +671,7 @@ namespace Engine
 				//m_rendererInst->GetShaderAt(0U)->SetFloat("u_spotLights[0].cutoff", spotLight->GetAngle());
 			}
 		}
-		if (glfwGetKey(m_window, GLFW_KEY_G) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::SpotAngleDown))
 		{
 			Light* spotLight = m_rendererInst->m_lightSpot;
 			float current = spotLight->GetAngleRaw();
@@ -303,7 +682,7 @@ namespace Engine
 			}
 		}
 		// Blur
-		if (glfwGetKey(m_window, GLFW_KEY_Y) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::SpotBlurUp))
 		{
 			Light* spotLight = m_rendererInst->m_lightSpot;
 			float current = spotLight->GetBlurRaw();
@@ -313,7 +692,7 @@ namespace Engine
 				//m_rendererInst->GetShaderAt(0U)->SetFloat("u_spotLights[0].blur", spotLight->GetBlur());
 			}
 		}
-		if (glfwGetKey(m_window, GLFW_KEY_H) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::SpotBlurDown))
 		{
 			Light* spotLight = m_rendererInst->m_lightSpot;
 			float current = spotLight->GetBlurRaw();
@@ -326,30 +705,30 @@ namespace Engine
 
 		float moveSpeed = 8;
 		// SlowDown
-		if (glfwGetKey(m_window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::Slow))
 			moveSpeed *= 0.2f;
 		// SpeedUp
-		else if (glfwGetKey(m_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		else if (m_inputInst->GetAction(Action::Fast))
 			moveSpeed *= 3;
 
 		vec3 translation = vec3();
 		// Forwards
-		if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveForward))
 			translation += moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetForward();
 		// Backwards
-		if (glfwGetKey(m_window, GLFW_KEY_S) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveBack))
 			translation -= moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetForward();
 		// Left
-		if (glfwGetKey(m_window, GLFW_KEY_A) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveLeft))
 			translation += moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetRight();
 		// Right
-		if (glfwGetKey(m_window, GLFW_KEY_D) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveRight))
 			translation -= moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetRight();
 		// Up
-		if (glfwGetKey(m_window, GLFW_KEY_SPACE) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveUp))
 			translation += moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetUp();
 		// Down
-		if (glfwGetKey(m_window, GLFW_KEY_C) == GLFW_PRESS)
+		if (m_inputInst->GetAction(Action::MoveDown))
 			translation -= moveSpeed * (float)m_deltaTime * m_rendererInst->m_cameraRef->GetUp();
 
 		m_rendererInst->m_cameraRef->Translate(translation);
@@ -2,6 +2,12 @@
 #pragma once
 #include "Renderer.hpp"
 #include "Input.hpp"
+#include "Benchmark.hpp"
+#include "FrameStats.hpp"
+#include "FramePacer.hpp"
+#include "HeadlessContext.hpp"
+#include "RenderThread.hpp"
+#include "FrameLimiter.hpp"
 #pragma endregion
 
 namespace Engine
@@ -31,11 +37,173 @@ namespace Engine
 		 * @param pHeight The desired height in pixels of the window
 		 */
 		void SetDimensions(unsigned int pWidth, unsigned int pHeight);
+		/**
+		 * @brief Renders into an offscreen pbuffer instead of a window, must be called before Run()
+		 *
+		 * @param pValue Whether to run headless
+		 * @remark Requires a build with HEADLESS_EGL, input is ignored while headless
+		 */
+		void SetHeadless(bool pValue);
+		/**
+		 * @brief Records per-frame cpu and gpu timings and exits once a limit is reached,
+		 * must be called before Run()
+		 *
+		 * @param pFrames The amount of frames to run for, 0 for no limit
+		 * @param pSeconds The amount of seconds to run for, 0 for no limit
+		 * @param pOutputPath The file the json results are written to
+		 */
+		void SetBenchmark(unsigned int pFrames, double pSeconds, string pOutputPath);
+		/**
+		 * @brief Limits the frame rate, sleeping then spinning between frames instead of running flat out
+		 *
+		 * @param pFramesPerSecond The target frame rate, 0 for unlimited
+		 */
+		void SetTargetFrameRate(double pFramesPerSecond);
+		/**
+		 * @brief Sets how often the loop wakes without input while minimised or unfocused
+		 *
+		 * @param pFramesPerSecond The idle frame rate, 10 by default
+		 */
+		void SetIdleFrameRate(double pFramesPerSecond);
+		/**
+		 * @brief Only draws and swaps when the scene changes, for mostly static viewers
+		 *
+		 * @param pValue Whether render on demand is enabled
+		 * @param pKeepAlive The longest time in seconds between draws regardless of changes, 0 for no limit
+		 * @remark Ignored while headless so benchmarks always draw
+		 */
+		void SetRenderOnDemand(bool pValue, double pKeepAlive);
+		/**
+		 * @brief Pauses or resumes scene animations
+		 *
+		 * @param pValue Whether animations run
+		 */
+		void SetAnimating(bool pValue);
+		/**
+		 * @brief How many boxes the box scene draws, for stress testing
+		 *
+		 * @param pCount The amount of boxes, defaults to 10
+		 */
+		void SetBoxCount(unsigned int pCount);
+		/**
+		 * @brief How many point lights light the scene, for stress testing
+		 *
+		 * @param pCount The amount of point lights, defaults to 1
+		 */
+		void SetPointLightCount(unsigned int pCount);
+		/**
+		 * @brief Bins the lights into clusters of the view on the cpu so each fragment only shades the lights near it
+		 *
+		 * @param pValue Whether clustered shading is on
+		 */
+		void SetClustered(bool pValue);
+		/**
+		 * @brief Draws surfaces into a g-buffer first then lights them, each light only over the pixels its
+		 * volume covers. Can also be switched with F3 and F4 while running
+		 *
+		 * @param pValue Whether deferred shading is on
+		 */
+		void SetDeferred(bool pValue);
+		/**
+		 * @brief Draws the scene's depth with positions only before shading it, so each pixel is shaded once.
+		 * Reports how many fragments it saved on exit
+		 *
+		 * @param pValue Whether the depth pre-pass is on
+		 */
+		void SetDepthPrepass(bool pValue);
+		/**
+		 * @brief Rasterises the occluders at a low resolution on the cpu and skips whatever is hidden behind them
+		 * before it reaches gl. Reports how many boxes it skipped on exit
+		 *
+		 * @param pValue Whether occlusion culling is on
+		 */
+		void SetOcclusionCulling(bool pValue);
+		/**
+		 * @brief Tests instanced copies against a depth pyramid of the last frame in a vertex shader and draws the
+		 * culled ones as points, captured with transform feedback. Reports how many copies it culled on exit
+		 *
+		 * @param pValue Whether gpu occlusion culling is on
+		 */
+		void SetGpuOcclusion(bool pValue);
+		/**
+		 * @brief Skips whatever can't be seen from the camera's cell of a grid, using sets baked with SetPvsBake
+		 * and stored next to the scene. Reports how many were skipped on exit
+		 *
+		 * @param pValue Whether potentially visible sets are used
+		 */
+		void SetPvsCulling(bool pValue);
+		/**
+		 * @brief Bakes the scene's potentially visible sets once it is loaded and exits without drawing a frame
+		 *
+		 * @param pValue Whether to bake instead of running
+		 */
+		void SetPvsBake(bool pValue);
+		/**
+		 * @brief Limits how many frames the cpu can queue ahead of the gpu, lowering input latency with vsync off
+		 *
+		 * @param pFrames From 1 to 3, 0 for no limit
+		 */
+		void SetMaxFramesInFlight(unsigned int pFrames);
+		/**
+		 * @brief Records every frame's resolved input and delta time, written to a file on exit
+		 *
+		 * @param pPath The file the recording is written to
+		 */
+		void SetInputRecording(string pPath);
+		/**
+		 * @brief Drives the application from a recording instead of the window, with the recorded delta
+		 * times, and exits when it runs out. Works headless so benchmarks can follow the same path
+		 *
+		 * @param pPath The recording to play back
+		 * @return If the recording was loaded
+		 */
+		bool SetInputReplay(string pPath);
+		/**
+		 * @brief Processes cursor movement again directly before the frame's snapshot is built, so the view
+		 * matrix that gets uploaded doesn't miss motion from while update was running
+		 *
+		 * @param pValue Whether late latching is enabled
+		 * @remark Ignored while headless, recording or replaying
+		 */
+		void SetLateLatch(bool pValue);
+		/**
+		 * @brief Moves drawing and buffer swaps onto a render thread that owns the gl context,
+		 * so the next frame's update overlaps the last frame's submission. Must be called before Run()
+		 *
+		 * @param pValue Whether to use a render thread
+		 */
+		void SetRenderThreaded(bool pValue);
+		/**
+		 * @brief Sets where the per-phase frame timings are written as csv on exit
+		 *
+		 * @param pPath The file path, empty to only print the percentile report
+		 */
+		void SetStatsOutput(string pPath);
+
+		/**
+		 * @brief Sets how often FixedUpdate is called, independent of the frame rate
+		 *
+		 * @param pFixedDeltaTime The time in seconds between fixed updates
+		 */
+		void SetFixedDeltaTime(double pFixedDeltaTime);
+		/**
+		 * @brief Sets the most fixed updates that can run in a single frame, any backlog beyond that is dropped
+		 * so a slow frame can't cause a spiral of catch-up steps
+		 *
+		 * @param pMaxSteps The maximum amount of catch-up steps per frame, at least 1
+		 */
+		void SetMaxFixedSteps(unsigned int pMaxSteps);
+		double GetFixedDeltaTime() const { return m_fixedDeltaTime; }
+		/**
+		 * @brief How far between the last and next fixed update this frame is, from 0 to 1. Used in Update to
+		 * interpolate state that is only advanced in FixedUpdate
+		 */
+		double GetFixedAlpha() const { return m_fixedAlpha; }
 
 		void MouseCallback(double pPosX, double pPosY);
+		void KeyCallback(int pKey, int pAction);
 		void ScrollCallback(double pOffsetX, double pOffsetY);
-
-		const double m_fixedDeltaTime = 0.01666666666666666;
+		void RefreshCallback();
 
 	protected:
 		Application();
@@ -51,15 +219,15 @@ namespace Engine
 		 */
 		virtual void Shutdown() = 0;
 		/**
-		 * @brief Called once per frame
+		 * @brief Called once per frame, after any fixed updates
 		 *
 		 * @param pDeltaTime The time between frames
 		 */
 		virtual void Update(double pDeltaTime) = 0;
 		/**
-		 * @brief Called once every 60 seconds
+		 * @brief Called every m_fixedDeltaTime seconds of simulation, possibly several times in one frame
 		 *
-		 * @param pFixedDeltaTime The time between every fixed update, should be roughly 0.0166-
+		 * @param pFixedDeltaTime The time between every fixed update, 0.0166- by default
 		 */
 		virtual void FixedUpdate(double pFixedDeltaTime) = 0;
 		//virtual void LateUpdate(double pDeltaTime) = 0;
@@ -86,6 +254,44 @@ namespace Engine
 		 * @brief Updates the camera's aspect ratio and fov
 		 */
 		void UpdateCamera();
+		/**
+		 * @brief Whether the main loop should exit, either from the window closing or the benchmark finishing
+		 */
+		bool ShouldClose();
+		/**
+		 * @brief Blocks on window events for up to a timeout, used while minimised, unfocused or
+		 * while there is nothing new to draw
+		 *
+		 * @param pTimeout The longest time in seconds to wait
+		 */
+		void IdleWait(double pTimeout);
+		/**
+		 * @brief The time in seconds since initialisation, uses glfw unless headless
+		 */
+		double GetTime() const;
+		/**
+		 * @brief Re-samples the cursor and rebuilds the camera orientation if late latching is enabled
+		 */
+		void LatchCamera();
+		/**
+		 * @brief Turns the camera by an amount of cursor movement, rebuilding the view once
+		 *
+		 * @param pDelta The cursor movement in pixels
+		 */
+		void ApplyMouseLook(vec2 pDelta);
+		/**
+		 * @brief Draws and presents a snapshot, runs on the render thread when there is one
+		 *
+		 * @param pSnapshot The frame to draw
+		 * @param pStats The timings the draw and swap phases are added to
+		 */
+		void RenderFrame(const FrameSnapshot& pSnapshot, FrameStats& pStats);
+		/**
+		 * @brief Binds or releases the gl context on the calling thread
+		 *
+		 * @param pCurrent Whether to bind the context or release it
+		 */
+		void MakeContextCurrent(bool pCurrent);
 		/**
 		 * @brief Temporary local input prcoessing
 		 */
@@ -95,6 +301,23 @@ namespace Engine
 		GLFWwindow* m_window = nullptr;     // A reference to the window
 		Renderer* m_rendererInst = nullptr; // A reference to the renderer instance
 		Input* m_inputInst = nullptr;       // A reference to the input instance
+		HeadlessContext m_headlessContext;  // The offscreen context used instead of m_window when headless
+		Benchmark m_benchmark;              // Per-frame timings, only recorded when enabled
+		FrameStats m_frameStats;            // Ring buffer of per-phase timings for every drawn frame
+		FramePacer m_framePacer;            // Limits the frame rate when a target is set
+		RenderThread m_renderThread;        // Draws published snapshots when threaded rendering is enabled
+		FrameLimiter m_frameLimiter;        // Fences every frame when a frames in flight limit is set
+		FrameStats m_renderStats;           // Draw and swap timings taken on the render thread
+		bool m_renderThreaded = false;      // Whether drawing happens on m_renderThread
+		bool m_lateLatch = false;           // Whether the cursor is sampled again right before drawing
+		bool m_pvsBake = false;             // Whether to bake the potentially visible sets and exit
+		InputRecorder m_inputRecorder;      // Writes or plays back the per-frame input
+		InputFrame m_replayFrame;           // The recorded input of the frame in progress while replaying
+		bool m_idle = false;                // If the last frame ended waiting on events
+		string m_statsPath = "frame_stats.csv";
+
+		bool m_headless = false;                            // Whether to render offscreen without a window
+		std::chrono::steady_clock::time_point m_startTime;  // Used for timing when glfw isn't initialised
 
 		bool m_gladLoaded = false;                          // Whether glad has loaded or not
 		unsigned int m_winWidth = 0U, m_winHeight = 0U;     // The width and height of the window
@@ -103,8 +326,10 @@ namespace Engine
 		double m_currentTime = 0.0,
 		 m_prevTime = 0.0, m_deltaTime = 0.0;               // The time between rendered frames
 		double m_fixedTimer = 0.0f, m_frameTimer = 0.0f;     // Timers used for calling fixed update and displaying fps
+		double m_fixedDeltaTime = 1.0 / 60.0;               // The time between fixed updates
+		double m_fixedAlpha = 0.0;                          // The leftover of m_fixedTimer as a fraction of a fixed step
+		unsigned int m_maxFixedSteps = 5U;                  // The most fixed updates allowed in one frame
 
-		double m_mouseLastX = 400.0, m_mouseLastY = 300.0;  // Mouse position in the last frame
 		double m_yaw = 90.0, m_pitch = 0.0;                 // The rotation of the camera
 	};
 }
@@ -0,0 +1,172 @@
+#pragma region
+#include "Benchmark.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#include <fstream>
+#ifdef _DEBUG
+ #include <iostream>
+ using std::cout;
+ using std::endl;
+#endif
+
+using std::ofstream;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+#pragma endregion
+
+namespace Engine
+{
+	void Benchmark::Enable(unsigned int pFrames, double pSeconds, string pOutputPath)
+	{
+		m_enabled = true;
+		m_frameLimit = pFrames;
+		m_secondsLimit = pSeconds;
+		m_outputPath = pOutputPath;
+
+		// Avoids reallocating mid run when the length is known
+		if (m_frameLimit > 0U)
+		{
+			m_cpuMs.reserve(m_frameLimit);
+			m_gpuMs.reserve(m_frameLimit);
+		}
+	}
+
+	void Benchmark::Init()
+	{
+		if (!m_enabled)
+			return;
+
+		glGenQueries(s_queryCount, m_queries);
+		m_queriesCreated = true;
+
+		const GLubyte* renderer = glGetString(GL_RENDERER);
+		if (renderer != nullptr)
+			m_glRenderer = (const char*)renderer;
+
+		m_runStart = steady_clock::now();
+	}
+
+	void Benchmark::Destroy(bool pValidate)
+	{
+		if (!m_enabled)
+			return;
+
+		if (pValidate && m_queriesCreated)
+		{
+			// Whatever is still in flight is waited on so every frame has a gpu time
+			for (unsigned int i = 0; i < s_queryCount; ++i)
+				CollectQuery(i);
+			glDeleteQueries(s_queryCount, m_queries);
+			m_queriesCreated = false;
+		}
+
+		#ifdef _DEBUG
+		 if (WriteJson())
+		 	cout << "Benchmark written to \"" << m_outputPath << "\"" << endl;
+		 else
+		 	cout << "Failed to write benchmark to \"" << m_outputPath << "\"" << endl;
+		#else
+		 WriteJson();
+		#endif
+
+		m_enabled = false;
+	}
+
+	void Benchmark::BeginFrame()
+	{
+		if (!m_enabled)
+			return;
+
+		m_frameStart = steady_clock::now();
+	}
+
+	void Benchmark::BeginGpu(unsigned int pFrame)
+	{
+		if (!m_queriesCreated)
+			return;
+
+		unsigned int slot = pFrame % s_queryCount;
+		// The slot's previous query is s_queryCount frames old so this rarely stalls
+		CollectQuery(slot);
+		m_queryFrame[slot] = pFrame;
+		m_queryPending[slot] = true;
+		glBeginQuery(GL_TIME_ELAPSED, m_queries[slot]);
+	}
+
+	void Benchmark::EndGpu()
+	{
+		if (!m_queriesCreated)
+			return;
+
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+
+	void Benchmark::EndFrame()
+	{
+		if (!m_enabled)
+			return;
+
+		steady_clock::time_point now = steady_clock::now();
+		m_cpuMs.push_back(duration<double, std::milli>(now - m_frameStart).count());
+		m_elapsed = duration<double>(now - m_runStart).count();
+	}
+
+	bool Benchmark::GetFinished() const
+	{
+		if (!m_enabled)
+			return false;
+
+		if (m_frameLimit > 0U && m_cpuMs.size() >= m_frameLimit)
+			return true;
+
+		if (m_secondsLimit > 0.0 && m_elapsed >= m_secondsLimit)
+			return true;
+
+		return false;
+	}
+
+	void Benchmark::CollectQuery(unsigned int pSlot)
+	{
+		if (!m_queryPending[pSlot])
+			return;
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[pSlot], GL_QUERY_RESULT, &nanoseconds);
+		m_queryPending[pSlot] = false;
+
+		if (m_queryFrame[pSlot] >= m_gpuMs.size())
+			m_gpuMs.resize((size_t)m_queryFrame[pSlot] + 1U, -1.0);
+		m_gpuMs[m_queryFrame[pSlot]] = (double)nanoseconds * 1e-6;
+	}
+
+	bool Benchmark::WriteJson() const
+	{
+		ofstream outStream(m_outputPath);
+		if (!outStream.is_open())
+			return false;
+
+		double totalCpu = 0.0;
+		for (double cpuMs : m_cpuMs)
+			totalCpu += cpuMs;
+
+		outStream << "{\n";
+		outStream << "\t\"renderer\": \"" << m_glRenderer << "\",\n";
+		outStream << "\t\"frames\": " << m_cpuMs.size() << ",\n";
+		outStream << "\t\"seconds\": " << m_elapsed << ",\n";
+		outStream << "\t\"averageCpuMs\": " << (m_cpuMs.empty() ? 0.0 : totalCpu / m_cpuMs.size()) << ",\n";
+		outStream << "\t\"frameTimes\": [\n";
+		for (size_t i = 0; i < m_cpuMs.size(); ++i)
+		{
+			outStream << "\t\t{ \"frame\": " << i << ", \"cpuMs\": " << m_cpuMs[i] << ", \"gpuMs\": ";
+			// Null rather than a fake value if the query never resolved
+			if (i >= m_gpuMs.size() || m_gpuMs[i] < 0.0)
+				outStream << "null";
+			else
+				outStream << m_gpuMs[i];
+			outStream << (i + 1 < m_cpuMs.size() ? " },\n" : " }\n");
+		}
+		outStream << "\t]\n";
+		outStream << "}\n";
+
+		return true;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma region
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+
+using std::string;
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	// Records per-frame cpu and gpu timings for a fixed length run and writes them out as json
+	class Benchmark
+	{
+	public:
+		Benchmark() = default;
+		~Benchmark() {}
+
+		/**
+		 * @brief Enables the benchmark, the run ends when either limit is reached
+		 *
+		 * @param pFrames The amount of frames to record, 0 for no limit
+		 * @param pSeconds The amount of seconds to record, 0 for no limit
+		 * @param pOutputPath The file the json results are written to
+		 */
+		void Enable(unsigned int pFrames, double pSeconds, string pOutputPath);
+		/**
+		 * @brief Creates the timer queries, must be called after glad has loaded
+		 */
+		void Init();
+		/**
+		 * @brief Collects any outstanding gpu timings, writes the results and releases the queries
+		 *
+		 * @param pValidate Whether the gl context was ever initialised
+		 */
+		void Destroy(bool pValidate);
+
+		/**
+		 * @brief Marks the start of a frame on the cpu
+		 */
+		void BeginFrame();
+		/**
+		 * @brief Starts the gpu timer, call directly before submitting draw calls
+		 *
+		 * @param pFrame The frame being drawn, from GetFrameIndex() when that frame began.
+		 * The draw may happen on another thread after the frame has ended on this one
+		 */
+		void BeginGpu(unsigned int pFrame);
+		/**
+		 * @brief Stops the gpu timer, call directly after submitting draw calls
+		 */
+		void EndGpu();
+		/**
+		 * @brief Marks the end of a frame on the cpu, call after the buffers have been swapped
+		 */
+		void EndFrame();
+
+		bool GetEnabled() const { return m_enabled; }
+		/**
+		 * @brief The index of the frame in progress
+		 */
+		unsigned int GetFrameIndex() const { return (unsigned int)m_cpuMs.size(); }
+		/**
+		 * @brief Whether the frame or time limit has been reached
+		 */
+		bool GetFinished() const;
+
+	private:
+		/**
+		 * @brief Reads back the timer query held in a slot into its frame record
+		 *
+		 * @param pSlot The slot in the query ring
+		 */
+		void CollectQuery(unsigned int pSlot);
+		/**
+		 * @brief Writes all frame records to m_outputPath
+		 *
+		 * @return If the file was written
+		 */
+		bool WriteJson() const;
+
+		static const unsigned int s_queryCount = 4U;	// Frames the gpu timing may lag behind the cpu
+
+		bool m_enabled = false, m_queriesCreated = false;
+		unsigned int m_frameLimit = 0U;
+		double m_secondsLimit = 0.0;
+		string m_outputPath;
+
+		unsigned int m_queries[s_queryCount] = {};	// Ring of GL_TIME_ELAPSED queries
+		unsigned int m_queryFrame[s_queryCount] = {};	// The frame each query slot was issued for
+		bool m_queryPending[s_queryCount] = {};
+
+		std::chrono::steady_clock::time_point m_runStart, m_frameStart;
+		double m_elapsed = 0.0;
+		vector<double> m_cpuMs;		// Cpu milliseconds, only touched by the thread running the main loop
+		vector<double> m_gpuMs;		// Gpu milliseconds, only touched by the thread owning the context. Negative until read back
+		string m_glRenderer;
+	};
+}
@@ -0,0 +1,66 @@
+#pragma region
+#pragma once
+#include "glm/glm.hpp"
+#include <cmath>
+#include <limits>
+
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+#pragma endregion
+
+namespace Engine
+{
+	// An axis aligned box, starts inverted so the first point grown into it becomes both corners
+	struct AABB
+	{
+		vec3 min = vec3(std::numeric_limits<float>::max());
+		vec3 max = vec3(-std::numeric_limits<float>::max());
+
+		bool IsEmpty() const { return min.x > max.x; }
+		vec3 GetCentre() const { return (min + max) * 0.5f; }
+		vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+		void Grow(const vec3& pPoint)
+		{
+			min = glm::min(min, pPoint);
+			max = glm::max(max, pPoint);
+		}
+
+		void Grow(const AABB& pOther)
+		{
+			if (pOther.IsEmpty())
+				return;
+			min = glm::min(min, pOther.min);
+			max = glm::max(max, pOther.max);
+		}
+
+		/**
+		 * @brief The box around this one once transformed, the extents are projected onto each new axis
+		 *
+		 * @param pMatrix An affine transform
+		 * @return The transformed box
+		 */
+		AABB Transformed(const mat4& pMatrix) const
+		{
+			vec3 centre = vec3(pMatrix * vec4(GetCentre(), 1.0f));
+			vec3 extents = GetExtents();
+			vec3 size = vec3(
+				std::abs(pMatrix[0][0]) * extents.x + std::abs(pMatrix[1][0]) * extents.y + std::abs(pMatrix[2][0]) * extents.z,
+				std::abs(pMatrix[0][1]) * extents.x + std::abs(pMatrix[1][1]) * extents.y + std::abs(pMatrix[2][1]) * extents.z,
+				std::abs(pMatrix[0][2]) * extents.x + std::abs(pMatrix[1][2]) * extents.y + std::abs(pMatrix[2][2]) * extents.z);
+
+			AABB box;
+			box.min = centre - size;
+			box.max = centre + size;
+			return box;
+		}
+	};
+
+	// A sphere around a set of points, centred on their box so it is cheap to build
+	struct BoundingSphere
+	{
+		vec3 centre = vec3(0.0f);
+		float radius = 0.0f;
+	};
+}
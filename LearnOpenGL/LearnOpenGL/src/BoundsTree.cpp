@@ -0,0 +1,386 @@
+#pragma region
+#include "BoundsTree.hpp"
+#include <algorithm>
+#pragma endregion
+
+namespace Engine
+{
+	// Static
+	const float BoundsTree::s_margin = 0.1f;
+
+	/**
+	 * @brief The box around two others
+	 */
+	static AABB Union(const AABB& pA, const AABB& pB)
+	{
+		AABB box;
+		box.min = glm::min(pA.min, pB.min);
+		box.max = glm::max(pA.max, pB.max);
+		return box;
+	}
+
+	/**
+	 * @brief The surface area of a box, how likely a random ray or query is to hit it
+	 */
+	static float Area(const AABB& pBox)
+	{
+		vec3 size = pBox.max - pBox.min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/**
+	 * @brief Whether one box is entirely inside another
+	 */
+	static bool Contains(const AABB& pOuter, const AABB& pInner)
+	{
+		return pOuter.min.x <= pInner.min.x && pOuter.min.y <= pInner.min.y && pOuter.min.z <= pInner.min.z
+			&& pInner.max.x <= pOuter.max.x && pInner.max.y <= pOuter.max.y && pInner.max.z <= pOuter.max.z;
+	}
+
+	/**
+	 * @brief Whether two boxes share any space
+	 */
+	static bool Overlaps(const AABB& pA, const AABB& pB)
+	{
+		return pA.min.x <= pB.max.x && pB.min.x <= pA.max.x && pA.min.y <= pB.max.y && pB.min.y <= pA.max.y
+			&& pA.min.z <= pB.max.z && pB.min.z <= pA.max.z;
+	}
+
+	/**
+	 * @brief How far along a ray it enters a box, 0 if it starts inside, or past the length if it misses
+	 */
+	static float EntryDistance(const AABB& pBox, const vec3& pOrigin, const vec3& pInverseDirection, float pLength)
+	{
+		// The slabs between each pair of faces, a direction of 0 divides to infinity and never narrows its slab
+		vec3 t0 = (pBox.min - pOrigin) * pInverseDirection;
+		vec3 t1 = (pBox.max - pOrigin) * pInverseDirection;
+		vec3 near = glm::min(t0, t1), far = glm::max(t0, t1);
+		float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+		float exit = std::min(std::min(far.x, far.y), std::min(far.z, pLength));
+		return (entry <= exit ? entry : std::numeric_limits<float>::max());
+	}
+
+	unsigned int BoundsTree::Insert(const AABB& pBox, unsigned int pUserData)
+	{
+		unsigned int leaf = AllocateNode();
+		Node& node = m_nodes[leaf];
+		node.box.min = pBox.min - vec3(s_margin);
+		node.box.max = pBox.max + vec3(s_margin);
+		node.userData = pUserData;
+		node.height = 0;
+		InsertLeaf(leaf);
+		++m_leafCount;
+		return leaf;
+	}
+
+	void BoundsTree::Remove(unsigned int pLeaf)
+	{
+		RemoveLeaf(pLeaf);
+		FreeNode(pLeaf);
+		--m_leafCount;
+	}
+
+	bool BoundsTree::Move(unsigned int pLeaf, const AABB& pBox)
+	{
+		if (Contains(m_nodes[pLeaf].box, pBox))
+			return false;
+
+		RemoveLeaf(pLeaf);
+		m_nodes[pLeaf].box.min = pBox.min - vec3(s_margin);
+		m_nodes[pLeaf].box.max = pBox.max + vec3(s_margin);
+		InsertLeaf(pLeaf);
+		return true;
+	}
+
+	void BoundsTree::Clear()
+	{
+		m_nodes.clear();
+		m_root = m_freeList = s_null;
+		m_leafCount = 0U;
+	}
+
+	void BoundsTree::QueryFrustum(const FrustumCuller& pFrustum, vector<unsigned int>& pOut) const
+	{
+		if (m_root == s_null)
+			return;
+
+		// Nodes found fully inside have the top bit set, everything under them is taken without testing
+		const unsigned int inside = 0x80000000U;
+		vector<unsigned int> stack;
+		stack.reserve(64U);
+		stack.push_back(m_root);
+		while (!stack.empty())
+		{
+			unsigned int entry = stack.back();
+			stack.pop_back();
+			const Node& node = m_nodes[entry & ~inside];
+
+			unsigned int flag = entry & inside;
+			if (flag == 0U)
+			{
+				Containment containment = pFrustum.Classify(node.box);
+				if (containment == Containment::Outside)
+					continue;
+				if (containment == Containment::Inside)
+					flag = inside;
+			}
+
+			if (node.IsLeaf())
+				pOut.push_back(node.userData);
+			else
+			{
+				stack.push_back(node.left | flag);
+				stack.push_back(node.right | flag);
+			}
+		}
+	}
+
+	void BoundsTree::QueryBox(const AABB& pBox, vector<unsigned int>& pOut) const
+	{
+		if (m_root == s_null)
+			return;
+
+		vector<unsigned int> stack;
+		stack.reserve(64U);
+		stack.push_back(m_root);
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!Overlaps(node.box, pBox))
+				continue;
+
+			if (node.IsLeaf())
+				pOut.push_back(node.userData);
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	void BoundsTree::QueryRange(const vec3& pCentre, float pRadius, vector<unsigned int>& pOut) const
+	{
+		if (m_root == s_null)
+			return;
+
+		vector<unsigned int> stack;
+		stack.reserve(64U);
+		stack.push_back(m_root);
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			// The closest point of the box to the centre
+			vec3 offset = glm::clamp(pCentre, node.box.min, node.box.max) - pCentre;
+			if (glm::dot(offset, offset) > pRadius * pRadius)
+				continue;
+
+			if (node.IsLeaf())
+				pOut.push_back(node.userData);
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	void BoundsTree::QueryRay(const vec3& pOrigin, const vec3& pDirection, float pLength,
+		const function<float(unsigned int, float)>& pVisit) const
+	{
+		if (m_root == s_null)
+			return;
+
+		vec3 inverse = 1.0f / pDirection;
+		vector<unsigned int> stack;
+		stack.reserve(64U);
+		stack.push_back(m_root);
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			float entry = EntryDistance(node.box, pOrigin, inverse, pLength);
+			if (entry > pLength)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				pLength = pVisit(node.userData, entry);
+				continue;
+			}
+
+			// The nearer child is taken first so what it hits can rule out the other
+			bool leftNearer = EntryDistance(m_nodes[node.left].box, pOrigin, inverse, pLength)
+				<= EntryDistance(m_nodes[node.right].box, pOrigin, inverse, pLength);
+			stack.push_back(leftNearer ? node.right : node.left);
+			stack.push_back(leftNearer ? node.left : node.right);
+		}
+	}
+
+	unsigned int BoundsTree::AllocateNode()
+	{
+		if (m_freeList == s_null)
+		{
+			m_nodes.push_back(Node());
+			return (unsigned int)m_nodes.size() - 1U;
+		}
+
+		unsigned int node = m_freeList;
+		m_freeList = m_nodes[node].parent;
+		m_nodes[node] = Node();
+		return node;
+	}
+
+	void BoundsTree::FreeNode(unsigned int pNode)
+	{
+		m_nodes[pNode].parent = m_freeList;
+		m_nodes[pNode].height = -1;
+		m_freeList = pNode;
+	}
+
+	void BoundsTree::InsertLeaf(unsigned int pLeaf)
+	{
+		if (m_root == s_null)
+		{
+			m_root = pLeaf;
+			m_nodes[pLeaf].parent = s_null;
+			return;
+		}
+
+		// Walk down towards the cheapest sibling. Joining a node costs the area of the new parent, and every
+		// ancestor above it grows by the same amount, which is inherited by whichever child is taken
+		AABB leafBox = m_nodes[pLeaf].box;
+		unsigned int index = m_root;
+		while (!m_nodes[index].IsLeaf())
+		{
+			const Node& node = m_nodes[index];
+			float area = Area(node.box);
+			float combinedArea = Area(Union(node.box, leafBox));
+			float cost = 2.0f * combinedArea;
+			float inheritedCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](unsigned int pChild)
+			{
+				const Node& child = m_nodes[pChild];
+				float grown = Area(Union(leafBox, child.box));
+				return (child.IsLeaf() ? grown : grown - Area(child.box)) + inheritedCost;
+			};
+			float leftCost = childCost(node.left);
+			float rightCost = childCost(node.right);
+
+			if (cost < leftCost && cost < rightCost)
+				break;
+			index = (leftCost < rightCost ? node.left : node.right);
+		}
+
+		// A new parent takes the sibling's place with the sibling and leaf under it
+		unsigned int sibling = index;
+		unsigned int oldParent = m_nodes[sibling].parent;
+		unsigned int newParent = AllocateNode();
+		Node& parent = m_nodes[newParent];
+		parent.parent = oldParent;
+		parent.box = Union(leafBox, m_nodes[sibling].box);
+		parent.height = m_nodes[sibling].height + 1;
+		parent.left = sibling;
+		parent.right = pLeaf;
+		ReplaceChild(oldParent, sibling, newParent);
+		m_nodes[sibling].parent = newParent;
+		m_nodes[pLeaf].parent = newParent;
+
+		Refit(m_nodes[pLeaf].parent);
+	}
+
+	void BoundsTree::RemoveLeaf(unsigned int pLeaf)
+	{
+		if (pLeaf == m_root)
+		{
+			m_root = s_null;
+			return;
+		}
+
+		// The sibling takes the parent's place
+		unsigned int parent = m_nodes[pLeaf].parent;
+		unsigned int grandParent = m_nodes[parent].parent;
+		unsigned int sibling = (m_nodes[parent].left == pLeaf ? m_nodes[parent].right : m_nodes[parent].left);
+		ReplaceChild(grandParent, parent, sibling);
+		m_nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		if (grandParent != s_null)
+			Refit(grandParent);
+	}
+
+	void BoundsTree::Refit(unsigned int pNode)
+	{
+		unsigned int index = pNode;
+		while (index != s_null)
+		{
+			index = Balance(index);
+			Node& node = m_nodes[index];
+			const Node& left = m_nodes[node.left];
+			const Node& right = m_nodes[node.right];
+			node.height = 1 + std::max(left.height, right.height);
+			node.box = Union(left.box, right.box);
+			index = node.parent;
+		}
+	}
+
+	unsigned int BoundsTree::Balance(unsigned int pNode)
+	{
+		Node& a = m_nodes[pNode];
+		if (a.IsLeaf() || a.height < 2)
+			return pNode;
+
+		unsigned int b = a.left, c = a.right;
+		int balance = m_nodes[c].height - m_nodes[b].height;
+		if (balance > 1 || balance < -1)
+		{
+			// The taller child rises to take this node's place, this node keeps the shorter child and the
+			// shorter of the taller child's children
+			bool rightTaller = (balance > 1);
+			unsigned int up = (rightTaller ? c : b);
+			unsigned int kept = (rightTaller ? b : c);
+			Node& upNode = m_nodes[up];
+			unsigned int f = upNode.left, g = upNode.right;
+			bool leftTaller = (m_nodes[f].height > m_nodes[g].height);
+			unsigned int tall = (leftTaller ? f : g);
+			unsigned int shortChild = (leftTaller ? g : f);
+
+			upNode.left = pNode;
+			upNode.right = tall;
+			upNode.parent = a.parent;
+			a.parent = up;
+			ReplaceChild(upNode.parent, pNode, up);
+
+			if (rightTaller)
+				a.right = shortChild;
+			else
+				a.left = shortChild;
+			m_nodes[shortChild].parent = pNode;
+
+			a.box = Union(m_nodes[kept].box, m_nodes[shortChild].box);
+			a.height = 1 + std::max(m_nodes[kept].height, m_nodes[shortChild].height);
+			upNode.box = Union(a.box, m_nodes[tall].box);
+			upNode.height = 1 + std::max(a.height, m_nodes[tall].height);
+			return up;
+		}
+		return pNode;
+	}
+
+	void BoundsTree::ReplaceChild(unsigned int pParent, unsigned int pOld, unsigned int pNew)
+	{
+		if (pParent == s_null)
+		{
+			m_root = pNew;
+			return;
+		}
+
+		Node& parent = m_nodes[pParent];
+		if (parent.left == pOld)
+			parent.left = pNew;
+		else
+			parent.right = pNew;
+	}
+}
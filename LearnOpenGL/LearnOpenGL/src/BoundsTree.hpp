@@ -0,0 +1,152 @@
+#pragma region
+#pragma once
+#include "Bounds.hpp"
+#include "FrustumCuller.hpp"
+#include <vector>
+#include <functional>
+
+using std::vector;
+using std::function;
+#pragma endregion
+
+namespace Engine
+{
+	// A dynamic bounding volume hierarchy. Every leaf holds a box grown by a margin, so small moves fit inside it
+	// and change nothing. A leaf that leaves its box is taken out and inserted again, walking back up to refit
+	// and rebalance only its ancestors. Inserts pick the sibling that grows the surface area least, and rotations
+	// keep the height logarithmic however the boxes move
+	class BoundsTree
+	{
+	public:
+		static const unsigned int s_null = 0xFFFFFFFFU;
+		static const float s_margin;	// How far a leaf's box reaches past what it holds
+
+		BoundsTree() = default;
+
+		#pragma region Delete copy/move
+		BoundsTree(const BoundsTree&) = delete;
+		BoundsTree& operator=(const BoundsTree&) = delete;
+		BoundsTree(BoundsTree&&) = delete;
+		BoundsTree& operator=(BoundsTree&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Adds a box to the tree
+		 *
+		 * @param pBox The box in world space
+		 * @param pUserData Returned by queries that find it
+		 * @return The leaf holding it, to move or remove it by
+		 */
+		unsigned int Insert(const AABB& pBox, unsigned int pUserData);
+		/**
+		 * @brief Takes a leaf out of the tree
+		 *
+		 * @param pLeaf The leaf from Insert
+		 */
+		void Remove(unsigned int pLeaf);
+		/**
+		 * @brief Updates a leaf whose box changed, nothing happens while it still fits in the leaf's grown box
+		 *
+		 * @param pLeaf The leaf from Insert
+		 * @param pBox The new box in world space
+		 * @return If the leaf had to be inserted again
+		 */
+		bool Move(unsigned int pLeaf, const AABB& pBox);
+		/**
+		 * @brief Empties the tree, keeping its memory
+		 */
+		void Clear();
+
+		/**
+		 * @brief Finds every leaf whose box is at least partly inside a frustum. Subtrees fully inside are taken
+		 * whole without testing their leaves
+		 *
+		 * @param pFrustum The culler holding the frustum's planes
+		 * @param pOut The user data of the leaves found are appended
+		 */
+		void QueryFrustum(const FrustumCuller& pFrustum, vector<unsigned int>& pOut) const;
+		/**
+		 * @brief Finds every leaf whose box overlaps another
+		 *
+		 * @param pBox The box to test
+		 * @param pOut The user data of the leaves found are appended
+		 */
+		void QueryBox(const AABB& pBox, vector<unsigned int>& pOut) const;
+		/**
+		 * @brief Finds every leaf whose box is within a distance of a point
+		 *
+		 * @param pCentre The point
+		 * @param pRadius The distance
+		 * @param pOut The user data of the leaves found are appended
+		 */
+		void QueryRange(const vec3& pCentre, float pRadius, vector<unsigned int>& pOut) const;
+		/**
+		 * @brief Walks the leaves a ray enters, nearer children first. Each leaf can shorten the ray, so those
+		 * entered past where something was hit are skipped
+		 *
+		 * @param pOrigin Where the ray starts
+		 * @param pDirection Which way it goes, the distances are in multiples of it
+		 * @param pLength How far the ray reaches
+		 * @param pVisit Called with the user data of each leaf and the distance the ray entered its box at, 0 if it
+		 * starts inside. Returns how far the ray now reaches
+		 */
+		void QueryRay(const vec3& pOrigin, const vec3& pDirection, float pLength,
+			const function<float(unsigned int, float)>& pVisit) const;
+
+		unsigned int GetUserData(unsigned int pLeaf) const { return m_nodes[pLeaf].userData; }
+		unsigned int GetLeafCount() const { return m_leafCount; }
+		/**
+		 * @brief The longest path from the root to a leaf, 0 when empty or for a single leaf
+		 */
+		int GetHeight() const { return (m_root != s_null ? m_nodes[m_root].height : 0); }
+
+	private:
+		struct Node
+		{
+			AABB box;							// Grown by the margin for leaves, around both children otherwise
+			unsigned int parent = s_null;		// The next free node while free
+			unsigned int left = s_null, right = s_null;
+			int height = -1;					// 0 for leaves, -1 while free
+			unsigned int userData = 0U;
+
+			bool IsLeaf() const { return left == s_null; }
+		};
+
+		unsigned int AllocateNode();
+		void FreeNode(unsigned int pNode);
+		/**
+		 * @brief Links a leaf in beside the node that grows the least, then refits its ancestors
+		 *
+		 * @param pLeaf The leaf, its box already set
+		 */
+		void InsertLeaf(unsigned int pLeaf);
+		/**
+		 * @brief Unlinks a leaf, its sibling takes its parent's place, then refits its ancestors
+		 *
+		 * @param pLeaf The leaf
+		 */
+		void RemoveLeaf(unsigned int pLeaf);
+		/**
+		 * @brief Rebalances then refits every node from one up to the root
+		 *
+		 * @param pNode The first node to refit
+		 */
+		void Refit(unsigned int pNode);
+		/**
+		 * @brief Rotates the taller grandchild up if one child is more than one level taller than the other
+		 *
+		 * @param pNode The node to balance
+		 * @return The node now in its place
+		 */
+		unsigned int Balance(unsigned int pNode);
+		/**
+		 * @brief Replaces a child of a node, or the root if the node is null
+		 */
+		void ReplaceChild(unsigned int pParent, unsigned int pOld, unsigned int pNew);
+
+		vector<Node> m_nodes;
+		unsigned int m_root = s_null;
+		unsigned int m_freeList = s_null;
+		unsigned int m_leafCount = 0U;
+	};
+}
@@ -16,6 +16,10 @@ using glm::inverse;
 
 namespace Engine
 {
+	// Static
+	const float Camera::s_nearPlane = 0.001f;
+	const float Camera::s_farPlane = 1000.0f;
+
 	#pragma region Constructors
 	Camera::Camera(float pAspectRatio)
 	{
@@ -64,6 +68,7 @@ namespace Engine
 	{
 		m_view = glm::lookAt(pFrom, pTo, pUp);
 		m_transform = inverse(m_view);
+		m_dirty = true;
 	}
 
 	void Camera::ModifyFovH(float pValue)
@@ -109,57 +114,80 @@ namespace Engine
 	{
 		m_transform = pValue;
 		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 
 	void Camera::SetView(mat4 pValue)
 	{
 		m_view = pValue;
 		m_transform = inverse(m_view);
+		m_dirty = true;
 	}
 
 	void Camera::SetProjection(mat4 pValue)
 	{
 		m_projection = pValue;
+		m_dirty = true;
 	}
 
 	void Camera::SetProjection(float pFovV)
 	{
-		m_projection = perspective(radians(pFovV), m_aspectRatio, 0.001f, 1000.0f);
+		m_projection = perspective(radians(pFovV), m_aspectRatio, s_nearPlane, s_farPlane);
+		m_dirty = true;
 	}
 
 	void Camera::SetPosition(vec3 pValue)
 	{
 		m_transform[3] = vec4(pValue, m_transform[3][3]);
 		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 
 	void Camera::Translate(vec3 pValue)
 	{
+		// Called every frame with no movement, skip the inverse as well as the dirty flag
+		if (pValue == vec3(0))
+			return;
+
 		m_transform[3] = vec4((vec3)m_transform[3] + pValue, m_transform[3][3]);
 		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 
 	void Camera::SetRight(vec3 pValue)
 	{
 		m_transform[0] = vec4(pValue, 0);
 		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 
 	void Camera::SetUp(vec3 pValue)
 	{
 		m_transform[1] = vec4(pValue, 0);
 		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 
 	void Camera::SetForward(vec3 pValue)
 	{
 		m_transform[2] = vec4(pValue, 0);
 		m_view = inverse(m_transform);
+		m_dirty = true;
+	}
+
+	void Camera::SetOrientation(vec3 pRight, vec3 pUp, vec3 pForward)
+	{
+		m_transform[0] = vec4(pRight, 0);
+		m_transform[1] = vec4(pUp, 0);
+		m_transform[2] = vec4(pForward, 0);
+		m_view = inverse(m_transform);
+		m_dirty = true;
 	}
 	
 	void Camera::SetAspectRatio(float pAspectRatio)
 	{
 		m_aspectRatio = pAspectRatio;
+		m_dirty = true;
 	}
 
 	void Camera::SetFovH(float pFovH)
@@ -56,6 +56,14 @@ namespace Engine
 		void SetRight(vec3 pValue);
 		void SetUp(vec3 pValue);
 		void SetForward(vec3 pValue);
+		/**
+		 * @brief Sets all three axes at once so the view is only rebuilt once
+		 *
+		 * @param pRight The right axis
+		 * @param pUp The up axis
+		 * @param pForward The forward axis
+		 */
+		void SetOrientation(vec3 pRight, vec3 pUp, vec3 pForward);
 
 		/**
 		 * @brief Sets the aspect ratio
@@ -124,6 +132,8 @@ namespace Engine
 		mat4 GetWorldToCameraMatrix();
 		#pragma endregion
 
+		static const float s_nearPlane, s_farPlane;	// The clip planes every projection uses
+
 	private:
 		float m_fovH = 0, m_fovV = 0;	// The field of view of the camera in degrees, horizontal & vertical
 		float m_aspectRatio = 0;
@@ -1,4 +1,5 @@
 #include "Entity.hpp"
+#include <algorithm>
 
 namespace Engine
 {
@@ -11,6 +12,21 @@ namespace Engine
     {
         m_parent = pParent;
         m_children = new vector<Entity*>();
+        if (m_parent != nullptr)
+            m_parent->GetChildren()->push_back(this);
+    }
+
+    Entity::~Entity()
+    {
+        if (m_parent != nullptr)
+        {
+            vector<Entity*>* siblings = m_parent->GetChildren();
+            siblings->erase(std::remove(siblings->begin(), siblings->end(), this), siblings->end());
+        }
+        // Children left behind become roots
+        for (Entity* child : *m_children)
+            child->m_parent = nullptr;
+        delete m_children;
     }
 
     Entity* Entity::GetParent() const
@@ -22,4 +38,23 @@ namespace Engine
     {
         return m_children;
     }
+
+    mat4 Entity::GetWorldTransform() const
+    {
+        if (m_parent == nullptr)
+            return m_transform;
+        return m_parent->GetWorldTransform() * m_transform;
+    }
+
+    AABB Entity::GetWorldBounds() const
+    {
+        if (m_mesh == nullptr || m_mesh->GetBounds().IsEmpty())
+            return AABB();
+        return m_mesh->GetBounds().Transformed(GetWorldTransform());
+    }
+
+    bool Entity::GetWorldDirty() const
+    {
+        return m_dirty || (m_parent != nullptr && m_parent->GetWorldDirty());
+    }
 }
@@ -10,14 +10,63 @@ namespace Engine
     class Entity : public Transform
     {
     public:
+        static const unsigned int s_noLeaf = 0xFFFFFFFFU;
+
         Entity();
         Entity(Entity* pParent);
+        ~Entity();
+
+        #pragma region Delete copy/move
+        Entity(const Entity&) = delete;
+        Entity& operator=(const Entity&) = delete;
+        Entity(Entity&&) = delete;
+        Entity& operator=(Entity&&) = delete;
+        #pragma endregion
 
         Entity* GetParent() const;
         vector<Entity*>* GetChildren() const;
 
+        /**
+         * @brief Sets the mesh drawn at the entity, its box is what the entity is culled by
+         *
+         * @param pMesh The mesh, nullptr for an entity that is never drawn
+         */
+        void SetMesh(Mesh* pMesh) { m_mesh = pMesh; }
+        Mesh* GetMesh() const { return m_mesh; }
+        /**
+         * @brief The transform with every parent's applied
+         */
+        mat4 GetWorldTransform() const;
+        /**
+         * @brief The mesh's box moved by the world transform
+         *
+         * @return The box in world space, empty without a mesh
+         */
+        AABB GetWorldBounds() const;
+        /**
+         * @brief Whether this transform or any parent's has changed since they were last cleared
+         */
+        bool GetWorldDirty() const;
+        /**
+         * @brief Remembers the leaf of the bounds tree holding the entity, so it can be moved when its transform changes
+         *
+         * @param pLeaf The leaf, s_noLeaf if not in a tree
+         */
+        void SetTreeLeaf(unsigned int pLeaf) { m_treeLeaf = pLeaf; }
+        unsigned int GetTreeLeaf() const { return m_treeLeaf; }
+        /**
+         * @brief Marks the entity's mesh as solid enough to hide what is behind it from the occlusion culler
+         *
+         * @param pValue Whether the entity is drawn into the occlusion depth buffer
+         */
+        void SetOccluder(bool pValue) { m_occluder = pValue; }
+        bool IsOccluder() const { return m_occluder; }
+
     private:
         Entity* m_parent = nullptr;
         vector<Entity*>* m_children = nullptr;
+        Mesh* m_mesh = nullptr;
+        unsigned int m_treeLeaf = s_noLeaf;
+        bool m_occluder = false;
     };
 }
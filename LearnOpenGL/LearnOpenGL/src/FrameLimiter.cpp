@@ -0,0 +1,127 @@
+#pragma region
+#include "FrameLimiter.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#include <algorithm>
+#include <cmath>
+#ifdef _DEBUG
+ #include <cstdio>
+#endif
+
+using std::chrono::steady_clock;
+using std::chrono::duration;
+#pragma endregion
+
+namespace Engine
+{
+	FrameLimiter::FrameLimiter(unsigned int pCapacity)
+	{
+		m_capacity = (pCapacity > 0U ? pCapacity : 1U);
+		m_latencies.resize(m_capacity, 0.0f);
+		m_scratch.reserve(m_capacity);
+	}
+
+	void FrameLimiter::SetMaxFramesInFlight(unsigned int pFrames)
+	{
+		m_maxFrames = std::min(pFrames, s_maxFramesInFlight);
+	}
+
+	void FrameLimiter::WaitForFrame()
+	{
+		// Frames the gpu has already finished are retired without waiting so their latency is recorded
+		while (m_inFlight > 0U && RetireOldest(false)) {}
+
+		if (m_maxFrames == 0U || m_inFlight < m_maxFrames)
+			return;
+
+		steady_clock::time_point start = steady_clock::now();
+		while (m_inFlight >= m_maxFrames)
+			RetireOldest(true);
+		m_waitSeconds += duration<double>(steady_clock::now() - start).count();
+		++m_stalls;
+	}
+
+	void FrameLimiter::EndFrame()
+	{
+		if (m_maxFrames == 0U)
+			return;
+
+		// Only reachable if the limit was lowered mid run
+		while (m_inFlight >= s_maxFramesInFlight)
+			RetireOldest(true);
+
+		unsigned int slot = (m_head + m_inFlight) % s_maxFramesInFlight;
+		m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_submitted[slot] = steady_clock::now();
+		++m_inFlight;
+	}
+
+	void FrameLimiter::Destroy(bool pValidate)
+	{
+		if (pValidate)
+		{
+			while (m_inFlight > 0U)
+				RetireOldest(true);
+		}
+		m_inFlight = 0U;
+	}
+
+	void FrameLimiter::PrintReport()
+	{
+		#ifdef _DEBUG
+		 if (m_latencyCount == 0ULL)
+		 	return;
+
+		 printf("Cpu to gpu latency at %u frames in flight (ms): p50 %.3f, p95 %.3f, p99 %.3f, max %.3f. %llu stalls, %.3fms waiting\n",
+		 	m_maxFrames, GetLatencyPercentile(50.0), GetLatencyPercentile(95.0), GetLatencyPercentile(99.0),
+		 	GetLatencyPercentile(100.0), m_stalls, GetWaitTime());
+		#endif
+	}
+
+	double FrameLimiter::GetLatencyPercentile(double pPercentile)
+	{
+		unsigned int count = (m_latencyCount < m_capacity ? (unsigned int)m_latencyCount : m_capacity);
+		if (count == 0U)
+			return 0.0;
+
+		if (!m_sorted)
+		{
+			m_scratch.assign(m_latencies.begin(), m_latencies.begin() + count);
+			std::sort(m_scratch.begin(), m_scratch.end());
+			m_sorted = true;
+		}
+
+		// Nearest rank
+		double rank = std::ceil(pPercentile / 100.0 * count);
+		unsigned int index = (unsigned int)std::clamp(rank, 1.0, (double)count) - 1U;
+		return m_scratch[index];
+	}
+
+	bool FrameLimiter::RetireOldest(bool pBlock)
+	{
+		if (m_inFlight == 0U)
+			return false;
+
+		GLsync fence = (GLsync)m_fences[m_head];
+		if (pBlock)
+		{
+			// Flushing makes sure the fence itself reaches the gpu, otherwise this could wait forever
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+			while (result == GL_TIMEOUT_EXPIRED)
+				result = glClientWaitSync(fence, 0, 1000000000ULL);
+		}
+		else if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			return false;
+
+		// Measured when the cpu sees the fence, polled fences can read up to a frame late
+		float latency = duration<float, std::milli>(steady_clock::now() - m_submitted[m_head]).count();
+		m_latencies[(size_t)(m_latencyCount % m_capacity)] = latency;
+		++m_latencyCount;
+		m_sorted = false;
+
+		glDeleteSync(fence);
+		m_fences[m_head] = nullptr;
+		m_head = (m_head + 1U) % s_maxFramesInFlight;
+		--m_inFlight;
+		return true;
+	}
+}
@@ -0,0 +1,101 @@
+#pragma region
+#pragma once
+#include <vector>
+#include <chrono>
+
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	// Stops the cpu queueing more than a set amount of frames ahead of the gpu by waiting on fence syncs,
+	// and measures how long each frame took to go from the swap to the gpu finishing it
+	class FrameLimiter
+	{
+	public:
+		/**
+		 * @brief Construct a new FrameLimiter object, all memory is allocated up front
+		 *
+		 * @param pCapacity How many of the most recent latencies are kept
+		 */
+		FrameLimiter(unsigned int pCapacity = 8192U);
+		~FrameLimiter() {}
+
+		/**
+		 * @brief Sets how many frames may be submitted but unfinished on the gpu
+		 *
+		 * @param pFrames From 1 to 3, 0 disables the limit and the fences with it
+		 */
+		void SetMaxFramesInFlight(unsigned int pFrames);
+		unsigned int GetMaxFramesInFlight() const { return m_maxFrames; }
+
+		/**
+		 * @brief Blocks until fewer than the maximum frames are in flight, call before reading input
+		 * or drawing so the wait doesn't add to latency
+		 */
+		void WaitForFrame();
+		/**
+		 * @brief Inserts a fence behind the frame just submitted, call directly after swapping the buffers
+		 */
+		void EndFrame();
+		/**
+		 * @brief Waits out and deletes every fence still in flight
+		 *
+		 * @param pValidate Whether the gl context was ever initialised
+		 */
+		void Destroy(bool pValidate);
+
+		/**
+		 * @brief Writes the latency percentiles and time spent waiting to the console, only in debug
+		 */
+		void PrintReport();
+		/**
+		 * @brief Gets a percentile of the swap to gpu completion latency over the recorded frames
+		 *
+		 * @param pPercentile From 0 to 100
+		 * @return The time in milliseconds
+		 */
+		double GetLatencyPercentile(double pPercentile);
+		/**
+		 * @brief The total time in milliseconds spent blocked on fences
+		 */
+		double GetWaitTime() const { return m_waitSeconds * 1000.0; }
+		/**
+		 * @brief How many times the cpu was ahead and had to wait
+		 */
+		unsigned long long GetStallCount() const { return m_stalls; }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move so the fences can't be deleted twice.
+		FrameLimiter(const FrameLimiter&) = delete;
+		FrameLimiter& operator=(const FrameLimiter&) = delete;
+		FrameLimiter(FrameLimiter&&) = delete;
+		FrameLimiter& operator=(FrameLimiter&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Waits on the oldest fence and records its latency
+		 *
+		 * @param pBlock Whether to wait for it, otherwise only retired if already signalled
+		 * @return If the fence was retired
+		 */
+		bool RetireOldest(bool pBlock);
+
+		static const unsigned int s_maxFramesInFlight = 3U;
+
+		unsigned int m_maxFrames = 0U;						// 0 is unlimited
+		void* m_fences[s_maxFramesInFlight] = {};			// GLsync, oldest at m_head
+		std::chrono::steady_clock::time_point m_submitted[s_maxFramesInFlight];
+		unsigned int m_head = 0U, m_inFlight = 0U;
+
+		unsigned int m_capacity = 0U;
+		unsigned long long m_latencyCount = 0ULL;
+		vector<float> m_latencies;							// Ring of milliseconds, index is the count modulo capacity
+		vector<float> m_scratch;							// Sorted copy for percentile lookups
+		bool m_sorted = false;
+
+		unsigned long long m_stalls = 0ULL;
+		double m_waitSeconds = 0.0;
+	};
+}
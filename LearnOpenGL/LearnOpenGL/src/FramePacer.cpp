@@ -0,0 +1,112 @@
+#pragma region
+#include "FramePacer.hpp"
+#include <thread>
+#ifdef _WIN32
+ #include <Windows.h>	// Needed for timeBeginPeriod()
+ #pragma comment(lib, "winmm.lib")
+#endif
+#ifdef _DEBUG
+ #include <cstdio>
+#endif
+
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+#pragma endregion
+
+namespace Engine
+{
+	FramePacer::~FramePacer()
+	{
+		#ifdef _WIN32
+		 if (m_highResTimer)
+		 	timeEndPeriod(1);
+		#endif
+	}
+
+	void FramePacer::SetTargetFrameRate(double pFramesPerSecond)
+	{
+		m_period = (pFramesPerSecond > 0.0 ? 1.0 / pFramesPerSecond : 0.0);
+		m_hasDeadline = false;
+
+		#ifdef _WIN32
+		 // The default scheduler tick is ~15.6ms which is far too coarse to sleep with
+		 if (m_period > 0.0 && !m_highResTimer)
+		 	m_highResTimer = (timeBeginPeriod(1) == TIMERR_NOERROR);
+		#endif
+	}
+
+	void FramePacer::SetSpinThreshold(double pSeconds)
+	{
+		m_spinThreshold = (pSeconds > 0.0 ? pSeconds : 0.0);
+	}
+
+	void FramePacer::SetIdleFrameRate(double pFramesPerSecond)
+	{
+		if (pFramesPerSecond > 0.0)
+			m_idlePeriod = 1.0 / pFramesPerSecond;
+	}
+
+	void FramePacer::Wait()
+	{
+		if (m_period <= 0.0)
+			return;
+
+		steady_clock::time_point now = steady_clock::now();
+		steady_clock::duration period = duration_cast<steady_clock::duration>(duration<double>(m_period));
+
+		if (!m_hasDeadline)
+		{
+			m_deadline = now + period;
+			m_hasDeadline = true;
+			return;
+		}
+
+		if (now >= m_deadline)
+		{
+			// Already late, start again from now rather than rushing frames out to make up the difference.
+			// The frame itself was too slow so it says nothing about the pacer's accuracy
+			++m_missed;
+			m_deadline = now + period;
+			return;
+		}
+
+		// Sleep for the bulk of the wait, the os can overshoot so stop short of the deadline
+		steady_clock::duration spin = duration_cast<steady_clock::duration>(duration<double>(m_spinThreshold));
+		if (m_deadline - now > spin)
+			std::this_thread::sleep_for(m_deadline - now - spin);
+
+		// Spin out the remainder for sub-millisecond accuracy
+		while ((now = steady_clock::now()) < m_deadline)
+			std::this_thread::yield();
+
+		double error = duration<double>(now - m_deadline).count();
+		++m_samples;
+		m_errorSum += error;
+		if (error > m_maxError)
+			m_maxError = error;
+
+		m_deadline += period;
+	}
+
+	void FramePacer::Reset()
+	{
+		m_hasDeadline = false;
+	}
+
+	void FramePacer::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_period <= 0.0)
+		 	return;
+
+		 printf("Frame pacing at %.1f fps over %llu frames: mean error %.3fms, max error %.3fms, %llu missed\n",
+		 	GetTargetFrameRate(), m_samples, GetMeanError(), GetMaxError(), m_missed);
+		#endif
+	}
+
+	double FramePacer::GetMeanError() const
+	{
+		return (m_samples > 0ULL ? m_errorSum / (double)m_samples * 1000.0 : 0.0);
+	}
+}
@@ -0,0 +1,82 @@
+#pragma region
+#pragma once
+#include <chrono>
+#pragma endregion
+
+namespace Engine
+{
+	// Holds the main loop to a target frame rate by sleeping most of the wait and spinning the rest
+	class FramePacer
+	{
+	public:
+		FramePacer() = default;
+		~FramePacer();
+
+		/**
+		 * @brief Sets the frame rate Wait() paces to
+		 *
+		 * @param pFramesPerSecond The target frame rate, 0 to run unlimited
+		 */
+		void SetTargetFrameRate(double pFramesPerSecond);
+		/**
+		 * @brief Sets how long before the deadline sleeping stops and spinning takes over
+		 *
+		 * @param pSeconds The spin window, larger is more accurate but uses more cpu
+		 */
+		void SetSpinThreshold(double pSeconds);
+		/**
+		 * @brief Sets the rate the loop wakes at when the window is minimised or unfocused
+		 *
+		 * @param pFramesPerSecond The idle frame rate
+		 */
+		void SetIdleFrameRate(double pFramesPerSecond);
+
+		/**
+		 * @brief Blocks until the next frame is due, returns straight away when unlimited
+		 */
+		void Wait();
+		/**
+		 * @brief Forgets the current deadline, call after idling so there is no burst of catch-up frames
+		 */
+		void Reset();
+		/**
+		 * @brief Writes the pacing error statistics to the console, only in debug
+		 */
+		void PrintReport() const;
+
+		double GetIdleTimeout() const { return m_idlePeriod; }
+		double GetTargetFrameRate() const { return (m_period > 0.0 ? 1.0 / m_period : 0.0); }
+		/**
+		 * @brief The mean of how far past the deadline Wait() returned, in milliseconds. Missed frames aren't included
+		 */
+		double GetMeanError() const;
+		/**
+		 * @brief The largest distance from the deadline Wait() returned at, in milliseconds
+		 */
+		double GetMaxError() const { return m_maxError * 1000.0; }
+		/**
+		 * @brief How many frames were already late before Wait() was called
+		 */
+		unsigned long long GetMissedCount() const { return m_missed; }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, the timer resolution request on windows is tied to one instance.
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+		FramePacer(FramePacer&&) = delete;
+		FramePacer& operator=(FramePacer&&) = delete;
+		#pragma endregion
+
+		double m_period = 0.0;				// Seconds per frame, 0 is unlimited
+		double m_spinThreshold = 0.002;		// Seconds before the deadline to stop sleeping
+		double m_idlePeriod = 0.1;			// Seconds between wakes while idle, 10 fps
+		bool m_highResTimer = false;		// If the os timer resolution was raised
+
+		bool m_hasDeadline = false;
+		std::chrono::steady_clock::time_point m_deadline;
+
+		unsigned long long m_samples = 0ULL, m_missed = 0ULL;
+		double m_errorSum = 0.0, m_maxError = 0.0;	// In seconds
+	};
+}
@@ -0,0 +1,83 @@
+#pragma region
+#pragma once
+#include "glm/glm.hpp"
+#include <vector>
+#include <cstdint>
+
+using glm::vec3;
+using glm::vec4;
+using glm::mat3;
+using glm::mat4;
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	class Mesh;
+	class Shader;
+
+	// A single mesh to be drawn with everything it needs already calculated
+	struct DrawItem
+	{
+		Mesh* mesh = nullptr;
+		Shader* shader = nullptr;
+		mat4 model = mat4(1.0f);
+		mat3 normalMatrix = mat3(1.0f);	// Transpose inverse of the model matrix, filled in by the renderer
+		uint64_t sortKey = 0ULL;		// Set by the render queue, the order the item was drawn in
+		// Set by the renderer when consecutive copies are merged, the models are then a range of the snapshot's instances
+		unsigned int firstInstance = 0U;
+		unsigned int instanceCount = 0U;
+	};
+
+	// Where a light is drawn as a cube, shading reads the packed light buffer instead
+	struct LightState
+	{
+		vec3 colour = vec3(1.0f);
+		vec4 position = vec4(0.0f);
+	};
+
+	// The bytes of the packed light buffer that changed, copied out so the thread drawing never reads the lights
+	struct LightUpload
+	{
+		unsigned int offset = 0U;
+		vector<unsigned char> bytes;	// Empty when nothing changed
+	};
+
+	// Which lights reach each cluster of the view frustum, built on the game thread when clustered shading is on
+	struct ClusterData
+	{
+		bool enabled = false;
+		vector<uint32_t> grid;		// The offset into indices then the count, for every cell
+		vector<uint16_t> indices;	// Light slots, spot lights have the top bit set
+	};
+
+	// Everything the renderer needs to draw one frame, written by the game thread and only read afterwards
+	struct FrameSnapshot
+	{
+		unsigned int frame = 0U;	// The benchmark frame this snapshot is drawn as
+		double time = 0.0;
+
+		// Camera
+		mat4 view = mat4(1.0f);
+		mat4 projection = mat4(1.0f);
+		mat4 viewProjection = mat4(1.0f);
+		vec3 viewPosition = vec3(0.0f);
+
+		// Lights
+		LightState point, spot;
+		bool lightsChanged = true;	// Whether the light cube colours need uploading
+		LightUpload lightUpload;
+		ClusterData clusters;
+		unsigned int lightVolumes = 0U;	// Point then spot lights, each drawn as a volume while deferred
+
+		// Output
+		unsigned int viewportWidth = 0U, viewportHeight = 0U;
+		bool wireframe = false;
+		bool deferred = false;
+		bool depthPrepass = false;
+		bool gpuOcclusion = false;	// Cull instanced copies against the last frame's depth, and build it for the next
+
+		vector<DrawItem> drawList;	// Cleared but not freed between frames
+		vector<mat4> instances;		// Uploaded to the instance buffer in one go, a range for each merged item
+	};
+}
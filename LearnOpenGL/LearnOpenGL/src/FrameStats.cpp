@@ -0,0 +1,153 @@
+#pragma region
+#include "FrameStats.hpp"
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#ifdef _DEBUG
+ #include <cstdio>
+#endif
+
+using std::ofstream;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+#pragma endregion
+
+namespace Engine
+{
+	FrameStats::FrameStats(unsigned int pCapacity)
+	{
+		m_capacity = (pCapacity > 0U ? pCapacity : 1U);
+		m_samples.resize((size_t)m_capacity * s_columns, 0.0f);
+		m_scratch.reserve(m_capacity);
+	}
+
+	void FrameStats::BeginFrame()
+	{
+		for (unsigned int i = 0; i < s_columns; ++i)
+			m_current[i] = 0.0f;
+		m_openPhase = -1;
+		m_frameStart = steady_clock::now();
+	}
+
+	void FrameStats::BeginPhase(FramePhase pPhase)
+	{
+		if (m_openPhase >= 0)
+			EndPhase();
+
+		m_openPhase = (int)pPhase;
+		m_phaseStart = steady_clock::now();
+	}
+
+	void FrameStats::EndPhase()
+	{
+		if (m_openPhase < 0)
+			return;
+
+		m_current[m_openPhase] += duration<float, std::milli>(steady_clock::now() - m_phaseStart).count();
+		m_openPhase = -1;
+	}
+
+	void FrameStats::EndFrame()
+	{
+		EndPhase();
+		m_current[s_columns - 1] = duration<float, std::milli>(steady_clock::now() - m_frameStart).count();
+
+		float* row = &m_samples[(size_t)(m_frameCount % m_capacity) * s_columns];
+		for (unsigned int i = 0; i < s_columns; ++i)
+			row[i] = m_current[i];
+
+		++m_frameCount;
+		m_sortedColumn = -1;
+	}
+
+	void FrameStats::PrintReport(const char* pTitle)
+	{
+		#ifdef _DEBUG
+		 printf("%s over %u frames (ms)\n", pTitle, GetCount());
+		 printf("%-12s %9s %9s %9s %9s\n", "phase", "p50", "p95", "p99", "max");
+		 for (unsigned int i = 0; i < s_columns; ++i)
+		 {
+		 	FramePhase phase = (FramePhase)i;
+		 	printf("%-12s %9.3f %9.3f %9.3f %9.3f\n", GetPhaseName(phase),
+		 		GetPercentile(phase, 50.0), GetPercentile(phase, 95.0),
+		 		GetPercentile(phase, 99.0), GetPercentile(phase, 100.0));
+		 }
+		#else
+		 (void)pTitle;
+		#endif
+	}
+
+	bool FrameStats::WriteCsv(string pPath) const
+	{
+		ofstream outStream(pPath);
+		if (!outStream.is_open())
+			return false;
+
+		outStream << "frame";
+		for (unsigned int i = 0; i < s_columns; ++i)
+			outStream << ',' << GetPhaseName((FramePhase)i);
+		outStream << '\n';
+
+		// Oldest frame first, once the ring has wrapped that is the next slot to be written
+		unsigned int count = GetCount();
+		unsigned long long first = m_frameCount - count;
+		for (unsigned long long frame = first; frame < m_frameCount; ++frame)
+		{
+			const float* row = &m_samples[(size_t)(frame % m_capacity) * s_columns];
+			outStream << frame;
+			for (unsigned int i = 0; i < s_columns; ++i)
+				outStream << ',' << row[i];
+			outStream << '\n';
+		}
+
+		return true;
+	}
+
+	double FrameStats::GetPercentile(FramePhase pPhase, double pPercentile)
+	{
+		unsigned int count = GetCount();
+		if (count == 0U)
+			return 0.0;
+
+		SortColumn((unsigned int)pPhase);
+
+		// Nearest rank
+		double rank = std::ceil(pPercentile / 100.0 * count);
+		unsigned int index = (unsigned int)std::clamp(rank, 1.0, (double)count) - 1U;
+		return m_scratch[index];
+	}
+
+	unsigned int FrameStats::GetCount() const
+	{
+		return (m_frameCount < m_capacity ? (unsigned int)m_frameCount : m_capacity);
+	}
+
+	// Static
+	const char* FrameStats::GetPhaseName(FramePhase pPhase)
+	{
+		switch (pPhase)
+		{
+			case FramePhase::GpuWait: return "gpuWait";
+			case FramePhase::Input: return "input";
+			case FramePhase::FixedUpdate: return "fixedUpdate";
+			case FramePhase::Update: return "update";
+			case FramePhase::Draw: return "draw";
+			case FramePhase::Swap: return "swap";
+			case FramePhase::Count: return "total";
+			default: return "ERROR";
+		}
+	}
+
+	void FrameStats::SortColumn(unsigned int pColumn)
+	{
+		if (m_sortedColumn == (int)pColumn)
+			return;
+
+		unsigned int count = GetCount();
+		m_scratch.clear();
+		for (unsigned int i = 0; i < count; ++i)
+			m_scratch.push_back(m_samples[(size_t)i * s_columns + pColumn]);
+		std::sort(m_scratch.begin(), m_scratch.end());
+		m_sortedColumn = (int)pColumn;
+	}
+}
@@ -0,0 +1,106 @@
+#pragma region
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	// The timed sections of Application::Run, in the order they happen
+	enum class FramePhase : uint8_t
+	{
+		GpuWait,
+		Input,
+		FixedUpdate,
+		Update,
+		Draw,
+		Swap,
+		Count
+	};
+
+	// Keeps a fixed window of per-phase frame timings for percentile reporting
+	class FrameStats
+	{
+	public:
+		/**
+		 * @brief Construct a new FrameStats object, all memory is allocated up front
+		 *
+		 * @param pCapacity How many of the most recent frames are kept
+		 */
+		FrameStats(unsigned int pCapacity = 8192U);
+		~FrameStats() {}
+
+		/**
+		 * @brief Starts timing a new frame and clears the previous frame's in progress timings
+		 */
+		void BeginFrame();
+		/**
+		 * @brief Starts timing a phase, ends the previous phase if one is still open
+		 *
+		 * @param pPhase The phase being timed
+		 */
+		void BeginPhase(FramePhase pPhase);
+		/**
+		 * @brief Stops timing the current phase, time is added on if the phase is entered more than once
+		 */
+		void EndPhase();
+		/**
+		 * @brief Commits the frame to the ring buffer, frames that never reach this are not recorded
+		 */
+		void EndFrame();
+
+		/**
+		 * @brief Writes the p50/p95/p99/max of every phase to the console, only in debug
+		 *
+		 * @param pTitle What the timings are of, heads the report
+		 */
+		void PrintReport(const char* pTitle = "Frame timings");
+		/**
+		 * @brief Writes every recorded frame to a csv file, oldest first
+		 *
+		 * @param pPath The file path of the csv
+		 * @return If the file was written
+		 */
+		bool WriteCsv(string pPath) const;
+
+		/**
+		 * @brief Gets a percentile of a phase's timings over the recorded frames
+		 *
+		 * @param pPhase The phase, FramePhase::Count gives the whole frame
+		 * @param pPercentile From 0 to 100
+		 * @return The time in milliseconds
+		 */
+		double GetPercentile(FramePhase pPhase, double pPercentile);
+		/**
+		 * @brief The amount of frames currently held, at most the capacity
+		 */
+		unsigned int GetCount() const;
+
+		static const char* GetPhaseName(FramePhase pPhase);
+
+	private:
+		static const unsigned int s_columns = (unsigned int)FramePhase::Count + 1U;	// Every phase plus the frame total
+
+		/**
+		 * @brief Sorts one column of the ring into m_scratch, skipped if already sorted
+		 *
+		 * @param pColumn The phase index, or the total column
+		 */
+		void SortColumn(unsigned int pColumn);
+
+		unsigned int m_capacity = 0U;
+		unsigned long long m_frameCount = 0ULL;	// Total committed frames, the ring index is this modulo capacity
+		vector<float> m_samples;				// m_capacity rows of s_columns milliseconds
+		vector<float> m_scratch;				// Sorted copy of one column for percentile lookups
+		int m_sortedColumn = -1;				// The column m_scratch currently holds
+
+		float m_current[s_columns] = {};		// Timings of the frame in progress
+		int m_openPhase = -1;
+		std::chrono::steady_clock::time_point m_frameStart, m_phaseStart;
+	};
+}
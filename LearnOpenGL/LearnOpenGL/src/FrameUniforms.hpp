@@ -0,0 +1,32 @@
+#pragma region
+#pragma once
+#include "glm/glm.hpp"
+#include <cstddef>
+
+using glm::vec3;
+using glm::vec4;
+using glm::uvec4;
+using glm::mat4;
+#pragma endregion
+
+namespace Engine
+{
+	// Mirrors the FrameData uniform block the shaders share, written once per frame. Follows the std140 layout,
+	// where a float can fill the space left after a vec3
+	struct FrameUniforms
+	{
+		static const unsigned int s_binding = 0U;	// The uniform buffer binding point every shader's block is given
+
+		mat4 view = mat4(1.0f);
+		mat4 projection = mat4(1.0f);
+		mat4 viewProjection = mat4(1.0f);
+		vec3 viewPosition = vec3(0.0f);
+		float time = 0.0f;
+		uvec4 clusterCount = uvec4(0U);	// Tiles across, tiles up, depth slices, then whether clustered shading is on
+		vec4 clusterScale = vec4(0.0f);	// Turns pixels into tiles in xy, the log of depth into a slice in zw
+	};
+
+	static_assert(offsetof(FrameUniforms, viewPosition) == 192U && offsetof(FrameUniforms, time) == 204U
+		&& offsetof(FrameUniforms, clusterCount) == 208U && offsetof(FrameUniforms, clusterScale) == 224U
+		&& sizeof(FrameUniforms) == 240U, "FrameUniforms no longer matches the std140 FrameData block");
+}
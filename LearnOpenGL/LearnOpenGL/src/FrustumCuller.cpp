@@ -0,0 +1,239 @@
+#pragma region
+#include "FrustumCuller.hpp"
+#include <cstdio>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define CULLING_SSE
+ #include <emmintrin.h>
+ // Avx is only compiled for the one function that uses it, the rest of the program runs on any x64 cpu
+ #if defined(_MSC_VER)
+  #define CULLING_AVX
+  #define CULLING_AVX_TARGET
+  #include <immintrin.h>
+  #include <intrin.h>
+ #elif defined(__GNUC__)
+  #define CULLING_AVX
+  #define CULLING_AVX_TARGET __attribute__((target("avx")))
+  #include <immintrin.h>
+ #endif
+#endif
+#pragma endregion
+
+namespace Engine
+{
+	/**
+	 * @brief Tests one box at a time, for cpus without vector instructions
+	 */
+	static void CullScalar(const FrustumCuller::Batch& pBatch)
+	{
+		for (unsigned int i = 0; i < pBatch.count; ++i)
+		{
+			bool inside = true;
+			for (unsigned int p = 0; p < 6U && inside; ++p)
+			{
+				// The distance of the centre from the plane, pushed out by the box's reach along the normal
+				const float* plane = pBatch.planes + p * 8U;
+				float distance = plane[0] * pBatch.centreX[i] + plane[1] * pBatch.centreY[i] + plane[2] * pBatch.centreZ[i] + plane[3]
+					+ plane[4] * pBatch.extentX[i] + plane[5] * pBatch.extentY[i] + plane[6] * pBatch.extentZ[i];
+				inside = (distance >= 0.0f);
+			}
+			pBatch.visible[i] = (inside ? 1U : 0U);
+		}
+	}
+
+	#ifdef CULLING_SSE
+	 /**
+	  * @brief Tests a batch as two halves of 4 boxes
+	  */
+	 static void CullSse(const FrustumCuller::Batch& pBatch)
+	 {
+	 	const __m128 zero = _mm_setzero_ps();
+	 	for (unsigned int i = 0; i < pBatch.count; i += FrustumCuller::s_batchSize)
+	 	{
+	 		for (unsigned int half = i; half < i + FrustumCuller::s_batchSize; half += 4U)
+	 		{
+	 			__m128 cx = _mm_loadu_ps(pBatch.centreX + half), cy = _mm_loadu_ps(pBatch.centreY + half), cz = _mm_loadu_ps(pBatch.centreZ + half);
+	 			__m128 ex = _mm_loadu_ps(pBatch.extentX + half), ey = _mm_loadu_ps(pBatch.extentY + half), ez = _mm_loadu_ps(pBatch.extentZ + half);
+	 			__m128 inside = _mm_cmpeq_ps(zero, zero);
+	 			for (unsigned int p = 0; p < 6U; ++p)
+	 			{
+	 				const float* plane = pBatch.planes + p * 8U;
+	 				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), cx), _mm_mul_ps(_mm_set1_ps(plane[1]), cy)),
+	 					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[2]), cz), _mm_set1_ps(plane[3])));
+	 				__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[4]), ex), _mm_mul_ps(_mm_set1_ps(plane[5]), ey)),
+	 					_mm_mul_ps(_mm_set1_ps(plane[6]), ez));
+	 				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+	 			}
+
+	 			int mask = _mm_movemask_ps(inside);
+	 			for (unsigned int b = 0; b < 4U; ++b)
+	 				pBatch.visible[half + b] = (uint8_t)((mask >> b) & 1);
+	 		}
+	 	}
+	 }
+	#endif
+
+	#ifdef CULLING_AVX
+	 /**
+	  * @brief Tests a whole batch of 8 boxes at once
+	  */
+	 CULLING_AVX_TARGET static void CullAvx(const FrustumCuller::Batch& pBatch)
+	 {
+	 	const __m256 zero = _mm256_setzero_ps();
+	 	for (unsigned int i = 0; i < pBatch.count; i += FrustumCuller::s_batchSize)
+	 	{
+	 		__m256 cx = _mm256_loadu_ps(pBatch.centreX + i), cy = _mm256_loadu_ps(pBatch.centreY + i), cz = _mm256_loadu_ps(pBatch.centreZ + i);
+	 		__m256 ex = _mm256_loadu_ps(pBatch.extentX + i), ey = _mm256_loadu_ps(pBatch.extentY + i), ez = _mm256_loadu_ps(pBatch.extentZ + i);
+	 		__m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+	 		for (unsigned int p = 0; p < 6U; ++p)
+	 		{
+	 			const float* plane = pBatch.planes + p * 8U;
+	 			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[0]), cx), _mm256_mul_ps(_mm256_set1_ps(plane[1]), cy)),
+	 				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[2]), cz), _mm256_set1_ps(plane[3])));
+	 			__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[4]), ex), _mm256_mul_ps(_mm256_set1_ps(plane[5]), ey)),
+	 				_mm256_mul_ps(_mm256_set1_ps(plane[6]), ez));
+	 			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+	 		}
+
+	 		int mask = _mm256_movemask_ps(inside);
+	 		for (unsigned int b = 0; b < FrustumCuller::s_batchSize; ++b)
+	 			pBatch.visible[i + b] = (uint8_t)((mask >> b) & 1);
+	 	}
+	 }
+
+	 /**
+	  * @brief Whether the cpu has avx and the os saves its registers
+	  */
+	 static bool HasAvx()
+	 {
+	 	#ifdef _MSC_VER
+	 	 int info[4];
+	 	 __cpuid(info, 1);
+	 	 bool osSaves = (info[2] & (1 << 27)) != 0;
+	 	 bool avx = (info[2] & (1 << 28)) != 0;
+	 	 return osSaves && avx && (_xgetbv(0) & 6ULL) == 6ULL;
+	 	#else
+	 	 return __builtin_cpu_supports("avx");
+	 	#endif
+	 }
+	#endif
+
+	FrustumCuller::FrustumCuller()
+	{
+		m_kernel = CullScalar;
+		m_kernelName = "scalar";
+		#ifdef CULLING_SSE
+		 m_kernel = CullSse;
+		 m_kernelName = "sse2";
+		#endif
+		#ifdef CULLING_AVX
+		 if (HasAvx())
+		 {
+		 	m_kernel = CullAvx;
+		 	m_kernelName = "avx";
+		 }
+		#endif
+	}
+
+	void FrustumCuller::SetFrustum(const mat4& pWorldToCamera)
+	{
+		// Each plane is the last row of the matrix plus or minus one of the others, glm stores columns
+		for (unsigned int p = 0; p < 6U; ++p)
+		{
+			unsigned int row = p / 2U;
+			float sign = (p % 2U == 0U ? 1.0f : -1.0f);
+			vec4 plane;
+			for (unsigned int c = 0; c < 4U; ++c)
+				plane[c] = pWorldToCamera[c][3] + sign * pWorldToCamera[c][row];
+			plane /= glm::length(vec3(plane));
+
+			float* out = m_planes + p * s_planeStride;
+			out[0] = plane.x;
+			out[1] = plane.y;
+			out[2] = plane.z;
+			out[3] = plane.w;
+			out[4] = std::abs(plane.x);
+			out[5] = std::abs(plane.y);
+			out[6] = std::abs(plane.z);
+		}
+	}
+
+	void FrustumCuller::Clear()
+	{
+		m_centreX.clear();
+		m_centreY.clear();
+		m_centreZ.clear();
+		m_extentX.clear();
+		m_extentY.clear();
+		m_extentZ.clear();
+		m_count = 0U;
+	}
+
+	unsigned int FrustumCuller::Add(const AABB& pBox)
+	{
+		vec3 centre = pBox.GetCentre();
+		vec3 extents = pBox.GetExtents();
+		m_centreX.push_back(centre.x);
+		m_centreY.push_back(centre.y);
+		m_centreZ.push_back(centre.z);
+		m_extentX.push_back(extents.x);
+		m_extentY.push_back(extents.y);
+		m_extentZ.push_back(extents.z);
+		return m_count++;
+	}
+
+	void FrustumCuller::Cull()
+	{
+		// Padded to whole batches, the padding is tested but never read
+		unsigned int padded = (m_count + s_batchSize - 1U) / s_batchSize * s_batchSize;
+		m_centreX.resize(padded, 0.0f);
+		m_centreY.resize(padded, 0.0f);
+		m_centreZ.resize(padded, 0.0f);
+		m_extentX.resize(padded, 0.0f);
+		m_extentY.resize(padded, 0.0f);
+		m_extentZ.resize(padded, 0.0f);
+		m_visible.resize(padded);
+		if (padded == 0U)
+			return;
+
+		Batch batch = { m_centreX.data(), m_centreY.data(), m_centreZ.data(),
+			m_extentX.data(), m_extentY.data(), m_extentZ.data(), m_planes, m_visible.data(), padded };
+		m_kernel(batch);
+
+		unsigned int visible = 0U;
+		for (unsigned int i = 0; i < m_count; ++i)
+			visible += m_visible[i];
+		++m_frames;
+		m_tested += m_count;
+		m_culled += m_count - visible;
+	}
+
+	Containment FrustumCuller::Classify(const AABB& pBox) const
+	{
+		vec3 centre = pBox.GetCentre();
+		vec3 extents = pBox.GetExtents();
+		Containment result = Containment::Inside;
+		for (unsigned int p = 0; p < 6U; ++p)
+		{
+			const float* plane = m_planes + p * s_planeStride;
+			float distance = plane[0] * centre.x + plane[1] * centre.y + plane[2] * centre.z + plane[3];
+			float reach = plane[4] * extents.x + plane[5] * extents.y + plane[6] * extents.z;
+			if (distance + reach < 0.0f)
+				return Containment::Outside;
+			if (distance - reach < 0.0f)
+				result = Containment::Intersects;
+		}
+		return result;
+	}
+
+	void FrustumCuller::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_frames == 0ULL)
+		 	return;
+
+		 printf("Frustum culling (%s) over %llu frames: %.1f boxes a frame, %.1f visible, %.1f culled (%.1f%%)\n",
+		 	m_kernelName, m_frames, (double)m_tested / m_frames, (double)(m_tested - m_culled) / m_frames,
+		 	(double)m_culled / m_frames, (m_tested > 0ULL ? 100.0 * (double)m_culled / (double)m_tested : 0.0));
+		#endif
+	}
+}
@@ -0,0 +1,102 @@
+#pragma region
+#pragma once
+#include "Bounds.hpp"
+#include <vector>
+#include <cstdint>
+
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	// Where a box lies against a frustum
+	enum class Containment : uint8_t
+	{
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	// Tests world space boxes against the six planes of a view frustum, a batch of 8 at a time. The boxes are
+	// kept as separate arrays of each component so a batch loads straight into vector registers, and the widest
+	// kernel the cpu supports is picked once at startup
+	class FrustumCuller
+	{
+	public:
+		static const unsigned int s_batchSize = 8U;
+
+		FrustumCuller();
+
+		#pragma region Delete copy/move
+		FrustumCuller(const FrustumCuller&) = delete;
+		FrustumCuller& operator=(const FrustumCuller&) = delete;
+		FrustumCuller(FrustumCuller&&) = delete;
+		FrustumCuller& operator=(FrustumCuller&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Extracts the planes of the frustum a matrix projects into clip space, facing inwards
+		 *
+		 * @param pWorldToCamera The view projection matrix, such as Camera::GetWorldToCameraMatrix
+		 */
+		void SetFrustum(const mat4& pWorldToCamera);
+		/**
+		 * @brief Forgets the boxes added, keeping their memory
+		 */
+		void Clear();
+		/**
+		 * @brief Adds a box to be tested by the next Cull
+		 *
+		 * @param pBox The box in world space
+		 * @return Its index, to read whether it is visible
+		 */
+		unsigned int Add(const AABB& pBox);
+		/**
+		 * @brief Tests every box added against the frustum and adds to the counters
+		 */
+		void Cull();
+		bool IsVisible(unsigned int pIndex) const { return m_visible[pIndex] != 0U; }
+		/**
+		 * @brief Tests a single box, for hierarchies that skip or take whole branches at once
+		 *
+		 * @param pBox The box in world space
+		 * @return Whether it is outside, crossing a plane or fully inside
+		 */
+		Containment Classify(const AABB& pBox) const;
+		unsigned int GetCount() const { return m_count; }
+		/**
+		 * @brief The instruction set the kernel in use was written for
+		 */
+		const char* GetKernelName() const { return m_kernelName; }
+		/**
+		 * @brief Prints how many boxes were tested and how many were culled
+		 */
+		void PrintReport() const;
+
+		// The boxes as centres and half sizes, and the planes as normals with the distance then absolute normals
+		struct Batch
+		{
+			const float* centreX, *centreY, *centreZ;
+			const float* extentX, *extentY, *extentZ;
+			const float* planes;	// 6 planes of nx, ny, nz, d, |nx|, |ny|, |nz|, unused
+			uint8_t* visible;
+			unsigned int count;		// A multiple of the batch size
+		};
+		using Kernel = void (*)(const Batch& pBatch);
+
+	private:
+		static const unsigned int s_planeStride = 8U;
+
+		float m_planes[6 * s_planeStride] = {};
+		vector<float> m_centreX, m_centreY, m_centreZ;
+		vector<float> m_extentX, m_extentY, m_extentZ;
+		vector<uint8_t> m_visible;
+		unsigned int m_count = 0U;
+
+		Kernel m_kernel = nullptr;
+		const char* m_kernelName = "";
+
+		// Totals for the report
+		unsigned long long m_frames = 0ULL, m_tested = 0ULL, m_culled = 0ULL;
+	};
+}
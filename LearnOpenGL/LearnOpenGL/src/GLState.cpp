@@ -0,0 +1,250 @@
+#pragma region
+#include "GLState.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#ifdef _DEBUG
+ #include <cstdio>
+#endif
+#pragma endregion
+
+namespace Engine
+{
+	// Static
+	unsigned int GLState::s_program = GLState::s_unknown;
+	unsigned int GLState::s_vertexArray = GLState::s_unknown;
+	unsigned int GLState::s_activeUnit = GLState::s_unknown;
+	unsigned int GLState::s_polygonMode = GLState::s_unknown;
+	unsigned int GLState::s_buffers[GLState::s_bufferTargets] = { s_unknown, s_unknown, s_unknown, s_unknown };
+	unsigned int GLState::s_textures[GLState::s_textureUnits];
+	unsigned int GLState::s_depthFunc = GLState::s_unknown;
+	unsigned int GLState::s_blendSource = GLState::s_unknown;
+	unsigned int GLState::s_blendDestination = GLState::s_unknown;
+	int8_t GLState::s_depthTest = -1;
+	int8_t GLState::s_blend = -1;
+	int8_t GLState::s_cullFace = -1;
+	int8_t GLState::s_depthMask = -1;
+	unsigned long long GLState::s_issued[GLState::s_callCount] = {};
+	unsigned long long GLState::s_skipped[GLState::s_callCount] = {};
+
+	// Static
+	void GLState::UseProgram(unsigned int pProgram)
+	{
+		if (Track(Call::Program, s_program == pProgram))
+		{
+			glUseProgram(pProgram);
+			s_program = pProgram;
+		}
+	}
+
+	// Static
+	void GLState::BindVertexArray(unsigned int pVAO)
+	{
+		if (Track(Call::VertexArray, s_vertexArray == pVAO))
+		{
+			glBindVertexArray(pVAO);
+			s_vertexArray = pVAO;
+		}
+	}
+
+	// Static
+	void GLState::BindBuffer(unsigned int pTarget, unsigned int pBuffer)
+	{
+		int slot = -1;
+		switch (pTarget)
+		{
+			case GL_ARRAY_BUFFER: slot = 0; break;
+			case GL_UNIFORM_BUFFER: slot = 1; break;
+			case GL_COPY_READ_BUFFER: slot = 2; break;
+			case GL_COPY_WRITE_BUFFER: slot = 3; break;
+		}
+
+		if (slot < 0)
+		{
+			Track(Call::Buffer, false);
+			glBindBuffer(pTarget, pBuffer);
+			return;
+		}
+
+		if (Track(Call::Buffer, s_buffers[slot] == pBuffer))
+		{
+			glBindBuffer(pTarget, pBuffer);
+			s_buffers[slot] = pBuffer;
+		}
+	}
+
+	// Static
+	void GLState::BindBufferBase(unsigned int pTarget, unsigned int pIndex, unsigned int pBuffer)
+	{
+		// Indexed bindings are rarely changed so they aren't tracked, only the generic binding this moves
+		Track(Call::Buffer, false);
+		glBindBufferBase(pTarget, pIndex, pBuffer);
+		if (pTarget == GL_UNIFORM_BUFFER)
+			s_buffers[1] = pBuffer;
+	}
+
+	// Static
+	void GLState::ActiveTexture(unsigned int pUnit)
+	{
+		if (Track(Call::ActiveTexture, s_activeUnit == pUnit))
+		{
+			glActiveTexture(GL_TEXTURE0 + pUnit);
+			s_activeUnit = pUnit;
+		}
+	}
+
+	// Static
+	void GLState::BindTexture(unsigned int pUnit, unsigned int pTarget, unsigned int pTexture)
+	{
+		bool tracked = pUnit < s_textureUnits;
+		if (Track(Call::Texture, tracked && s_textures[pUnit] == pTexture))
+		{
+			ActiveTexture(pUnit);
+			glBindTexture(pTarget, pTexture);
+			if (tracked)
+				s_textures[pUnit] = pTexture;
+		}
+	}
+
+	// Static
+	void GLState::PolygonMode(unsigned int pMode)
+	{
+		if (Track(Call::PolygonMode, s_polygonMode == pMode))
+		{
+			glPolygonMode(GL_FRONT_AND_BACK, pMode);
+			s_polygonMode = pMode;
+		}
+	}
+
+	// Static
+	void GLState::SetEnabled(unsigned int pCapability, bool pValue)
+	{
+		int8_t* state = nullptr;
+		switch (pCapability)
+		{
+			case GL_DEPTH_TEST: state = &s_depthTest; break;
+			case GL_BLEND: state = &s_blend; break;
+			case GL_CULL_FACE: state = &s_cullFace; break;
+		}
+
+		if (Track(Call::Capability, state != nullptr && *state == (int8_t)pValue))
+		{
+			if (pValue)
+				glEnable(pCapability);
+			else
+				glDisable(pCapability);
+			if (state != nullptr)
+				*state = (int8_t)pValue;
+		}
+	}
+
+	// Static
+	void GLState::DepthFunc(unsigned int pFunc)
+	{
+		if (Track(Call::Depth, s_depthFunc == pFunc))
+		{
+			glDepthFunc(pFunc);
+			s_depthFunc = pFunc;
+		}
+	}
+
+	// Static
+	void GLState::DepthMask(bool pValue)
+	{
+		if (Track(Call::Depth, s_depthMask == (int8_t)pValue))
+		{
+			glDepthMask(pValue ? GL_TRUE : GL_FALSE);
+			s_depthMask = (int8_t)pValue;
+		}
+	}
+
+	// Static
+	void GLState::BlendFunc(unsigned int pSource, unsigned int pDestination)
+	{
+		if (Track(Call::Blend, s_blendSource == pSource && s_blendDestination == pDestination))
+		{
+			glBlendFunc(pSource, pDestination);
+			s_blendSource = pSource;
+			s_blendDestination = pDestination;
+		}
+	}
+
+	// Static
+	void GLState::Invalidate()
+	{
+		s_program = s_vertexArray = s_activeUnit = s_polygonMode = s_unknown;
+		s_depthFunc = s_blendSource = s_blendDestination = s_unknown;
+		for (unsigned int i = 0; i < s_bufferTargets; ++i)
+			s_buffers[i] = s_unknown;
+		for (unsigned int i = 0; i < s_textureUnits; ++i)
+			s_textures[i] = s_unknown;
+		s_depthTest = s_blend = s_cullFace = s_depthMask = -1;
+	}
+
+	// Static
+	void GLState::PrintReport(unsigned long long pFrames)
+	{
+		#ifdef _DEBUG
+		 unsigned long long issued = GetIssuedCount(), skipped = GetSkippedCount();
+		 if (issued + skipped == 0ULL)
+		 	return;
+
+		 printf("Gl state calls over %llu frames: %llu issued, %llu skipped (%.1f%%)\n", pFrames, issued, skipped,
+		 	100.0 * (double)skipped / (double)(issued + skipped));
+		 printf("%-14s %12s %12s %10s\n", "call", "issued", "skipped", "skipped/f");
+		 for (unsigned int i = 0; i < s_callCount; ++i)
+		 {
+		 	if (s_issued[i] + s_skipped[i] == 0ULL)
+		 		continue;
+		 	printf("%-14s %12llu %12llu %10.1f\n", GetCallName((Call)i), s_issued[i], s_skipped[i],
+		 		(pFrames > 0ULL ? (double)s_skipped[i] / (double)pFrames : 0.0));
+		 }
+		#else
+		 (void)pFrames;
+		#endif
+	}
+
+	// Static
+	unsigned long long GLState::GetIssuedCount()
+	{
+		unsigned long long total = 0ULL;
+		for (unsigned int i = 0; i < s_callCount; ++i)
+			total += s_issued[i];
+		return total;
+	}
+
+	// Static
+	unsigned long long GLState::GetSkippedCount()
+	{
+		unsigned long long total = 0ULL;
+		for (unsigned int i = 0; i < s_callCount; ++i)
+			total += s_skipped[i];
+		return total;
+	}
+
+	// Static
+	bool GLState::Track(Call pCall, bool pRedundant)
+	{
+		if (pRedundant)
+			++s_skipped[(unsigned int)pCall];
+		else
+			++s_issued[(unsigned int)pCall];
+		return !pRedundant;
+	}
+
+	// Static
+	const char* GLState::GetCallName(Call pCall)
+	{
+		switch (pCall)
+		{
+			case Call::Program: return "program";
+			case Call::VertexArray: return "vertexArray";
+			case Call::Buffer: return "buffer";
+			case Call::ActiveTexture: return "activeTexture";
+			case Call::Texture: return "texture";
+			case Call::PolygonMode: return "polygonMode";
+			case Call::Capability: return "capability";
+			case Call::Depth: return "depth";
+			case Call::Blend: return "blend";
+			default: return "ERROR";
+		}
+	}
+}
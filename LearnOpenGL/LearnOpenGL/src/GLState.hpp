@@ -0,0 +1,130 @@
+#pragma region
+#pragma once
+#include <cstdint>
+#pragma endregion
+
+namespace Engine
+{
+	// Mirrors the gl state the engine changes so calls that wouldn't change anything are skipped.
+	// Only call from the thread the context is current on, and only change this state through here
+	class GLState
+	{
+	public:
+		/**
+		 * @brief glUseProgram
+		 */
+		static void UseProgram(unsigned int pProgram);
+		/**
+		 * @brief glBindVertexArray
+		 */
+		static void BindVertexArray(unsigned int pVAO);
+		/**
+		 * @brief glBindBuffer, element array buffers are part of the vertex array so are always issued
+		 *
+		 * @param pTarget The buffer target such as GL_ARRAY_BUFFER
+		 * @param pBuffer The buffer id
+		 */
+		static void BindBuffer(unsigned int pTarget, unsigned int pBuffer);
+		/**
+		 * @brief glBindBufferBase, which also binds the buffer to the target's generic binding
+		 *
+		 * @param pTarget GL_UNIFORM_BUFFER or GL_TRANSFORM_FEEDBACK_BUFFER
+		 * @param pIndex The binding point
+		 * @param pBuffer The buffer id
+		 */
+		static void BindBufferBase(unsigned int pTarget, unsigned int pIndex, unsigned int pBuffer);
+		/**
+		 * @brief glActiveTexture
+		 *
+		 * @param pUnit The unit index, without GL_TEXTURE0 added
+		 */
+		static void ActiveTexture(unsigned int pUnit);
+		/**
+		 * @brief Binds a texture to a unit, only changing the active unit if the binding changes
+		 *
+		 * @param pUnit The unit index, without GL_TEXTURE0 added
+		 * @param pTarget The texture target such as GL_TEXTURE_2D
+		 * @param pTexture The texture id
+		 */
+		static void BindTexture(unsigned int pUnit, unsigned int pTarget, unsigned int pTexture);
+		/**
+		 * @brief glPolygonMode for both faces
+		 *
+		 * @param pMode GL_FILL, GL_LINE or GL_POINT
+		 */
+		static void PolygonMode(unsigned int pMode);
+		/**
+		 * @brief glEnable or glDisable
+		 *
+		 * @param pCapability GL_DEPTH_TEST, GL_BLEND or GL_CULL_FACE, anything else is always issued
+		 * @param pValue Whether to enable it
+		 */
+		static void SetEnabled(unsigned int pCapability, bool pValue);
+		/**
+		 * @brief glDepthFunc
+		 */
+		static void DepthFunc(unsigned int pFunc);
+		/**
+		 * @brief glDepthMask
+		 */
+		static void DepthMask(bool pValue);
+		/**
+		 * @brief glBlendFunc
+		 */
+		static void BlendFunc(unsigned int pSource, unsigned int pDestination);
+
+		/**
+		 * @brief Forgets all the tracked state so the next call of each kind is issued, call after deleting
+		 * gl objects or when something outside this class may have changed the state
+		 */
+		static void Invalidate();
+		/**
+		 * @brief Writes how many calls of each kind were issued and skipped to the console, only in debug
+		 *
+		 * @param pFrames The amount of frames drawn, for the per frame average
+		 */
+		static void PrintReport(unsigned long long pFrames);
+		static unsigned long long GetIssuedCount();
+		static unsigned long long GetSkippedCount();
+
+	private:
+		GLState() = delete;
+
+		enum class Call : uint8_t
+		{
+			Program,
+			VertexArray,
+			Buffer,
+			ActiveTexture,
+			Texture,
+			PolygonMode,
+			Capability,
+			Depth,
+			Blend,
+			Count
+		};
+
+		/**
+		 * @brief Counts a call and says whether it needs issuing
+		 *
+		 * @param pCall The kind of call
+		 * @param pRedundant Whether the state already matches
+		 * @return If the gl call should be made
+		 */
+		static bool Track(Call pCall, bool pRedundant);
+		static const char* GetCallName(Call pCall);
+
+		static const unsigned int s_unknown = 0xFFFFFFFFU;	// Never a valid id, so the first call always issues
+		static const unsigned int s_textureUnits = 32U;
+		static const unsigned int s_bufferTargets = 4U;
+		static const unsigned int s_callCount = (unsigned int)Call::Count;
+
+		static unsigned int s_program, s_vertexArray, s_activeUnit, s_polygonMode;
+		static unsigned int s_buffers[s_bufferTargets];		// Array, uniform, copy read and copy write
+		static unsigned int s_textures[s_textureUnits];		// Only one target per unit is tracked
+		static unsigned int s_depthFunc, s_blendSource, s_blendDestination;
+		static int8_t s_depthTest, s_blend, s_cullFace, s_depthMask;	// -1 when unknown
+
+		static unsigned long long s_issued[s_callCount], s_skipped[s_callCount];
+	};
+}
@@ -0,0 +1,176 @@
+#pragma region
+#include "HeadlessContext.hpp"
+#ifdef HEADLESS_EGL
+ #include <EGL/egl.h>
+ #include <EGL/eglext.h>
+#endif
+#ifdef _DEBUG
+ #include <iostream>
+ using std::cout;
+ using std::endl;
+#endif
+#pragma endregion
+
+namespace Engine
+{
+#ifdef HEADLESS_EGL
+	bool HeadlessContext::Create(unsigned int pWidth, unsigned int pHeight)
+	{
+		// Prefer the default display, fall back to mesa's surfaceless platform when there is no display server
+		EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EGLint major = 0, minor = 0;
+		if (display == EGL_NO_DISPLAY || eglInitialize(display, &major, &minor) == EGL_FALSE)
+		{
+			auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (getPlatformDisplay != nullptr)
+				display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+			if (display == EGL_NO_DISPLAY || eglInitialize(display, &major, &minor) == EGL_FALSE)
+			{
+				#ifdef _DEBUG
+				 cout << "Failed to initialise EGL display" << endl;
+				#endif
+				return false;
+			}
+		}
+		m_display = display;
+
+		const EGLint configAttribs[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_NONE
+		};
+		EGLConfig config;
+		EGLint numConfigs = 0;
+		if (eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) == EGL_FALSE || numConfigs == 0)
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to find a suitable EGL config" << endl;
+			#endif
+			return false;
+		}
+
+		const EGLint surfaceAttribs[] = {
+			EGL_WIDTH, (EGLint)pWidth,
+			EGL_HEIGHT, (EGLint)pHeight,
+			EGL_NONE
+		};
+		m_surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+		if (m_surface == EGL_NO_SURFACE)
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to create EGL pbuffer" << endl;
+			#endif
+			return false;
+		}
+
+		// Matches the hints given to glfw for the windowed context
+		eglBindAPI(EGL_OPENGL_API);
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		m_context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+		if (m_context == EGL_NO_CONTEXT)
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to create EGL context" << endl;
+			#endif
+			return false;
+		}
+
+		if (eglMakeCurrent(display, m_surface, m_surface, m_context) == EGL_FALSE)
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to make EGL context current" << endl;
+			#endif
+			return false;
+		}
+
+		#ifdef _DEBUG
+		 cout << "Created headless EGL " << major << "." << minor << " context" << endl;
+		#endif
+		return true;
+	}
+
+	void HeadlessContext::Destroy()
+	{
+		if (m_display == nullptr)
+			return;
+
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (m_context != nullptr)
+			eglDestroyContext(m_display, m_context);
+		if (m_surface != nullptr)
+			eglDestroySurface(m_display, m_surface);
+		eglTerminate(m_display);
+
+		m_context = nullptr;
+		m_surface = nullptr;
+		m_display = nullptr;
+	}
+
+	void HeadlessContext::SwapBuffers()
+	{
+		eglSwapBuffers(m_display, m_surface);
+	}
+
+	void HeadlessContext::MakeCurrent(bool pCurrent)
+	{
+		if (pCurrent)
+			eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+		else
+			eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	}
+
+	// Static
+	void* HeadlessContext::GetProcAddress(const char* pName)
+	{
+		return (void*)eglGetProcAddress(pName);
+	}
+
+	// Static
+	bool HeadlessContext::IsSupported()
+	{
+		return true;
+	}
+#else
+	bool HeadlessContext::Create(unsigned int pWidth, unsigned int pHeight)
+	{
+		(void)pWidth;
+		(void)pHeight;
+		#ifdef _DEBUG
+		 cout << "Headless mode requires a build with HEADLESS_EGL" << endl;
+		#endif
+		return false;
+	}
+
+	void HeadlessContext::Destroy() {}
+
+	void HeadlessContext::SwapBuffers() {}
+
+	void HeadlessContext::MakeCurrent(bool pCurrent)
+	{
+		(void)pCurrent;
+	}
+
+	// Static
+	void* HeadlessContext::GetProcAddress(const char* pName)
+	{
+		(void)pName;
+		return nullptr;
+	}
+
+	// Static
+	bool HeadlessContext::IsSupported()
+	{
+		return false;
+	}
+#endif
+}
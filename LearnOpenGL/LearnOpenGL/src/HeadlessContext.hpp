@@ -0,0 +1,63 @@
+#pragma region
+#pragma once
+#pragma endregion
+
+namespace Engine
+{
+	// An offscreen OpenGL context used when running without a window, only available with HEADLESS_EGL
+	class HeadlessContext
+	{
+	public:
+		HeadlessContext() = default;
+		~HeadlessContext() {}
+
+		/**
+		 * @brief Creates an OpenGL 3.3 core context backed by an EGL pbuffer and makes it current
+		 *
+		 * @param pWidth The width in pixels of the pbuffer
+		 * @param pHeight The height in pixels of the pbuffer
+		 * @return If the context was successfully created
+		 */
+		bool Create(unsigned int pWidth, unsigned int pHeight);
+		/**
+		 * @brief Releases the context, surface and display
+		 */
+		void Destroy();
+		/**
+		 * @brief Presents the pbuffer, the equivalent of glfwSwapBuffers
+		 */
+		void SwapBuffers();
+		/**
+		 * @brief Binds or releases the context on the calling thread, the equivalent of glfwMakeContextCurrent
+		 *
+		 * @param pCurrent Whether to bind the context or release it
+		 */
+		void MakeCurrent(bool pCurrent);
+
+		/**
+		 * @brief Loader passed to glad in place of glfwGetProcAddress
+		 *
+		 * @param pName The name of the OpenGL function
+		 * @return The address of the function
+		 */
+		static void* GetProcAddress(const char* pName);
+
+		/**
+		 * @brief Whether this build was compiled with headless support
+		 */
+		static bool IsSupported();
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move so the EGL handles can't be released twice.
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+		HeadlessContext(HeadlessContext&&) = delete;
+		HeadlessContext& operator=(HeadlessContext&&) = delete;
+		#pragma endregion
+
+		void* m_display = nullptr;	// EGLDisplay
+		void* m_surface = nullptr;	// EGLSurface
+		void* m_context = nullptr;	// EGLContext
+	};
+}
@@ -0,0 +1,272 @@
+#pragma region
+#include "HiZCuller.hpp"
+#include "Mesh.hpp"
+#include "GLState.hpp"
+#include "glad/glad.h"
+#include <algorithm>
+#include <cstdio>
+#pragma endregion
+
+namespace Engine
+{
+	void HiZCuller::Init()
+	{
+		m_reduceShader = make_unique<Shader>("assets/shaders/deferredDirectional", "assets/shaders/hizReduce");
+		m_reduceShader->Use();
+		m_reduceShader->SetInt("u_source", (int)s_pyramidUnit);
+		m_cullShader = make_unique<Shader>("assets/shaders/hizCull", vector<string>{ "CulledModel" });
+		if (m_cullShader->GetLoaded())
+		{
+			m_cullShader->Use();
+			m_cullShader->SetInt("u_pyramid", (int)s_pyramidUnit);
+		}
+
+		glGenVertexArrays(1, &m_emptyVAO);
+		glGenVertexArrays(1, &m_cullVAO);
+		glGenFramebuffers(1, &m_framebuffer);
+		glGenTextures(1, &m_pyramid);
+		glGenTextures(1, &m_depthCopy);
+		glGenBuffers(s_bufferCount, m_culledBuffers);
+	}
+
+	void HiZCuller::Destroy(bool pValidate)
+	{
+		if (pValidate && m_framebuffer != 0U)
+		{
+			m_reduceShader->Destroy(pValidate);
+			m_cullShader->Destroy(pValidate);
+			glDeleteVertexArrays(1, &m_emptyVAO);
+			glDeleteVertexArrays(1, &m_cullVAO);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			glDeleteTextures(1, &m_pyramid);
+			glDeleteTextures(1, &m_depthCopy);
+			glDeleteBuffers(s_bufferCount, m_culledBuffers);
+			for (void*& fence : m_fences)
+			{
+				if (fence != nullptr)
+					glDeleteSync((GLsync)fence);
+			}
+			GLState::Invalidate();
+		}
+		m_emptyVAO = m_cullVAO = m_framebuffer = m_pyramid = m_depthCopy = 0U;
+		for (unsigned int i = 0; i < s_bufferCount; ++i)
+		{
+			m_culledBuffers[i] = 0U;
+			m_fences[i] = nullptr;
+		}
+		m_built = false;
+	}
+
+	void HiZCuller::Resize(unsigned int pWidth, unsigned int pHeight)
+	{
+		if (pWidth == m_depthWidth && pHeight == m_depthHeight)
+			return;
+
+		m_depthWidth = pWidth;
+		m_depthHeight = pHeight;
+		m_built = false;
+
+		// Halved until a single texel is left, every level is allocated so the texture is complete
+		GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_pyramid);
+		unsigned int width = std::max(pWidth / 2U, 1U), height = std::max(pHeight / 2U, 1U);
+		m_levels = 0U;
+		while (true)
+		{
+			glTexImage2D(GL_TEXTURE_2D, (GLint)m_levels++, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+			if (width == 1U && height == 1U)
+				break;
+			width = std::max(width / 2U, 1U);
+			height = std::max(height / 2U, 1U);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)m_levels - 1);
+
+		GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_depthCopy);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, pWidth, pHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	void HiZCuller::Build(unsigned int pDepthTexture, unsigned int pWidth, unsigned int pHeight, const mat4& pWorldToCamera)
+	{
+		if (pWidth == 0U || pHeight == 0U)
+			return;
+
+		Resize(pWidth, pHeight);
+		unsigned int source = pDepthTexture;
+		if (source == 0U)
+		{
+			// Copying from a depth buffer into a depth texture needs no matching formats, unlike a blit
+			GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_depthCopy);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, pWidth, pHeight);
+			source = m_depthCopy;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		GLState::SetEnabled(GL_DEPTH_TEST, false);
+		GLState::PolygonMode(GL_FILL);
+		m_reduceShader->Use();
+		GLState::BindVertexArray(m_emptyVAO);
+
+		unsigned int width = pWidth, height = pHeight;
+		for (unsigned int level = 0; level < m_levels; ++level)
+		{
+			width = std::max(width / 2U, 1U);
+			height = std::max(height / 2U, 1U);
+			if (level == 0U)
+			{
+				GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, source);
+				m_reduceShader->SetInt("u_sourceLevel", 0);
+			}
+			else
+			{
+				// The levels drawn so far are all the sampler sees, so the level drawn to never feeds back into it
+				GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_pyramid);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)level - 1);
+				m_reduceShader->SetInt("u_sourceLevel", (int)level - 1);
+			}
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pyramid, (GLint)level);
+			glViewport(0, 0, width, height);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		}
+
+		GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_pyramid);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)m_levels - 1);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, pWidth, pHeight);
+		GLState::SetEnabled(GL_DEPTH_TEST, true);
+
+		m_pyramidCamera = pWorldToCamera;
+		m_built = true;
+	}
+
+	void HiZCuller::Cull(const FrameSnapshot& pSnapshot, unsigned int pInstanceBuffer)
+	{
+		m_ranges.clear();
+		if (!m_built || !m_cullShader->GetLoaded())
+			return;
+
+		for (const DrawItem& item : pSnapshot.drawList)
+		{
+			if (item.instanceCount == 0U)
+				continue;
+
+			Range range;
+			range.mesh = item.mesh;
+			range.first = item.firstInstance;
+			range.count = item.instanceCount;
+			m_ranges.push_back(range);
+		}
+		if (m_ranges.empty())
+			return;
+		std::sort(m_ranges.begin(), m_ranges.end(), [](const Range& pA, const Range& pB) { return pA.first < pB.first; });
+
+		// Captured copies are appended, so they only land at their own index if the ranges leave no gaps
+		unsigned int total = 0U;
+		for (const Range& range : m_ranges)
+		{
+			if (range.first != total)
+			{
+				m_ranges.clear();
+				return;
+			}
+			total += range.count;
+		}
+
+		// Orphaned as it is filled again, by then the frame that last read it is long finished
+		m_current = (m_current + 1U) % s_bufferCount;
+		#ifdef _DEBUG
+		 CountCulled(m_current);
+		#endif
+		m_copies[m_current] = total;
+		GLState::BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_culledBuffers[m_current]);
+		glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, (size_t)total * sizeof(mat4), nullptr, GL_STREAM_COPY);
+
+		m_cullShader->Use();
+		m_cullShader->SetMat4("u_lastCamera", (mat4)m_pyramidCamera);
+		m_cullShader->SetVec2("u_depthSize", (float)m_depthWidth, (float)m_depthHeight);
+		m_cullShader->SetInt("u_levels", (int)m_levels);
+		GLState::BindTexture(s_pyramidUnit, GL_TEXTURE_2D, m_pyramid);
+		GLState::BindVertexArray(m_cullVAO);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, pInstanceBuffer);
+		for (unsigned int i = 0; i < 4U; ++i)
+			glEnableVertexAttribArray(i);
+
+		// Every copy is a point, nothing is rasterised
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBeginTransformFeedback(GL_POINTS);
+		for (const Range& range : m_ranges)
+		{
+			const AABB& bounds = range.mesh->GetBounds();
+			m_cullShader->SetVec3("u_boundsMin", bounds.min);
+			m_cullShader->SetVec3("u_boundsMax", bounds.max);
+			// A model matrix per vertex rather than per instance, starting at the range's first
+			size_t offset = (size_t)range.first * sizeof(mat4);
+			for (unsigned int i = 0; i < 4U; ++i)
+				glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(offset + i * sizeof(vec4)));
+			glDrawArrays(GL_POINTS, 0, range.count);
+		}
+		glEndTransformFeedback();
+		glDisable(GL_RASTERIZER_DISCARD);
+		#ifdef _DEBUG
+		 m_fences[m_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		#endif
+	}
+
+	unsigned int HiZCuller::GetDrawBuffer(unsigned int pInstanceBuffer, unsigned int pFirst) const
+	{
+		auto range = std::lower_bound(m_ranges.begin(), m_ranges.end(), pFirst,
+			[](const Range& pRange, unsigned int pValue) { return pRange.first < pValue; });
+		if (range == m_ranges.end() || range->first != pFirst)
+			return pInstanceBuffer;
+		return m_culledBuffers[m_current];
+	}
+
+	void HiZCuller::CountCulled(unsigned int pBuffer)
+	{
+		GLsync fence = (GLsync)m_fences[pBuffer];
+		if (fence == nullptr)
+			return;
+		m_fences[pBuffer] = nullptr;
+
+		// Frames the gpu is still on are left out of the report rather than waited for
+		GLenum status = glClientWaitSync(fence, 0, 0);
+		glDeleteSync(fence);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			return;
+
+		vector<mat4> copies(m_copies[pBuffer]);
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, m_culledBuffers[pBuffer]);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, copies.size() * sizeof(mat4), copies.data());
+		// Only a culled copy's matrix has no w
+		unsigned int culled = 0U;
+		for (const mat4& copy : copies)
+		{
+			if (copy[3][3] == 0.0f)
+				++culled;
+		}
+
+		++m_frames;
+		m_tested += copies.size();
+		m_culled += culled;
+	}
+
+	void HiZCuller::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_frames == 0ULL)
+		 	return;
+
+		 printf("Hi-z culling over %llu frames: %.1f instances a frame, %.1f drawn, %.1f culled (%.1f%%)\n",
+		 	m_frames, (double)m_tested / m_frames, (double)(m_tested - m_culled) / m_frames,
+		 	(double)m_culled / m_frames, (m_tested > 0ULL ? 100.0 * (double)m_culled / (double)m_tested : 0.0));
+		#endif
+	}
+}
@@ -0,0 +1,118 @@
+#pragma region
+#pragma once
+#include "FrameSnapshot.hpp"
+#include "Shader.hpp"
+#include <memory>
+
+using std::unique_ptr;
+#pragma endregion
+
+namespace Engine
+{
+	// Culls instanced copies on the gpu against a pyramid of the last frame's depth, each level holding the farthest
+	// depth of 2x2 texels of the one before. Each copy's box is tested in a vertex shader, and transform feedback
+	// captures every copy at its own index into a buffer the instanced draws then read from, culled ones collapsed
+	// to a point. Gl 3.3 has no indirect draws, so rather than packing the survivors and reading their count back,
+	// which would wait on the gpu, the draws keep their counts and the culled copies only cost their vertices
+	class HiZCuller
+	{
+	public:
+		static const unsigned int s_pyramidUnit = 9U;	// Texture unit the pyramid is read from and built with
+		static const unsigned int s_bufferCount = 4U;	// More than the frames in flight, so the report reads finished frames
+
+		HiZCuller() = default;
+
+		#pragma region Delete copy/move
+		HiZCuller(const HiZCuller&) = delete;
+		HiZCuller& operator=(const HiZCuller&) = delete;
+		HiZCuller(HiZCuller&&) = delete;
+		HiZCuller& operator=(HiZCuller&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Loads the shaders and creates the buffers, needs the context
+		 */
+		void Init();
+		/**
+		 * @brief Deletes the shaders, textures and buffers but only if they were ever created
+		 *
+		 * @param pValidate Whether the context is still alive
+		 */
+		void Destroy(bool pValidate);
+		/**
+		 * @brief Builds the pyramid from the depth of the frame just drawn, for the next frame to cull against.
+		 * Leaves the default framebuffer bound with the viewport at the size of the depth
+		 *
+		 * @param pDepthTexture The depth texture, 0 to copy the default framebuffer's depth first
+		 * @param pWidth The width of the depth in pixels
+		 * @param pHeight The height of the depth in pixels
+		 * @param pWorldToCamera The view projection matrix the depth was drawn with
+		 */
+		void Build(unsigned int pDepthTexture, unsigned int pWidth, unsigned int pHeight, const mat4& pWorldToCamera);
+		/**
+		 * @brief Tests every instanced copy of a snapshot, does nothing until a pyramid has been built
+		 *
+		 * @param pSnapshot The snapshot, its merged items are culled
+		 * @param pInstanceBuffer The buffer its instances were uploaded to
+		 */
+		void Cull(const FrameSnapshot& pSnapshot, unsigned int pInstanceBuffer);
+		/**
+		 * @brief Forgets the last cull so draws read every copy again, the pyramid is kept
+		 */
+		void Skip() { m_ranges.clear(); }
+		/**
+		 * @brief Where a range of instances is drawn from, at the same first and count
+		 *
+		 * @param pInstanceBuffer The buffer the instances were uploaded to
+		 * @param pFirst The first instance of the range
+		 * @return The culled copies if the range was culled this frame, otherwise the instance buffer
+		 */
+		unsigned int GetDrawBuffer(unsigned int pInstanceBuffer, unsigned int pFirst) const;
+		/**
+		 * @brief Prints how many instanced copies were culled
+		 */
+		void PrintReport() const;
+
+	private:
+		// A run of copies drawn with one call
+		struct Range
+		{
+			const Mesh* mesh = nullptr;
+			unsigned int first = 0U, count = 0U;
+		};
+
+		/**
+		 * @brief Makes the pyramid and its copy of the depth buffer fit a size, only when it changes
+		 *
+		 * @param pWidth The width of the depth in pixels
+		 * @param pHeight The height of the depth in pixels
+		 */
+		void Resize(unsigned int pWidth, unsigned int pHeight);
+		/**
+		 * @brief Counts the culled copies of the frame a buffer was last filled by, for the report. Only once the gpu
+		 * has finished that frame, so the count is never waited on
+		 *
+		 * @param pBuffer The index of the buffer, about to be filled again
+		 */
+		void CountCulled(unsigned int pBuffer);
+
+		unique_ptr<Shader> m_reduceShader, m_cullShader;
+		unsigned int m_emptyVAO = 0U, m_cullVAO = 0U;
+		unsigned int m_framebuffer = 0U;	// Each level of the pyramid is attached in turn
+		unsigned int m_pyramid = 0U;		// R32F, its first level is half the size of the depth
+		unsigned int m_depthCopy = 0U;		// The default framebuffer's depth, which can't be sampled directly
+		unsigned int m_depthWidth = 0U, m_depthHeight = 0U;
+		unsigned int m_levels = 0U;
+		mat4 m_pyramidCamera = mat4(1.0f);	// The view projection the pyramid's depth was drawn with
+		bool m_built = false;
+
+		unsigned int m_culledBuffers[s_bufferCount] = {};	// Each frame's culled copies, filled in turn
+		void* m_fences[s_bufferCount] = {};				// GLsync, set after each buffer is filled while reporting
+		unsigned int m_copies[s_bufferCount] = {};			// How many copies each buffer holds
+		unsigned int m_current = 0U;						// The buffer filled this frame
+		vector<Range> m_ranges;				// Sorted by first instance, empty when nothing was culled this frame
+
+		// Totals for the report
+		unsigned long long m_frames = 0ULL, m_tested = 0ULL, m_culled = 0ULL;
+	};
+}
@@ -1,6 +1,174 @@
+#pragma region
 #include "Input.hpp"
+#define GLFW_INCLUDE_NONE	// Only the key codes are needed
+#include <GLFW/glfw3.h>
+#pragma endregion
 
 namespace Engine
 {
-	
+	Input::Input()
+	{
+		// Default bindings, the same keys ProcessInput used to poll
+		Bind(Action::MoveForward, GLFW_KEY_W);
+		Bind(Action::MoveBack, GLFW_KEY_S);
+		Bind(Action::MoveLeft, GLFW_KEY_A);
+		Bind(Action::MoveRight, GLFW_KEY_D);
+		Bind(Action::MoveUp, GLFW_KEY_SPACE);
+		Bind(Action::MoveDown, GLFW_KEY_C);
+		Bind(Action::Slow, GLFW_KEY_LEFT_CONTROL);
+		Bind(Action::Fast, GLFW_KEY_LEFT_SHIFT);
+		Bind(Action::Quit, GLFW_KEY_END);
+		Bind(Action::WireframeOff, GLFW_KEY_F1);
+		Bind(Action::WireframeOn, GLFW_KEY_F2);
+		Bind(Action::SpotAngleUp, GLFW_KEY_T);
+		Bind(Action::SpotAngleDown, GLFW_KEY_G);
+		Bind(Action::SpotBlurUp, GLFW_KEY_Y);
+		Bind(Action::SpotBlurDown, GLFW_KEY_H);
+		Bind(Action::ForwardShading, GLFW_KEY_F3);
+		Bind(Action::DeferredShading, GLFW_KEY_F4);
+	}
+
+	void Input::PushKey(int pKey, bool pDown, double pTime)
+	{
+		InputEvent event;
+		event.time = pTime;
+		event.type = InputEventType::Key;
+		event.key = pKey;
+		event.down = pDown;
+		if (!m_events.Push(event))
+			m_dropped.fetch_add(1ULL, std::memory_order_relaxed);
+	}
+
+	void Input::PushCursor(double pPosX, double pPosY, double pTime)
+	{
+		InputEvent event;
+		event.time = pTime;
+		event.type = InputEventType::Cursor;
+		event.x = pPosX;
+		event.y = pPosY;
+		// Positions are absolute so a dropped event only delays movement until the next one
+		if (!m_events.Push(event))
+			m_dropped.fetch_add(1ULL, std::memory_order_relaxed);
+	}
+
+	void Input::PushScroll(double pOffsetX, double pOffsetY, double pTime)
+	{
+		InputEvent event;
+		event.time = pTime;
+		event.type = InputEventType::Scroll;
+		event.x = pOffsetX;
+		event.y = pOffsetY;
+		if (!m_events.Push(event))
+			m_dropped.fetch_add(1ULL, std::memory_order_relaxed);
+	}
+
+	void Input::Bind(Action pAction, int pKey)
+	{
+		if (pAction >= Action::Count)
+			return;
+
+		m_bindings[(unsigned int)pAction] = pKey;
+	}
+
+	bool Input::GetAction(Action pAction) const
+	{
+		return (pAction < Action::Count ? m_actions[(unsigned int)pAction] : false);
+	}
+
+	bool Input::GetActionPressed(Action pAction) const
+	{
+		return (pAction < Action::Count ? m_actionsPressed[(unsigned int)pAction] : false);
+	}
+
+	void Input::Update()
+	{
+		Drain();
+		m_mouseDelta = vec2((float)m_pendingX, (float)m_pendingY);
+		m_scroll = m_pendingScroll;
+		m_pendingX = m_pendingY = 0.0;
+		m_pendingScroll = vec2(0.0f);
+
+		for (unsigned int i = 0; i < s_actionCount; ++i)
+		{
+			int key = m_bindings[i];
+			bool held = (key >= 0 && key < s_keyCount ? m_keys[key] : false);
+			m_actionsPressed[i] = held && !m_actions[i];
+			m_actions[i] = held;
+		}
+	}
+
+	vec2 Input::LatchMouseDelta()
+	{
+		Drain();
+		vec2 delta = vec2((float)m_pendingX, (float)m_pendingY);
+		m_pendingX = m_pendingY = 0.0;
+		return delta;
+	}
+
+	InputFrame Input::Capture(double pDeltaTime) const
+	{
+		InputFrame frame;
+		frame.deltaTime = pDeltaTime;
+		for (unsigned int i = 0; i < s_actionCount; ++i)
+		{
+			if (m_actions[i])
+				frame.actions |= 1U << i;
+		}
+		frame.mouseDelta = m_mouseDelta;
+		frame.scroll = m_scroll;
+		return frame;
+	}
+
+	void Input::Apply(const InputFrame& pFrame)
+	{
+		// Whatever the window queued is thrown away so it can't leak into the replay
+		Drain();
+		m_pendingX = m_pendingY = 0.0;
+		m_pendingScroll = vec2(0.0f);
+
+		for (unsigned int i = 0; i < s_actionCount; ++i)
+		{
+			bool held = (pFrame.actions & (1U << i)) != 0U;
+			m_actionsPressed[i] = held && !m_actions[i];
+			m_actions[i] = held;
+		}
+		m_mouseDelta = pFrame.mouseDelta;
+		m_scroll = pFrame.scroll;
+	}
+
+	void Input::Drain()
+	{
+		InputEvent event;
+		while (m_events.Pop(event))
+		{
+			switch (event.type)
+			{
+				case InputEventType::Key:
+					if (event.key >= 0 && event.key < s_keyCount)
+						m_keys[event.key] = event.down;
+					break;
+				case InputEventType::Cursor:
+					// Only summed here, whatever uses it does the expensive work once per frame
+					if (m_hasCursor)
+					{
+						m_pendingX += event.x - m_cursorX;
+						m_pendingY += event.y - m_cursorY;
+					}
+					m_cursorX = event.x;
+					m_cursorY = event.y;
+					m_hasCursor = true;
+					break;
+				case InputEventType::Scroll:
+					m_pendingScroll += vec2((float)event.x, (float)event.y);
+					break;
+			}
+		}
+	}
+
+	void Input::SetCursorOrigin(double pPosX, double pPosY)
+	{
+		m_cursorX = pPosX;
+		m_cursorY = pPosY;
+		m_hasCursor = true;
+	}
 }
@@ -1,9 +1,57 @@
+#pragma region
 #pragma once
+#include "SpscRing.hpp"
+#include "InputRecorder.hpp"
+#include "glm/glm.hpp"
+#include <cstdint>
+
+using glm::vec2;
+#pragma endregion
 
 struct GLFWwindow;
 
 namespace Engine
 {
+	// Everything the application responds to, keys are bound to these rather than read directly
+	enum class Action : uint8_t
+	{
+		MoveForward,
+		MoveBack,
+		MoveLeft,
+		MoveRight,
+		MoveUp,
+		MoveDown,
+		Slow,
+		Fast,
+		Quit,
+		WireframeOff,
+		WireframeOn,
+		SpotAngleUp,
+		SpotAngleDown,
+		SpotBlurUp,
+		SpotBlurDown,
+		ForwardShading,
+		DeferredShading,
+		Count
+	};
+
+	enum class InputEventType : uint8_t
+	{
+		Key,
+		Cursor,
+		Scroll
+	};
+
+	// A single raw input as it arrived from the window
+	struct InputEvent
+	{
+		double time = 0.0;			// Seconds, from glfwGetTime()
+		InputEventType type = InputEventType::Key;
+		int key = 0;				// Key events only
+		bool down = false;			// Key events only, repeats count as down
+		double x = 0.0, y = 0.0;	// Cursor position or scroll offset
+	};
+
 	// Singleton class used for handling inputs
 	class Input
 	{
@@ -15,11 +63,63 @@ namespace Engine
 			return sm_instance;
 		}
 
-		//void ProcessInput(GLFWwindow* pWindow);
+		/**
+		 * @brief Queues a key change, called from the window callbacks
+		 *
+		 * @param pKey The glfw key code
+		 * @param pDown Whether the key is now held
+		 * @param pTime When the event arrived
+		 */
+		void PushKey(int pKey, bool pDown, double pTime);
+		/**
+		 * @brief Queues a cursor position, called from the window callbacks
+		 *
+		 * @param pPosX The cursor's x position
+		 * @param pPosY The cursor's y position
+		 * @param pTime When the event arrived
+		 */
+		void PushCursor(double pPosX, double pPosY, double pTime);
+		/**
+		 * @brief Queues a scroll, called from the window callbacks
+		 *
+		 * @param pOffsetX The horizontal scroll
+		 * @param pOffsetY The vertical scroll
+		 * @param pTime When the event arrived
+		 */
+		void PushScroll(double pOffsetX, double pOffsetY, double pTime);
+
+		/**
+		 * @brief Binds a key to an action, replacing the action's previous key
+		 *
+		 * @param pAction The action
+		 * @param pKey The glfw key code
+		 */
+		void Bind(Action pAction, int pKey);
+
+		/**
+		 * @brief Whether the action's key is held
+		 */
+		bool GetAction(Action pAction) const;
+		/**
+		 * @brief Whether the action's key went down since the last update
+		 */
+		bool GetActionPressed(Action pAction) const;
+		/**
+		 * @brief The cursor movement accumulated by the last update
+		 */
+		vec2 GetMouseDelta() const { return m_mouseDelta; }
+		/**
+		 * @brief The scroll accumulated by the last update
+		 */
+		vec2 GetScroll() const { return m_scroll; }
+		/**
+		 * @brief How many events have been lost to a full queue
+		 */
+		unsigned long long GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
 
 	private:
 		#pragma region Constructors
-		Input() = default;
+		Input();
 		~Input() {};
 		// Delete copy/move so extra instances can't be created/moved.
 		Input(const Input&) = delete;
@@ -27,5 +127,61 @@ namespace Engine
 		Input(Input&&) = delete;
 		Input& operator=(Input&&) = delete;
 		#pragma endregion
+
+		/**
+		 * @brief Drains the event queue and resolves the action states, the deltas and pressed states are
+		 * replaced rather than added to so call it once per frame
+		 */
+		void Update();
+		/**
+		 * @brief Drains the event queue mid frame and takes only the cursor movement, keys and scroll are
+		 * held back for the next update
+		 *
+		 * @return The cursor movement since the last update or latch
+		 */
+		vec2 LatchMouseDelta();
+		/**
+		 * @brief Copies the state resolved by the last update, for recording
+		 *
+		 * @param pDeltaTime The frame's delta time, stored alongside
+		 * @return The frame's input
+		 */
+		InputFrame Capture(double pDeltaTime) const;
+		/**
+		 * @brief Replaces the state with a recorded frame, used instead of Update() while replaying
+		 *
+		 * @param pFrame The recorded input
+		 */
+		void Apply(const InputFrame& pFrame);
+		/**
+		 * @brief Applies every queued event to the key states and pending movement
+		 */
+		void Drain();
+		/**
+		 * @brief Sets where cursor movement is measured from, so the first event isn't a jump
+		 *
+		 * @param pPosX The cursor's x position
+		 * @param pPosY The cursor's y position
+		 */
+		void SetCursorOrigin(double pPosX, double pPosY);
+
+		static const int s_keyCount = 349;				// GLFW_KEY_LAST + 1
+		static const size_t s_queueSize = 4096U;		// Several frames of an 8khz mouse at a low frame rate
+		static const unsigned int s_actionCount = (unsigned int)Action::Count;
+		static_assert(s_actionCount <= 32U, "Actions are recorded as a 32 bit mask");
+
+		SpscRing<InputEvent, s_queueSize> m_events;
+		std::atomic<unsigned long long> m_dropped = 0ULL;
+
+		bool m_keys[s_keyCount] = {};					// Held state of every key, updated from events
+		int m_bindings[s_actionCount] = {};				// The key bound to each action
+		bool m_actions[s_actionCount] = {};				// Held state of each action as of the last update
+		bool m_actionsPressed[s_actionCount] = {};		// Went down during the last update
+
+		double m_cursorX = 0.0, m_cursorY = 0.0;		// Cursor position at the last event consumed
+		bool m_hasCursor = false;
+		double m_pendingX = 0.0, m_pendingY = 0.0;		// Cursor movement drained but not yet handed out
+		vec2 m_pendingScroll = vec2(0.0f);
+		vec2 m_mouseDelta = vec2(0.0f), m_scroll = vec2(0.0f);
 	};
 }
@@ -0,0 +1,137 @@
+#pragma region
+#include "InputRecorder.hpp"
+#include <fstream>
+#ifdef _DEBUG
+ #include <iostream>
+ using std::cout;
+ using std::endl;
+#endif
+
+using std::ofstream;
+using std::ifstream;
+using std::ios;
+#pragma endregion
+
+namespace Engine
+{
+	// File layout, all little endian:
+	// uint32 magic, uint32 version, uint32 frame count, then per frame:
+	// float64 delta time, uint32 actions, float32 mouse x, mouse y, scroll x, scroll y
+
+	void InputRecorder::StartRecording(string pPath)
+	{
+		m_recording = true;
+		m_replaying = false;
+		m_path = pPath;
+		m_frames.clear();
+		// Ten minutes at 144hz before the first reallocation
+		m_frames.reserve(86400U);
+	}
+
+	bool InputRecorder::LoadReplay(string pPath)
+	{
+		m_recording = false;
+		m_replaying = false;
+		m_frames.clear();
+		m_position = 0U;
+
+		ifstream inStream(pPath, ios::binary | ios::ate);
+		if (!inStream.is_open())
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to open input replay \"" << pPath << "\"" << endl;
+			#endif
+			return false;
+		}
+		// Opened at the end to find the size, which bounds how many frames the header can claim
+		unsigned long long fileSize = (unsigned long long)inStream.tellg();
+		inStream.seekg(0);
+
+		uint32_t header[3] = {};
+		inStream.read((char*)header, sizeof(header));
+		if (!inStream || header[0] != s_magic || header[1] != s_version)
+		{
+			#ifdef _DEBUG
+			 cout << "\"" << pPath << "\" is not an input recording" << endl;
+			#endif
+			return false;
+		}
+		if ((unsigned long long)header[2] * s_frameSize > fileSize - sizeof(header))
+		{
+			#ifdef _DEBUG
+			 cout << "Input replay \"" << pPath << "\" is truncated" << endl;
+			#endif
+			return false;
+		}
+
+		m_frames.resize(header[2]);
+		for (InputFrame& frame : m_frames)
+		{
+			inStream.read((char*)&frame.deltaTime, sizeof(double));
+			inStream.read((char*)&frame.actions, sizeof(uint32_t));
+			inStream.read((char*)&frame.mouseDelta, sizeof(float) * 2);
+			inStream.read((char*)&frame.scroll, sizeof(float) * 2);
+		}
+		if (!inStream)
+		{
+			#ifdef _DEBUG
+			 cout << "Input replay \"" << pPath << "\" is truncated" << endl;
+			#endif
+			m_frames.clear();
+			return false;
+		}
+
+		#ifdef _DEBUG
+		 cout << "Replaying " << m_frames.size() << " frames of input from \"" << pPath << "\"" << endl;
+		#endif
+		m_replaying = true;
+		return true;
+	}
+
+	bool InputRecorder::Finish()
+	{
+		if (!m_recording)
+			return true;
+		m_recording = false;
+
+		ofstream outStream(m_path, ios::binary);
+		if (!outStream.is_open())
+		{
+			#ifdef _DEBUG
+			 cout << "Failed to write input recording to \"" << m_path << "\"" << endl;
+			#endif
+			return false;
+		}
+
+		// Fields are written one at a time so struct padding never reaches the file
+		uint32_t header[3] = { s_magic, s_version, (uint32_t)m_frames.size() };
+		outStream.write((const char*)header, sizeof(header));
+		for (const InputFrame& frame : m_frames)
+		{
+			outStream.write((const char*)&frame.deltaTime, sizeof(double));
+			outStream.write((const char*)&frame.actions, sizeof(uint32_t));
+			outStream.write((const char*)&frame.mouseDelta, sizeof(float) * 2);
+			outStream.write((const char*)&frame.scroll, sizeof(float) * 2);
+		}
+
+		#ifdef _DEBUG
+		 cout << "Input recording of " << m_frames.size() << " frames written to \"" << m_path << "\"" << endl;
+		#endif
+		return (bool)outStream;
+	}
+
+	void InputRecorder::RecordFrame(const InputFrame& pFrame)
+	{
+		if (m_recording)
+			m_frames.push_back(pFrame);
+	}
+
+	bool InputRecorder::NextFrame(InputFrame& pFrame)
+	{
+		if (!m_replaying || m_position >= m_frames.size())
+			return false;
+
+		pFrame = m_frames[m_position++];
+		return true;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma region
+#pragma once
+#include "glm/glm.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using glm::vec2;
+using std::string;
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	// The input resolved for one frame, everything needed to reproduce it
+	struct InputFrame
+	{
+		double deltaTime = 0.0;			// Seconds since the previous frame
+		uint32_t actions = 0U;			// Bit per Action, set while held
+		vec2 mouseDelta = vec2(0.0f);
+		vec2 scroll = vec2(0.0f);
+	};
+
+	// Records the per-frame input to a compact binary file and plays it back, so a run can be repeated
+	// frame for frame on any machine
+	class InputRecorder
+	{
+	public:
+		InputRecorder() = default;
+		~InputRecorder() {}
+
+		/**
+		 * @brief Starts collecting frames, the file is written by Finish()
+		 *
+		 * @param pPath The file the recording is written to
+		 */
+		void StartRecording(string pPath);
+		/**
+		 * @brief Loads a recording to be played back
+		 *
+		 * @param pPath The file to read
+		 * @return If the file was a valid recording
+		 */
+		bool LoadReplay(string pPath);
+		/**
+		 * @brief Writes the recording if there is one
+		 *
+		 * @return If nothing needed writing or the file was written
+		 */
+		bool Finish();
+
+		/**
+		 * @brief Adds a frame to the recording, does nothing unless recording
+		 *
+		 * @param pFrame The frame's input
+		 */
+		void RecordFrame(const InputFrame& pFrame);
+		/**
+		 * @brief Gets the next frame of the replay
+		 *
+		 * @param pFrame Filled with the frame's input
+		 * @return False once the replay has run out
+		 */
+		bool NextFrame(InputFrame& pFrame);
+
+		bool GetRecording() const { return m_recording; }
+		bool GetReplaying() const { return m_replaying; }
+		/**
+		 * @brief Whether every frame of the replay has been handed out
+		 */
+		bool GetFinished() const { return m_replaying && m_position >= m_frames.size(); }
+		unsigned int GetFrameCount() const { return (unsigned int)m_frames.size(); }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, there is only ever one recording per run.
+		InputRecorder(const InputRecorder&) = delete;
+		InputRecorder& operator=(const InputRecorder&) = delete;
+		InputRecorder(InputRecorder&&) = delete;
+		InputRecorder& operator=(InputRecorder&&) = delete;
+		#pragma endregion
+
+		static const uint32_t s_magic = 0x52494C47U;	// "GLIR" read as little endian
+		static const uint32_t s_version = 1U;
+		static const unsigned long long s_frameSize = sizeof(double) + sizeof(uint32_t) + sizeof(float) * 4U;	// Bytes per frame
+
+		bool m_recording = false, m_replaying = false;
+		string m_path;
+		vector<InputFrame> m_frames;	// Kept in memory so recording never touches the disk mid run
+		size_t m_position = 0U;			// The next frame to replay
+	};
+}
@@ -11,6 +11,7 @@ namespace Engine
 		//m_transform = mat4(1);
 		m_lightColour = vec3(1);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Generic
 	Light::Light(LightType pType, mat4 pTransform)
@@ -19,6 +20,7 @@ namespace Engine
 		SetTransform(pTransform);
 		m_lightColour = vec3(1);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Generic
 	Light::Light(LightType pType, mat4 pTransform, vec3 pColour)
@@ -26,6 +28,7 @@ namespace Engine
 	{
 		SetTransform(pTransform);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Directional
 	Light::Light(LightType pType, vec3 pDirection)
@@ -35,6 +38,7 @@ namespace Engine
 		SetForward(pDirection);
 		m_lightColour = vec3(1);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Directional
 	Light::Light(LightType pType, vec3 pDirection, vec3 pColour)
@@ -43,6 +47,7 @@ namespace Engine
 		//m_transform = mat4(1);
 		SetForward(pDirection);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Point
 	Light::Light(LightType pType, vec4 pPosition)
@@ -52,6 +57,7 @@ namespace Engine
 		SetPosition(pPosition);
 		m_lightColour = vec3(1);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Point
 	Light::Light(LightType pType, vec4 pPosition, vec3 pColour)
@@ -60,6 +66,7 @@ namespace Engine
 		//m_transform = mat4(1);
 		SetPosition(pPosition);
 		m_angle = glm::cos(glm::radians(20.0f));
+		UpdateCone();
 	}
 	// Spot
 	Light::Light(LightType pType, mat4 pTransform, float pAngle, float pBlur)
@@ -67,12 +74,14 @@ namespace Engine
 	{
 		SetTransform(pTransform);
 		m_lightColour = vec3(1);
+		UpdateCone();
 	}
 	// Spot
 	Light::Light(LightType pType, mat4 pTransform, vec3 pColour, float pAngle, float pBlur)
 	 : m_type(pType), m_lightColour(pColour), m_angle(pAngle), m_blur(pBlur)
 	{
 		SetTransform(pTransform);
+		UpdateCone();
 	}
 	// Spot
 	Light::Light(LightType pType, vec4 pPosition, vec3 pDirection, vec3 pColour, float pAngle, float pBlur)
@@ -81,22 +90,35 @@ namespace Engine
 		//m_transform = mat4(1);
 		SetPosition(pPosition);
 		SetForward(pDirection);
+		UpdateCone();
 	}
 	#pragma endregion
 	#pragma region Setters
 	void Light::SetColour(vec3 pColour)
 	{
 		m_lightColour = pColour;
+		m_dirty = true;
 	}
 
 	void Light::SetAngle(float pValue)
 	{
 		m_angle = pValue;
+		UpdateCone();
+		m_dirty = true;
 	}
 
 	void Light::SetBlur(float pValue)
 	{
 		m_blur = pValue;
+		UpdateCone();
+		m_dirty = true;
+	}
+
+	void Light::SetAttenuation(float pLinear, float pQuadratic)
+	{
+		m_linear = pLinear;
+		m_quadratic = pQuadratic;
+		m_dirty = true;
 	}
 	#pragma endregion
 	#pragma region Getters
@@ -115,9 +137,9 @@ namespace Engine
 		return m_lightColour;
 	}
 	
-	float Light::GetAngle()
+	float Light::GetAngle() const
 	{
-		return std::cosf(glm::radians(m_angle));
+		return m_cosAngle;
 	}
 	
 	float Light::GetAngleRaw() const
@@ -125,14 +147,30 @@ namespace Engine
 		return m_angle;
 	}
 	
-	float Light::GetBlur()
+	float Light::GetBlur() const
 	{
-		return std::sinf(glm::radians(90 * m_blur));
+		return m_sinBlur;
 	}
 
 	float Light::GetBlurRaw() const
 	{
 		return m_blur;
 	}
+
+	float Light::GetLinear() const
+	{
+		return m_linear;
+	}
+
+	float Light::GetQuadratic() const
+	{
+		return m_quadratic;
+	}
 	#pragma endregion
+
+	void Light::UpdateCone()
+	{
+		m_cosAngle = glm::cos(glm::radians(m_angle));
+		m_sinBlur = glm::sin(glm::radians(90 * m_blur));
+	}
 }
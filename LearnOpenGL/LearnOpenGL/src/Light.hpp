@@ -30,21 +30,37 @@ namespace Engine
 		void SetColour(vec3 pColour);
 		void SetAngle(float pValue);
 		void SetBlur(float pValue);
+		/**
+		 * @brief How quickly a point or spot light fades over distance
+		 *
+		 * @param pLinear The linear term
+		 * @param pQuadratic The quadratic term
+		 */
+		void SetAttenuation(float pLinear, float pQuadratic);
 		#pragma endregion
 		#pragma region Getters
 		LightType GetType() const;
 		vec4 GetDirection() const;
 		vec3 GetColour() const;
-		float GetAngle();
+		float GetAngle() const;
 		float GetAngleRaw() const;
-		float GetBlur();
+		float GetBlur() const;
 		float GetBlurRaw() const;
+		float GetLinear() const;
+		float GetQuadratic() const;
 		#pragma endregion
 
 	private:
+		/**
+		 * @brief Works out the cosine of the angle and sine of the blur, so getting them is free
+		 */
+		void UpdateCone();
+
 		LightType m_type;
 		vec3 m_lightColour;
 		float m_angle;		// Only for spotlights
 		float m_blur;		// Only for spotlights
+		float m_cosAngle = 1.0f, m_sinBlur = 0.0f;
+		float m_linear = 0.045f, m_quadratic = 0.0075f;	// Only for point and spotlights
 	};
 }
@@ -0,0 +1,238 @@
+#pragma region
+#include "LightClusters.hpp"
+#include "Camera.hpp"
+#include "GLState.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define CLUSTERS_SSE
+ #include <emmintrin.h>
+#endif
+#pragma endregion
+
+namespace Engine
+{
+	// Static
+	const float LightClusters::s_nearSlice = 0.1f;
+
+	static_assert(LightClusters::s_tilesPerSlice % 4U == 0U, "Cells are tested four at a time so a slice must fill whole groups");
+
+	void LightClusters::Init()
+	{
+		glGenBuffers(1, &m_gridBuffer);
+		GLState::BindBuffer(GL_TEXTURE_BUFFER, m_gridBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, s_clusterCount * 2U * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+		glGenTextures(1, &m_gridTexture);
+		GLState::BindTexture(s_gridUnit, GL_TEXTURE_BUFFER, m_gridTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, m_gridBuffer);
+
+		// Grows when a frame needs more, this is room for a few lights in every cell
+		m_indexCapacity = s_clusterCount * 4U;
+		glGenBuffers(1, &m_indexBuffer);
+		GLState::BindBuffer(GL_TEXTURE_BUFFER, m_indexBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, m_indexCapacity * sizeof(uint16_t), nullptr, GL_STREAM_DRAW);
+		glGenTextures(1, &m_indexTexture);
+		GLState::BindTexture(s_indexUnit, GL_TEXTURE_BUFFER, m_indexTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, m_indexBuffer);
+	}
+
+	void LightClusters::Destroy(bool pValidate)
+	{
+		if (pValidate && m_gridBuffer != 0U)
+		{
+			glDeleteTextures(1, &m_gridTexture);
+			glDeleteTextures(1, &m_indexTexture);
+			glDeleteBuffers(1, &m_gridBuffer);
+			glDeleteBuffers(1, &m_indexBuffer);
+			GLState::Invalidate();
+		}
+		m_gridBuffer = m_gridTexture = m_indexBuffer = m_indexTexture = 0U;
+	}
+
+	void LightClusters::Build(const LightRegistry& pLights, const mat4& pView, const mat4& pProjection, WorkerPool& pWorkers, ClusterData& pOut)
+	{
+		if (pProjection[0][0] != m_boundsScaleX || pProjection[1][1] != m_boundsScaleY)
+			BuildBounds(pProjection);
+
+		// Every light as a sphere in view space, behind the camera ones are left out
+		m_spheres.clear();
+		m_sphereIds.clear();
+		const vector<Light*>* lists[2] = { &pLights.GetPointLights(), &pLights.GetSpotLights() };
+		for (unsigned int list = 0; list < 2; ++list)
+		{
+			for (size_t i = 0; i < lists[list]->size(); ++i)
+			{
+				const Light* light = (*lists[list])[i];
+				vec4 centre = pView * vec4(vec3(light->GetPosition()), 1.0f);
+				float range = GetLightRange(light->GetLinear(), light->GetQuadratic());
+				if (centre.z - range > 0.0f)
+					continue;
+
+				m_spheres.push_back(vec4(vec3(centre), range));
+				m_sphereIds.push_back((uint16_t)(i | (list == 1U ? s_spotBit : 0U)));
+			}
+		}
+
+		m_cellCounts.assign(s_clusterCount, 0U);
+		m_cellLights.resize((size_t)s_clusterCount * s_maxLightsPerCluster);
+		// Each slice only writes its own cells so they need no locking
+		pWorkers.ParallelFor(s_slices, 1U, [this](unsigned int pBegin, unsigned int pEnd) { BinSlices(pBegin, pEnd); });
+
+		// Packs the fixed size lists into one for the upload
+		pOut.enabled = true;
+		pOut.grid.resize(s_clusterCount * 2U);
+		pOut.indices.clear();
+		for (unsigned int cell = 0; cell < s_clusterCount; ++cell)
+		{
+			unsigned int count = m_cellCounts[cell];
+			pOut.grid[cell * 2U] = (uint32_t)pOut.indices.size();
+			pOut.grid[cell * 2U + 1U] = count;
+			const uint16_t* lights = &m_cellLights[(size_t)cell * s_maxLightsPerCluster];
+			pOut.indices.insert(pOut.indices.end(), lights, lights + count);
+		}
+	}
+
+	void LightClusters::Upload(const ClusterData& pClusters)
+	{
+		if (!pClusters.enabled || pClusters.grid.empty())
+			return;
+
+		GLState::BindBuffer(GL_TEXTURE_BUFFER, m_gridBuffer);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, pClusters.grid.size() * sizeof(uint32_t), pClusters.grid.data());
+
+		if (pClusters.indices.empty())
+			return;
+
+		GLState::BindBuffer(GL_TEXTURE_BUFFER, m_indexBuffer);
+		if (pClusters.indices.size() > m_indexCapacity)
+			m_indexCapacity = pClusters.indices.size() + pClusters.indices.size() / 2U;
+		// Orphaning lets the driver hand out new storage instead of waiting on frames still reading the old
+		glBufferData(GL_TEXTURE_BUFFER, m_indexCapacity * sizeof(uint16_t), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, pClusters.indices.size() * sizeof(uint16_t), pClusters.indices.data());
+	}
+
+	// Static
+	float LightClusters::GetLightRange(float pLinear, float pQuadratic)
+	{
+		// Where 1 / (1 + linear * d + quadratic * d^2) falls to 1/256, the smallest step an 8 bit colour shows
+		const float dimmest = 255.0f;
+		if (pQuadratic > 0.0f)
+			return (-pLinear + std::sqrt(pLinear * pLinear + 4.0f * pQuadratic * dimmest)) / (2.0f * pQuadratic);
+		if (pLinear > 0.0f)
+			return dimmest / pLinear;
+		return std::numeric_limits<float>::max();
+	}
+
+	// Static
+	glm::vec2 LightClusters::GetSliceScaleBias()
+	{
+		// Slice 1 starts at the near slice and the last ends at the far plane, anything closer is slice 0
+		float scale = (float)(s_slices - 1U) / std::log(Camera::s_farPlane / s_nearSlice);
+		float bias = 1.0f - std::log(s_nearSlice) * scale;
+		return glm::vec2(scale, bias);
+	}
+
+	void LightClusters::BuildBounds(const mat4& pProjection)
+	{
+		m_boundsScaleX = pProjection[0][0];
+		m_boundsScaleY = pProjection[1][1];
+
+		m_sliceDepths[0] = 0.0f;
+		for (unsigned int s = 1; s < s_slices; ++s)
+			m_sliceDepths[s] = s_nearSlice * std::pow(Camera::s_farPlane / s_nearSlice, (float)(s - 1U) / (float)(s_slices - 1U));
+		m_sliceDepths[s_slices] = Camera::s_farPlane;
+
+		m_minX.resize(s_clusterCount);
+		m_minY.resize(s_clusterCount);
+		m_minZ.resize(s_clusterCount);
+		m_maxX.resize(s_clusterCount);
+		m_maxY.resize(s_clusterCount);
+		m_maxZ.resize(s_clusterCount);
+
+		// At a distance d a point at x in normalised device coordinates is x * d / projection[0][0] across in view space
+		float toViewX = 1.0f / m_boundsScaleX, toViewY = 1.0f / m_boundsScaleY;
+		for (unsigned int s = 0; s < s_slices; ++s)
+		{
+			float nearDepth = m_sliceDepths[s], farDepth = m_sliceDepths[s + 1U];
+			for (unsigned int y = 0; y < s_tilesY; ++y)
+			{
+				float bottom = -1.0f + 2.0f * y / s_tilesY, top = -1.0f + 2.0f * (y + 1U) / s_tilesY;
+				for (unsigned int x = 0; x < s_tilesX; ++x)
+				{
+					float left = -1.0f + 2.0f * x / s_tilesX, right = -1.0f + 2.0f * (x + 1U) / s_tilesX;
+					unsigned int cell = x + y * s_tilesX + s * s_tilesPerSlice;
+					m_minX[cell] = std::min(left * nearDepth, left * farDepth) * toViewX;
+					m_maxX[cell] = std::max(right * nearDepth, right * farDepth) * toViewX;
+					m_minY[cell] = std::min(bottom * nearDepth, bottom * farDepth) * toViewY;
+					m_maxY[cell] = std::max(top * nearDepth, top * farDepth) * toViewY;
+					// View space looks down negative z
+					m_minZ[cell] = -farDepth;
+					m_maxZ[cell] = -nearDepth;
+				}
+			}
+		}
+	}
+
+	void LightClusters::BinSlices(unsigned int pBegin, unsigned int pEnd)
+	{
+		for (unsigned int s = pBegin; s < pEnd; ++s)
+		{
+			float nearDepth = m_sliceDepths[s], farDepth = m_sliceDepths[s + 1U];
+			unsigned int firstCell = s * s_tilesPerSlice;
+			for (size_t i = 0; i < m_spheres.size(); ++i)
+			{
+				const vec4& sphere = m_spheres[i];
+				// Skips the whole slice when the sphere doesn't reach its depths
+				float depth = -sphere.z;
+				if (depth + sphere.w < nearDepth || depth - sphere.w > farDepth)
+					continue;
+
+				for (unsigned int t = 0; t < s_tilesPerSlice; t += 4U)
+				{
+					int mask = TestCells(firstCell + t, sphere);
+					for (unsigned int bit = 0; mask != 0; ++bit, mask >>= 1)
+					{
+						if ((mask & 1) == 0)
+							continue;
+
+						unsigned int cell = firstCell + t + bit;
+						uint16_t& count = m_cellCounts[cell];
+						if (count < s_maxLightsPerCluster)
+							m_cellLights[(size_t)cell * s_maxLightsPerCluster + count++] = m_sphereIds[i];
+					}
+				}
+			}
+		}
+	}
+
+	int LightClusters::TestCells(unsigned int pCell, const vec4& pSphere) const
+	{
+		#ifdef CLUSTERS_SSE
+		 // The distance from the centre to each box along each axis, 0 when inside it
+		 const __m128 zero = _mm_setzero_ps();
+		 __m128 centreX = _mm_set1_ps(pSphere.x), centreY = _mm_set1_ps(pSphere.y), centreZ = _mm_set1_ps(pSphere.z);
+		 __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minX[pCell]), centreX),
+		 	_mm_sub_ps(centreX, _mm_loadu_ps(&m_maxX[pCell]))), zero);
+		 __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minY[pCell]), centreY),
+		 	_mm_sub_ps(centreY, _mm_loadu_ps(&m_maxY[pCell]))), zero);
+		 __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minZ[pCell]), centreZ),
+		 	_mm_sub_ps(centreZ, _mm_loadu_ps(&m_maxZ[pCell]))), zero);
+		 __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		 return _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(pSphere.w * pSphere.w)));
+		#else
+		 int mask = 0;
+		 for (unsigned int i = 0; i < 4U; ++i)
+		 {
+		 	unsigned int cell = pCell + i;
+		 	float dx = std::max(std::max(m_minX[cell] - pSphere.x, pSphere.x - m_maxX[cell]), 0.0f);
+		 	float dy = std::max(std::max(m_minY[cell] - pSphere.y, pSphere.y - m_maxY[cell]), 0.0f);
+		 	float dz = std::max(std::max(m_minZ[cell] - pSphere.z, pSphere.z - m_maxZ[cell]), 0.0f);
+		 	if (dx * dx + dy * dy + dz * dz <= pSphere.w * pSphere.w)
+		 		mask |= 1 << i;
+		 }
+		 return mask;
+		#endif
+	}
+}
@@ -0,0 +1,113 @@
+#pragma region
+#pragma once
+#include "LightRegistry.hpp"
+#include "WorkerPool.hpp"
+#include <cstdint>
+#pragma endregion
+
+namespace Engine
+{
+	// Splits the view frustum into cells, screen tiles by slices of depth, and lists the lights that reach each one
+	// so the fragment shader only shades those. Binning runs on the cpu across the worker pool
+	class LightClusters
+	{
+	public:
+		static const unsigned int s_tilesX = 16U, s_tilesY = 9U, s_slices = 24U;
+		static const unsigned int s_tilesPerSlice = s_tilesX * s_tilesY;
+		static const unsigned int s_clusterCount = s_tilesPerSlice * s_slices;
+		// Room for every light the registry holds, so a crowded cell never drops one
+		static const unsigned int s_maxLightsPerCluster = LightRegistry::s_maxPointLights + LightRegistry::s_maxSpotLights;
+		static const uint16_t s_spotBit = 0x8000U;				// Set on indices of spot lights
+		static const unsigned int s_gridUnit = 14U;				// Texture unit of the cell offsets and counts
+		static const unsigned int s_indexUnit = 15U;			// Texture unit of the light indices
+		static const float s_nearSlice;		// Where the exponential slices start, the first slice covers up to it
+
+		LightClusters() = default;
+
+		#pragma region Delete copy/move
+		LightClusters(const LightClusters&) = delete;
+		LightClusters& operator=(const LightClusters&) = delete;
+		LightClusters(LightClusters&&) = delete;
+		LightClusters& operator=(LightClusters&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Creates the texture buffers and binds them to their units, needs the context
+		 */
+		void Init();
+		/**
+		 * @brief Deletes the texture buffers but only if they were ever created
+		 *
+		 * @param pValidate Whether the context is still alive
+		 */
+		void Destroy(bool pValidate);
+		/**
+		 * @brief Bins every registered light's bounding sphere into the cells, makes no gl calls
+		 *
+		 * @param pLights The lights, their slots are what the indices refer to
+		 * @param pView The view matrix of the frame
+		 * @param pProjection The projection matrix of the frame, must be symmetric
+		 * @param pWorkers The threads the depth slices are split between
+		 * @param pOut Filled with every cell's range of the light indices
+		 */
+		void Build(const LightRegistry& pLights, const mat4& pView, const mat4& pProjection, WorkerPool& pWorkers, ClusterData& pOut);
+		/**
+		 * @brief Writes binned cells to the texture buffers, must be called on the thread that owns the context
+		 *
+		 * @param pClusters The cells from Build
+		 */
+		void Upload(const ClusterData& pClusters);
+
+		/**
+		 * @brief How far a light reaches before it is too dim to see, from its attenuation
+		 *
+		 * @param pLinear The linear attenuation
+		 * @param pQuadratic The quadratic attenuation
+		 * @return The distance
+		 */
+		static float GetLightRange(float pLinear, float pQuadratic);
+		/**
+		 * @brief The scale and bias that turn the log of a depth into its slice
+		 *
+		 * @return The scale in x, bias in y
+		 */
+		static glm::vec2 GetSliceScaleBias();
+
+	private:
+		/**
+		 * @brief Works out the view space bounding box of every cell, only when the projection changes
+		 *
+		 * @param pProjection The projection matrix
+		 */
+		void BuildBounds(const mat4& pProjection);
+		/**
+		 * @brief Tests every light against the cells of a range of depth slices
+		 *
+		 * @param pBegin The first slice
+		 * @param pEnd One past the last slice
+		 */
+		void BinSlices(unsigned int pBegin, unsigned int pEnd);
+		/**
+		 * @brief Finds which of four cells a sphere touches
+		 *
+		 * @param pCell The first of the cells
+		 * @param pSphere The centre in view space and radius in w
+		 * @return A bit for each cell touched
+		 */
+		int TestCells(unsigned int pCell, const vec4& pSphere) const;
+
+		// Cell bounds in view space, as separate arrays so four cells load at once
+		vector<float> m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
+		float m_sliceDepths[s_slices + 1U] = {};	// Where each slice starts as a positive distance, then the far plane
+		float m_boundsScaleX = 0.0f, m_boundsScaleY = 0.0f;	// The projection the bounds were built for
+
+		vector<vec4> m_spheres;			// Every light for this frame, in view space
+		vector<uint16_t> m_sphereIds;	// The index the shader uses for each sphere
+		vector<uint16_t> m_cellLights;	// A fixed size list for each cell so slices can be filled at the same time
+		vector<uint16_t> m_cellCounts;
+
+		unsigned int m_gridBuffer = 0U, m_gridTexture = 0U;
+		unsigned int m_indexBuffer = 0U, m_indexTexture = 0U;
+		size_t m_indexCapacity = 0U;
+	};
+}
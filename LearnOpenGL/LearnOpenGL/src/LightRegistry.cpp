@@ -0,0 +1,172 @@
+#pragma region
+#include "LightRegistry.hpp"
+#include "GLState.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#include <cstring>
+#include <algorithm>
+#pragma endregion
+
+namespace Engine
+{
+	LightRegistry::LightRegistry()
+	{
+		m_data.resize(s_size, 0U);
+		m_pointLights.reserve(s_maxPointLights);
+		m_spotLights.reserve(s_maxSpotLights);
+	}
+
+	void LightRegistry::Init()
+	{
+		glGenBuffers(1, &m_ubo);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+		glBufferData(GL_UNIFORM_BUFFER, s_size, m_data.data(), GL_DYNAMIC_DRAW);
+		GLState::BindBufferBase(GL_UNIFORM_BUFFER, s_binding, m_ubo);
+	}
+
+	void LightRegistry::Destroy(bool pValidate)
+	{
+		if (pValidate && m_ubo != 0U)
+		{
+			glDeleteBuffers(1, &m_ubo);
+			GLState::Invalidate();
+		}
+		m_ubo = 0U;
+	}
+
+	bool LightRegistry::Add(Light* pLight)
+	{
+		switch (pLight->GetType())
+		{
+			case LightType::Directional:
+				m_directional = pLight;
+				break;
+			case LightType::Point:
+				if (m_pointLights.size() >= s_maxPointLights)
+					return false;
+				m_pointLights.push_back(pLight);
+				break;
+			case LightType::Spot:
+				if (m_spotLights.size() >= s_maxSpotLights)
+					return false;
+				m_spotLights.push_back(pLight);
+				break;
+		}
+		m_countsChanged = true;
+		return true;
+	}
+
+	void LightRegistry::Remove(Light* pLight)
+	{
+		if (pLight == m_directional)
+		{
+			m_directional = nullptr;
+			m_countsChanged = true;
+			return;
+		}
+
+		vector<Light*>& lights = (pLight->GetType() == LightType::Spot ? m_spotLights : m_pointLights);
+		auto found = std::find(lights.begin(), lights.end(), pLight);
+		if (found == lights.end())
+			return;
+
+		// Swapping with the last keeps the array packed, only the moved light's slot changes
+		*found = lights.back();
+		lights.pop_back();
+		m_countsChanged = true;
+	}
+
+	void LightRegistry::Sync(LightUpload& pUpload)
+	{
+		m_dirtyBegin = s_size;
+		m_dirtyEnd = 0U;
+
+		if (m_countsChanged || (m_directional != nullptr && m_directional->GetDirty()))
+			PackHeader();
+		if (m_directional != nullptr)
+			m_directional->ClearDirty();
+
+		// Unchanged lights are written too after a removal, the bytes that didn't move are filtered out by Write
+		for (size_t i = 0; i < m_pointLights.size(); ++i)
+		{
+			if (m_countsChanged || m_pointLights[i]->GetDirty())
+				PackLight(m_pointLights[i], s_pointOffset + i * sizeof(GpuLight));
+			m_pointLights[i]->ClearDirty();
+		}
+		for (size_t i = 0; i < m_spotLights.size(); ++i)
+		{
+			if (m_countsChanged || m_spotLights[i]->GetDirty())
+				PackLight(m_spotLights[i], s_spotOffset + i * sizeof(GpuLight));
+			m_spotLights[i]->ClearDirty();
+		}
+		m_countsChanged = false;
+
+		if (m_dirtyEnd <= m_dirtyBegin)
+		{
+			pUpload.bytes.clear();
+			return;
+		}
+
+		pUpload.offset = (unsigned int)m_dirtyBegin;
+		pUpload.bytes.assign(m_data.begin() + m_dirtyBegin, m_data.begin() + m_dirtyEnd);
+	}
+
+	void LightRegistry::Upload(const LightUpload& pUpload)
+	{
+		if (pUpload.bytes.empty())
+			return;
+
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, pUpload.offset, pUpload.bytes.size(), pUpload.bytes.data());
+	}
+
+	bool LightRegistry::GetDirty() const
+	{
+		if (m_countsChanged || (m_directional != nullptr && m_directional->GetDirty()))
+			return true;
+
+		for (const Light* light : m_pointLights)
+		{
+			if (light->GetDirty())
+				return true;
+		}
+		for (const Light* light : m_spotLights)
+		{
+			if (light->GetDirty())
+				return true;
+		}
+		return false;
+	}
+
+	void LightRegistry::Write(size_t pOffset, const void* pData, size_t pSize)
+	{
+		if (std::memcmp(&m_data[pOffset], pData, pSize) == 0)
+			return;
+
+		std::memcpy(&m_data[pOffset], pData, pSize);
+		m_dirtyBegin = std::min(m_dirtyBegin, pOffset);
+		m_dirtyEnd = std::max(m_dirtyEnd, pOffset + pSize);
+	}
+
+	void LightRegistry::PackHeader()
+	{
+		GpuLightHeader header;
+		if (m_directional != nullptr)
+		{
+			header.directionalColour = vec4(m_directional->GetColour(), 0.15f);
+			header.directionalDirection = m_directional->GetDirection();
+		}
+		header.pointCount = (uint32_t)m_pointLights.size();
+		header.spotCount = (uint32_t)m_spotLights.size();
+		Write(0U, &header, sizeof(header));
+	}
+
+	void LightRegistry::PackLight(const Light* pLight, size_t pOffset)
+	{
+		GpuLight packed;
+		packed.colour = vec4(pLight->GetColour(), 0.0f);
+		packed.position = vec4(vec3(pLight->GetPosition()), pLight->GetLinear());
+		packed.direction = vec4(vec3(pLight->GetDirection()), pLight->GetQuadratic());
+		packed.cone = vec4(pLight->GetAngle(), pLight->GetBlur(), 0.0f, 0.0f);
+		Write(pOffset, &packed, sizeof(packed));
+	}
+}
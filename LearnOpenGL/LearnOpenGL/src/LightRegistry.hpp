@@ -0,0 +1,120 @@
+#pragma region
+#pragma once
+#include "Light.hpp"
+#include "FrameSnapshot.hpp"
+#include <cstdint>
+#pragma endregion
+
+namespace Engine
+{
+	// A point or spot light as laid out in the LightData block, std140 so every member is a vec4
+	struct GpuLight
+	{
+		vec4 colour = vec4(0.0f);		// Alpha unused
+		vec4 position = vec4(0.0f);		// W is the linear attenuation
+		vec4 direction = vec4(0.0f);	// W is the quadratic attenuation
+		vec4 cone = vec4(0.0f);			// Cosine of the cutoff then sine of the blur, only for spotlights
+	};
+
+	// The start of the LightData block, followed by the point then spot light arrays
+	struct GpuLightHeader
+	{
+		vec4 directionalColour = vec4(0.0f);	// Alpha is the ambient strength
+		vec4 directionalDirection = vec4(0.0f);
+		uint32_t pointCount = 0U, spotCount = 0U;	// Only this many of each array are shaded
+		uint32_t padding[2] = { 0U, 0U };
+	};
+
+	static_assert(sizeof(GpuLight) == 64U && sizeof(GpuLightHeader) == 48U,
+		"The light structs no longer match the std140 LightData block");
+
+	// Keeps every light packed in one uniform buffer, a cpu copy of it finds which bytes changed so only those are
+	// uploaded. Lights are owned elsewhere, the registry reads them and clears their dirty flags
+	class LightRegistry
+	{
+	public:
+		// Must match the shaders, together they keep the block under the 16KB every driver allows
+		static const unsigned int s_maxPointLights = 192U;
+		static const unsigned int s_maxSpotLights = 32U;
+		static const unsigned int s_binding = 1U;		// The uniform buffer binding point of the LightData block
+
+		LightRegistry();
+
+		#pragma region Delete copy/move
+		LightRegistry(const LightRegistry&) = delete;
+		LightRegistry& operator=(const LightRegistry&) = delete;
+		LightRegistry(LightRegistry&&) = delete;
+		LightRegistry& operator=(LightRegistry&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Creates the uniform buffer and binds it to its binding point, needs the context
+		 */
+		void Init();
+		/**
+		 * @brief Deletes the uniform buffer but only if it was ever created
+		 *
+		 * @param pValidate Whether the context is still alive
+		 */
+		void Destroy(bool pValidate);
+		/**
+		 * @brief Starts shading with a light, there is only ever one directional light so it replaces the last
+		 *
+		 * @param pLight The light, must outlive the registry or be removed first
+		 * @return False if there is no room left for its type
+		 */
+		bool Add(Light* pLight);
+		/**
+		 * @brief Stops shading with a light, the last light of its type moves into its slot
+		 *
+		 * @param pLight The light
+		 */
+		void Remove(Light* pLight);
+		/**
+		 * @brief Packs every changed light and copies out the bytes that differ from what was last synced,
+		 * then clears the lights' dirty flags. Makes no gl calls
+		 *
+		 * @param pUpload Filled with the changed range, left empty when nothing changed
+		 */
+		void Sync(LightUpload& pUpload);
+		/**
+		 * @brief Writes a range copied out by Sync to the uniform buffer, must be called on the thread that owns
+		 * the context and in the order they were synced
+		 *
+		 * @param pUpload The range to write
+		 */
+		void Upload(const LightUpload& pUpload);
+
+		/**
+		 * @brief Whether a light has changed or been added or removed since the last sync
+		 */
+		bool GetDirty() const;
+		unsigned int GetPointCount() const { return (unsigned int)m_pointLights.size(); }
+		unsigned int GetSpotCount() const { return (unsigned int)m_spotLights.size(); }
+		const vector<Light*>& GetPointLights() const { return m_pointLights; }
+		const vector<Light*>& GetSpotLights() const { return m_spotLights; }
+
+	private:
+		static const size_t s_pointOffset = sizeof(GpuLightHeader);
+		static const size_t s_spotOffset = s_pointOffset + s_maxPointLights * sizeof(GpuLight);
+		static const size_t s_size = s_spotOffset + s_maxSpotLights * sizeof(GpuLight);
+
+		/**
+		 * @brief Writes bytes to the cpu copy, growing the dirty range only if they differ
+		 *
+		 * @param pOffset Where in the buffer
+		 * @param pData The bytes to write
+		 * @param pSize How many bytes
+		 */
+		void Write(size_t pOffset, const void* pData, size_t pSize);
+		void PackHeader();
+		void PackLight(const Light* pLight, size_t pOffset);
+
+		Light* m_directional = nullptr;
+		vector<Light*> m_pointLights, m_spotLights;
+		bool m_countsChanged = true;			// The header and any moved lights need packing
+		vector<unsigned char> m_data;			// Mirrors the whole uniform buffer
+		size_t m_dirtyBegin = 0U, m_dirtyEnd = 0U;
+		unsigned int m_ubo = 0U;
+	};
+}
@@ -1,6 +1,11 @@
 #include "Mesh.hpp"
+#include "GLState.hpp"
 #include "glad/glad.h" // Include glad to get all the required OpenGL headers
 #include <assert.h>
+#include <map>
+#include <array>
+#include <algorithm>
+#include <cmath>
 
 namespace Engine
 {
@@ -91,6 +96,8 @@ namespace Engine
 		m_vertices = make_unique<vector<Vertex>>(*pOther.GetVertices());
 		m_indices = make_unique<vector<unsigned int>>(*pOther.GetIndices());
 		m_textures = make_unique<vector<Texture>>(*pOther.GetTextures());
+		m_bounds = pOther.m_bounds;
+		m_sphere = pOther.m_sphere;
 	}
 
 	Mesh::Mesh(Mesh&& pOther) noexcept
@@ -98,6 +105,8 @@ namespace Engine
 		m_vertices = make_unique<vector<Vertex>>(*pOther.GetVertices());
 		m_indices = make_unique<vector<unsigned int>>(*pOther.GetIndices());
 		m_textures = make_unique<vector<Texture>>(*pOther.GetTextures());
+		m_bounds = pOther.m_bounds;
+		m_sphere = pOther.m_sphere;
 	}
 
 	Mesh& Mesh::operator=(const Mesh& pOther)
@@ -120,6 +129,11 @@ namespace Engine
 			glDeleteVertexArrays(1, m_idVAO);
 			glDeleteBuffers(1, m_idVBO);
 			glDeleteBuffers(1, m_idEBO);
+			glDeleteVertexArrays(1, &m_idDepthVAO);
+			glDeleteBuffers(1, &m_idPositionVBO);
+			glDeleteBuffers(1, &m_idDepthEBO);
+			// The ids can be handed out again so the cache must not think they are still bound
+			GLState::Invalidate();
 		}
 
 		GetVertices()->clear();
@@ -142,7 +156,6 @@ namespace Engine
 		unsigned int specularNr = 0;
 		for (unsigned int i = 0; i < GetTextures()->size(); ++i)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // Activate proper texture unit before binding
 			// Retrieve texture number (the N in diffuse_textureN)
 			string number;
 			string name = GetTextures()->at(i).GetType();
@@ -152,19 +165,70 @@ namespace Engine
 				number = std::to_string(specularNr++);
 
 			pShader.SetInt(("u_material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, GetTextures()->at(i).GetId());
+			// Only activates the unit if the texture bound to it changes
+			GLState::BindTexture(i, GL_TEXTURE_2D, GetTextures()->at(i).GetId());
 		}
-		glActiveTexture(GL_TEXTURE0);
 	}
 
 	void Mesh::Draw(Shader* pShader)
 	{
-		// Draw mesh
-		glBindVertexArray(*m_idVAO);
+		// Draw mesh, the vertex array is left bound so consecutive draws of this mesh skip the bind
+		GLState::BindVertexArray(*m_idVAO);
 		// This causes an error ↓
 		GLsizei count = GetIndices()->size();
 		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+	}
+
+	void Mesh::DrawInstanced(unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount)
+	{
+		DrawInstancedFrom(*m_idVAO, (unsigned int)GetIndices()->size(), m_instances, pInstanceBuffer, pFirst, pCount);
+	}
+
+	void Mesh::DrawInstanced(unsigned int pCount)
+	{
+		if (pCount == 0U)
+			return;
+
+		GLState::BindVertexArray(*m_idVAO);
+		GLsizei count = GetIndices()->size();
+		glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0, pCount);
+	}
+
+	void Mesh::DrawDepth()
+	{
+		GLState::BindVertexArray(m_idDepthVAO);
+		glDrawElements(GL_TRIANGLES, m_depthIndexCount, GL_UNSIGNED_INT, 0);
+	}
+
+	void Mesh::DrawDepthInstanced(unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount)
+	{
+		DrawInstancedFrom(m_idDepthVAO, m_depthIndexCount, m_depthInstances, pInstanceBuffer, pFirst, pCount);
+	}
+
+	void Mesh::DrawInstancedFrom(unsigned int pVAO, unsigned int pIndexCount, InstanceSource& pSource,
+		unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount)
+	{
+		if (pCount == 0U)
+			return;
+
+		GLState::BindVertexArray(pVAO);
+		if (pInstanceBuffer != pSource.buffer || pFirst != pSource.first)
+		{
+			// Gl 3.3 has no base instance so the offset of the first matrix goes in the attribute pointers instead
+			GLState::BindBuffer(GL_ARRAY_BUFFER, pInstanceBuffer);
+			size_t offset = (size_t)pFirst * sizeof(glm::mat4);
+			for (unsigned int i = 0; i < 4; ++i)
+			{
+				glEnableVertexAttribArray(s_instanceLocation + i);
+				glVertexAttribPointer(s_instanceLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + i * sizeof(glm::vec4)));
+				// Advance once per copy instead of once per vertex
+				glVertexAttribDivisor(s_instanceLocation + i, 1);
+			}
+			pSource.buffer = pInstanceBuffer;
+			pSource.first = pFirst;
+		}
+
+		glDrawElementsInstanced(GL_TRIANGLES, pIndexCount, GL_UNSIGNED_INT, 0, pCount);
 	}
 
 	// Static
@@ -216,10 +280,10 @@ namespace Engine
 		glGenBuffers(1, m_idEBO);
 
 		// Binds the vertex array so that the VBO and EBO are neatly stored within
-		glBindVertexArray(*m_idVAO);
+		GLState::BindVertexArray(*m_idVAO);
 
 		// GL_ARRAY_BUFFER effectively works like a pointer, using the id provided to point to the buffer
-		glBindBuffer(GL_ARRAY_BUFFER, *m_idVBO);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, *m_idVBO);
 		// Loads the vertices to the VBO
 		glBufferData(GL_ARRAY_BUFFER, GetVertices()->size() * sizeof(Vertex), &(*GetVertices())[0], GL_STATIC_DRAW);
 
@@ -229,7 +293,7 @@ namespace Engine
 		*/
 
 		// This buffer stores the indices that reference the elements of the VBO
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *m_idEBO);
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, *m_idEBO);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, GetIndices()->size() * sizeof(unsigned int), &(*GetIndices())[0], GL_STATIC_DRAW);
 
 		/*Tells the shader how to use the vertex data provided
@@ -250,12 +314,67 @@ namespace Engine
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
 
-		// Unbinds the vertex array
-		glBindVertexArray(0);
-		// Unbinds the GL_ARRAY_BUFFER
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		// Unbinds the GL_ELEMENT_ARRAY_BUFFER
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		// Unbinds the vertex array, the GL_ELEMENT_ARRAY_BUFFER stays with it and the GL_ARRAY_BUFFER is
+		// left bound as nothing reads it until the next one is bound over it
+		GLState::BindVertexArray(0);
+
+		SetupDepth();
+		SetupBounds();
+	}
+
+	void Mesh::SetupBounds()
+	{
+		m_bounds = AABB();
+		for (const Vertex& vertex : *GetVertices())
+			m_bounds.Grow(vertex.position);
+		if (m_bounds.IsEmpty())
+			return;
+
+		// Tighter than the box's corners, the furthest vertex from its centre
+		m_sphere.centre = m_bounds.GetCentre();
+		float radiusSq = 0.0f;
+		for (const Vertex& vertex : *GetVertices())
+		{
+			vec3 offset = vertex.position - m_sphere.centre;
+			radiusSq = std::max(radiusSq, glm::dot(offset, offset));
+		}
+		m_sphere.radius = std::sqrt(radiusSq);
+	}
+
+	void Mesh::SetupDepth()
+	{
+		// Vertices split by their normals or texture coordinates share a position, so depth needs fewer
+		std::map<std::array<float, 3>, unsigned int> unique;
+		vector<vec3> positions;
+		vector<unsigned int> indices;
+		indices.reserve(GetIndices()->size());
+		for (unsigned int index : *GetIndices())
+		{
+			const vec3& position = (*GetVertices())[index].position;
+			auto found = unique.emplace(std::array<float, 3>{ position.x, position.y, position.z }, (unsigned int)positions.size());
+			if (found.second)
+				positions.push_back(position);
+			indices.push_back(found.first->second);
+		}
+		m_depthIndexCount = (unsigned int)indices.size();
+		if (indices.empty())
+			return;
+
+		glGenVertexArrays(1, &m_idDepthVAO);
+		glGenBuffers(1, &m_idPositionVBO);
+		glGenBuffers(1, &m_idDepthEBO);
+		GLState::BindVertexArray(m_idDepthVAO);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_idPositionVBO);
+		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(vec3), positions.data(), GL_STATIC_DRAW);
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_idDepthEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+		// Position attribute, at the same location as the full vertex array so shaders work with either
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
+
+		GLState::BindVertexArray(0);
 	}
 
 	#pragma region Setters
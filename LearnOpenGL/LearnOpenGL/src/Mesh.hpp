@@ -3,6 +3,7 @@
 #include "glm/glm.hpp"
 #include "Material.hpp"
 #include "Shader.hpp"
+#include "Bounds.hpp"
 
 using glm::vec2;
 using glm::vec3;
@@ -34,6 +35,33 @@ namespace Engine
 
 		void LoadTextures(Shader& pShader);
 		void Draw(Shader* pShader);
+		/**
+		 * @brief Draws many copies of the mesh with a single call, each with its own model matrix
+		 *
+		 * @param pInstanceBuffer The buffer holding one mat4 per copy
+		 * @param pFirst The index of the first matrix in the buffer to use
+		 * @param pCount The amount of copies to draw
+		 */
+		void DrawInstanced(unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount);
+		/**
+		 * @brief Draws copies of the mesh with a single call and no per copy attributes, the shader
+		 * tells them apart with gl_InstanceID
+		 *
+		 * @param pCount The amount of copies to draw
+		 */
+		void DrawInstanced(unsigned int pCount);
+		/**
+		 * @brief Draws only the positions, from their own tightly packed buffer, for depth only passes
+		 */
+		void DrawDepth();
+		/**
+		 * @brief Draws copies of the positions only with a single call, each with its own model matrix
+		 *
+		 * @param pInstanceBuffer The buffer holding one mat4 per copy
+		 * @param pFirst The index of the first matrix in the buffer to use
+		 * @param pCount The amount of copies to draw
+		 */
+		void DrawDepthInstanced(unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount);
 
 		static vector<Vertex> GenerateVertices();
 		static vector<unsigned int> GenerateIndices();
@@ -50,13 +78,49 @@ namespace Engine
 		unsigned int* GetVAO() const;
 		unsigned int* GetVBO() const;
 		unsigned int* GetEBO() const;
+		/**
+		 * @brief The box around the vertices, in model space
+		 */
+		const AABB& GetBounds() const { return m_bounds; }
+		/**
+		 * @brief The sphere around the vertices, in model space
+		 */
+		const BoundingSphere& GetSphere() const { return m_sphere; }
 		#pragma endregion
 		
 	private:
 		static float* s_cubeVerticesArr;
 		static unsigned int* s_indicesArr;
+		static const unsigned int s_instanceLocation = 3U;	// A mat4 attribute takes this and the next 3 locations
+
+		// Where a vertex array's instance attributes currently point, they only need pointing again when this moves
+		struct InstanceSource
+		{
+			unsigned int buffer = 0U;
+			unsigned int first = 0U;
+		};
 
 		void SetupMesh();
+		/**
+		 * @brief Builds the position only vertex array, each position is stored once and the indices remapped
+		 */
+		void SetupDepth();
+		/**
+		 * @brief Fits the box and sphere around the vertices, done once as the mesh never changes
+		 */
+		void SetupBounds();
+		/**
+		 * @brief Draws copies from a vertex array, pointing its instance attributes at the matrices first if needed
+		 *
+		 * @param pVAO The vertex array to draw
+		 * @param pIndexCount The amount of indices in its element buffer
+		 * @param pSource Where the vertex array's instance attributes point
+		 * @param pInstanceBuffer The buffer holding one mat4 per copy
+		 * @param pFirst The index of the first matrix in the buffer to use
+		 * @param pCount The amount of copies to draw
+		 */
+		void DrawInstancedFrom(unsigned int pVAO, unsigned int pIndexCount, InstanceSource& pSource,
+			unsigned int pInstanceBuffer, unsigned int pFirst, unsigned int pCount);
 
 		unique_ptr<vector<Vertex>> m_vertices = nullptr;
 		unique_ptr<vector<unsigned int>> m_indices = nullptr;
@@ -65,5 +129,14 @@ namespace Engine
 		unsigned int* m_idVAO = new unsigned int(0U);	// The id for the vertex attribute object
 		unsigned int* m_idVBO = new unsigned int(0U);	// The id for the vertex buffer object
 		unsigned int* m_idEBO = new unsigned int(0U);	// The id for the element buffer object
+		InstanceSource m_instances;
+
+		// Positions only, for depth passes that would waste bandwidth on the normals and texture coordinates
+		unsigned int m_idDepthVAO = 0U, m_idPositionVBO = 0U, m_idDepthEBO = 0U;
+		unsigned int m_depthIndexCount = 0U;
+		InstanceSource m_depthInstances;
+
+		AABB m_bounds;
+		BoundingSphere m_sphere;
 	};
 }
@@ -4,6 +4,7 @@
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
 #include "glm/gtc/matrix_transform.hpp"
+#include <algorithm>
 #ifdef _DEBUG
  #include <iostream>
  using std::cout;
@@ -35,11 +36,10 @@ namespace Engine
 		m_loadedTextures.release();
 	}
 
-	void Model::Draw(Shader* pShader, Camera* pCamera)
+	void Model::Draw(Shader* pShader)
 	{
+		// The camera comes from the frame uniform buffer
 		pShader->Use();
-		pShader->SetMat4("u_camera", pCamera->GetWorldToCameraMatrix());
-	 	pShader->SetVec3("u_viewPos", pCamera->GetPosition());
 		mat4 model = mat4(1.0f);
 		pShader->SetMat4("u_model", (mat4)model);
 	 	mat3 transposeInverseOfModel = mat3(glm::transpose(glm::inverse(model)));
@@ -67,6 +67,14 @@ namespace Engine
 		}
 		m_directory = pPath.substr(0, pPath.find_last_of('/'));
 		ProcessNode(scene->mRootNode, scene);
+
+		// The model's sphere reaches the far side of every mesh's sphere from the centre of the whole box
+		m_sphere.centre = m_bounds.GetCentre();
+		for (unsigned int i = 0; i < m_meshes->size(); ++i)
+		{
+			const BoundingSphere& sphere = GetMeshAt(i)->GetSphere();
+			m_sphere.radius = std::max(m_sphere.radius, glm::length(sphere.centre - m_sphere.centre) + sphere.radius);
+		}
 		#ifdef _DEBUG
 		 cout << "Done!" << endl;
 		#endif
@@ -102,6 +110,7 @@ namespace Engine
 			vector.y = pMesh->mVertices[i].y;
 			vector.z = pMesh->mVertices[i].z;
 			vertex.position = vector;
+			m_bounds.Grow(vector);
 			// Normal
 			if (pMesh->HasNormals())
 			{
@@ -10,7 +10,12 @@ struct aiNode;
 struct aiMesh;
 struct aiScene;
 struct aiMaterial;
-enum aiTextureType;
+#ifdef _MSC_VER
+ enum aiTextureType;
+#else
+ // Opaque enums without an underlying type can only be forward declared on msvc
+ #include "assimp/material.h"
+#endif
 #pragma endregion
 
 namespace Engine
@@ -21,7 +26,7 @@ namespace Engine
 		Model(char* pPath);
 		void Destroy(bool pValidate);
 
-		void Draw(Shader* pShader, Camera* pCamera);
+		void Draw(Shader* pShader);
 
 		/**
 		 * @brief Get a pointer to the mesh object at a given position
@@ -30,6 +35,7 @@ namespace Engine
 		 * @return Mesh* The pointer to the mesh object
 		 */
 		Mesh* GetMeshAt(unsigned int pPos);
+		unsigned int GetMeshCount() const { return (unsigned int)m_meshes->size(); }
 		/**
 		 * @brief Get a pointer to the texture object at a given position
 		 * 
@@ -37,6 +43,14 @@ namespace Engine
 		 * @return Text* The pointer to the texure object
 		 */
 		Texture* GetTextureAt(unsigned int pPos);
+		/**
+		 * @brief The box around every mesh, in model space
+		 */
+		const AABB& GetBounds() const { return m_bounds; }
+		/**
+		 * @brief The sphere around every mesh, in model space
+		 */
+		const BoundingSphere& GetSphere() const { return m_sphere; }
 	
 	private:
 		void LoadModel(string pPath);
@@ -47,5 +61,7 @@ namespace Engine
 		unique_ptr<vector<unique_ptr<Mesh>>> m_meshes;
 		unique_ptr<vector<Texture>> m_loadedTextures;
 		string m_directory;
+		AABB m_bounds;	// Grown as each mesh is processed
+		BoundingSphere m_sphere;
 	};
 }
@@ -0,0 +1,340 @@
+#pragma region
+#include "OcclusionCuller.hpp"
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cstdio>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define OCCLUSION_SSE
+ #include <emmintrin.h>
+#endif
+#pragma endregion
+
+namespace Engine
+{
+	static const float s_minArea = 1.0f / 64.0f;	// Triangles thinner than this in pixels are skipped
+
+	void OcclusionCuller::Begin(const mat4& pWorldToCamera)
+	{
+		m_worldToCamera = pWorldToCamera;
+		m_occluders.clear();
+	}
+
+	void OcclusionCuller::AddOccluder(const Mesh* pMesh, const mat4& pModel)
+	{
+		Occluder occluder;
+		occluder.mesh = pMesh;
+		occluder.model = pModel;
+		m_occluders.push_back(occluder);
+	}
+
+	void OcclusionCuller::Rasterise(WorkerPool& pWorkers)
+	{
+		// Both layers start empty, the whole tile as far as it goes
+		m_masks.assign(s_tilesX * s_tilesY * s_tileHeight, 0U);
+		m_tileDepth.assign(s_tilesX * s_tilesY, 1.0f);
+		m_layerDepth.assign(s_tilesX * s_tilesY, 0.0f);
+
+		// Each occluder sets up its triangles in a range of its own so the order never depends on the threads
+		unsigned int triangleCount = 0U;
+		for (Occluder& occluder : m_occluders)
+		{
+			occluder.firstTriangle = triangleCount;
+			triangleCount += (unsigned int)occluder.mesh->GetIndices()->size() / 3U;
+		}
+		m_triangles.resize(triangleCount);
+		pWorkers.ParallelFor((unsigned int)m_occluders.size(), 4U, [this](unsigned int pStart, unsigned int pEnd)
+		{
+			for (unsigned int i = pStart; i < pEnd; ++i)
+				SetupTriangles(m_occluders[i]);
+		});
+
+		// Binned to the rows of tiles they reach, in the order they were set up
+		m_binOffsets.assign(s_tilesY + 1U, 0U);
+		for (const ScreenTriangle& triangle : m_triangles)
+		{
+			for (int row = triangle.tileY0; row <= triangle.tileY1; ++row)
+				++m_binOffsets[row + 1];
+		}
+		for (unsigned int row = 0; row < s_tilesY; ++row)
+			m_binOffsets[row + 1U] += m_binOffsets[row];
+		m_binTriangles.resize(m_binOffsets[s_tilesY]);
+		vector<unsigned int> cursor(m_binOffsets.begin(), m_binOffsets.end() - 1);
+		unsigned int drawn = 0U;
+		for (unsigned int i = 0; i < triangleCount; ++i)
+		{
+			const ScreenTriangle& triangle = m_triangles[i];
+			drawn += (triangle.tileY0 <= triangle.tileY1 ? 1U : 0U);
+			for (int row = triangle.tileY0; row <= triangle.tileY1; ++row)
+				m_binTriangles[cursor[row]++] = i;
+		}
+
+		pWorkers.ParallelFor(s_tilesY, 1U, [this](unsigned int pStart, unsigned int pEnd)
+		{
+			for (unsigned int row = pStart; row < pEnd; ++row)
+				RasteriseRow(row);
+		});
+
+		++m_frames;
+		m_drawnTriangles += drawn;
+	}
+
+	void OcclusionCuller::SetupTriangles(const Occluder& pOccluder)
+	{
+		const vector<Vertex>& vertices = *pOccluder.mesh->GetVertices();
+		const vector<unsigned int>& indices = *pOccluder.mesh->GetIndices();
+		mat4 modelToCamera = m_worldToCamera * pOccluder.model;
+
+		for (unsigned int t = 0; t < (unsigned int)indices.size() / 3U; ++t)
+		{
+			ScreenTriangle& out = m_triangles[pOccluder.firstTriangle + t];
+			out.tileY0 = 0;
+			out.tileY1 = -1;
+
+			vec3 screen[3];
+			bool clipped = false;
+			for (unsigned int v = 0; v < 3U; ++v)
+			{
+				vec4 clip = modelToCamera * vec4(vertices[indices[t * 3U + v]].position, 1.0f);
+				// Crossing the near plane would need clipping, occluders are only ever conservative so it is skipped
+				if (clip.w <= 0.0f || clip.z < -clip.w)
+				{
+					clipped = true;
+					break;
+				}
+				vec3 ndc = vec3(clip) / clip.w;
+				screen[v] = vec3((ndc.x * 0.5f + 0.5f) * (float)s_width, (ndc.y * 0.5f + 0.5f) * (float)s_height, ndc.z * 0.5f + 0.5f);
+			}
+			if (clipped)
+				continue;
+
+			// Either winding is drawn, a closed occluder hides the same either way
+			float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+			if (std::abs(area) < s_minArea)
+				continue;
+
+			float minX = std::min(screen[0].x, std::min(screen[1].x, screen[2].x));
+			float maxX = std::max(screen[0].x, std::max(screen[1].x, screen[2].x));
+			float minY = std::min(screen[0].y, std::min(screen[1].y, screen[2].y));
+			float maxY = std::max(screen[0].y, std::max(screen[1].y, screen[2].y));
+			if (maxX < 0.0f || maxY < 0.0f || minX >= (float)s_width || minY >= (float)s_height)
+				continue;
+
+			// The depth plane, solved from the three vertices
+			float dz1 = screen[1].z - screen[0].z, dz2 = screen[2].z - screen[0].z;
+			out.depthX = (dz1 * (screen[2].y - screen[0].y) - dz2 * (screen[1].y - screen[0].y)) / area;
+			out.depthY = (dz2 * (screen[1].x - screen[0].x) - dz1 * (screen[2].x - screen[0].x)) / area;
+			out.depthC = screen[0].z - out.depthX * screen[0].x - out.depthY * screen[0].y;
+			out.depthMax = std::max(screen[0].z, std::max(screen[1].z, screen[2].z));
+
+			// Sorted top to bottom for the spans
+			std::sort(screen, screen + 3, [](const vec3& pA, const vec3& pB) { return pA.y < pB.y; });
+			for (unsigned int v = 0; v < 3U; ++v)
+			{
+				out.x[v] = screen[v].x;
+				out.y[v] = screen[v].y;
+			}
+
+			out.tileX0 = std::max(0, (int)minX / (int)s_tileWidth);
+			out.tileX1 = std::min((int)s_tilesX - 1, (int)maxX / (int)s_tileWidth);
+			out.tileY0 = std::max(0, (int)minY / (int)s_tileHeight);
+			out.tileY1 = std::min((int)s_tilesY - 1, (int)maxY / (int)s_tileHeight);
+		}
+	}
+
+	void OcclusionCuller::GetSpans(const ScreenTriangle& pTriangle, unsigned int pRow, int* pFirst, int* pEnd)
+	{
+		const float* x = pTriangle.x;
+		const float* y = pTriangle.y;
+		// How far x moves a pixel down each edge, flat edges are never crossed by a row so their slope is unused
+		float longSlope = (y[2] > y[0] ? (x[2] - x[0]) / (y[2] - y[0]) : 0.0f);
+		float topSlope = (y[1] > y[0] ? (x[1] - x[0]) / (y[1] - y[0]) : 0.0f);
+		float bottomSlope = (y[2] > y[1] ? (x[2] - x[1]) / (y[2] - y[1]) : 0.0f);
+		float rowY = (float)(pRow * s_tileHeight) + 0.5f;
+
+		#ifdef OCCLUSION_SSE
+		 // Two halves of 4 rows, a pixel is covered when its centre is within [left, right)
+		 for (unsigned int half = 0; half < s_tileHeight; half += 4U)
+		 {
+		 	__m128 centre = _mm_add_ps(_mm_set1_ps(rowY + (float)half), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+		 	__m128 crossed = _mm_and_ps(_mm_cmpge_ps(centre, _mm_set1_ps(y[0])), _mm_cmplt_ps(centre, _mm_set1_ps(y[2])));
+		 	__m128 longX = _mm_add_ps(_mm_set1_ps(x[0]), _mm_mul_ps(_mm_sub_ps(centre, _mm_set1_ps(y[0])), _mm_set1_ps(longSlope)));
+		 	__m128 topX = _mm_add_ps(_mm_set1_ps(x[0]), _mm_mul_ps(_mm_sub_ps(centre, _mm_set1_ps(y[0])), _mm_set1_ps(topSlope)));
+		 	__m128 bottomX = _mm_add_ps(_mm_set1_ps(x[1]), _mm_mul_ps(_mm_sub_ps(centre, _mm_set1_ps(y[1])), _mm_set1_ps(bottomSlope)));
+		 	__m128 onTop = _mm_cmplt_ps(centre, _mm_set1_ps(y[1]));
+		 	__m128 shortX = _mm_or_ps(_mm_and_ps(onTop, topX), _mm_andnot_ps(onTop, bottomX));
+
+		 	// Kept within a pixel of the screen so the conversion never overflows
+		 	__m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps((float)s_width + 1.0f), halfPixel = _mm_set1_ps(0.5f);
+		 	__m128 left = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_min_ps(longX, shortX), halfPixel), low), high);
+		 	__m128 right = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_max_ps(longX, shortX), halfPixel), low), high);
+
+		 	// Ceiling from truncation, rounded up wherever it fell short
+		 	__m128i first = _mm_cvttps_epi32(left);
+		 	first = _mm_sub_epi32(first, _mm_castps_si128(_mm_cmplt_ps(_mm_cvtepi32_ps(first), left)));
+		 	__m128i end = _mm_cvttps_epi32(right);
+		 	end = _mm_sub_epi32(end, _mm_castps_si128(_mm_cmplt_ps(_mm_cvtepi32_ps(end), right)));
+		 	// Rows the triangle misses are given an empty span
+		 	__m128i keep = _mm_castps_si128(crossed);
+		 	_mm_storeu_si128((__m128i*)(pFirst + half), _mm_and_si128(first, keep));
+		 	_mm_storeu_si128((__m128i*)(pEnd + half), _mm_and_si128(end, keep));
+		 }
+		#else
+		 for (unsigned int r = 0; r < s_tileHeight; ++r)
+		 {
+		 	float centre = rowY + (float)r;
+		 	if (centre < y[0] || centre >= y[2])
+		 	{
+		 		pFirst[r] = pEnd[r] = 0;
+		 		continue;
+		 	}
+		 	float longX = x[0] + (centre - y[0]) * longSlope;
+		 	float shortX = (centre < y[1] ? x[0] + (centre - y[0]) * topSlope : x[1] + (centre - y[1]) * bottomSlope);
+		 	float left = std::min(std::max(std::min(longX, shortX) - 0.5f, -1.0f), (float)s_width + 1.0f);
+		 	float right = std::min(std::max(std::max(longX, shortX) - 0.5f, -1.0f), (float)s_width + 1.0f);
+		 	pFirst[r] = (int)std::ceil(left);
+		 	pEnd[r] = (int)std::ceil(right);
+		 }
+		#endif
+	}
+
+	void OcclusionCuller::RasteriseRow(unsigned int pRow)
+	{
+		int first[s_tileHeight], end[s_tileHeight];
+		float y0 = (float)(pRow * s_tileHeight), y1 = y0 + (float)s_tileHeight;
+
+		for (unsigned int b = m_binOffsets[pRow]; b < m_binOffsets[pRow + 1U]; ++b)
+		{
+			const ScreenTriangle& triangle = m_triangles[m_binTriangles[b]];
+			GetSpans(triangle, pRow, first, end);
+
+			for (int tileX = triangle.tileX0; tileX <= triangle.tileX1; ++tileX)
+			{
+				unsigned int tile = pRow * s_tilesX + (unsigned int)tileX;
+				// The farthest the triangle gets within the tile, from the plane at its corners
+				float x0 = (float)(tileX * (int)s_tileWidth), x1 = x0 + (float)s_tileWidth;
+				float depth = std::min(triangle.depthMax, triangle.depthC + std::max(triangle.depthX * x0, triangle.depthX * x1)
+					+ std::max(triangle.depthY * y0, triangle.depthY * y1));
+				if (depth >= m_tileDepth[tile])
+					continue;
+
+				uint32_t coverage[s_tileHeight];
+				uint32_t any = 0U;
+				for (unsigned int r = 0; r < s_tileHeight; ++r)
+				{
+					int start = std::min(std::max(first[r] - (int)x0, 0), (int)s_tileWidth);
+					int stop = std::min(std::max(end[r] - (int)x0, 0), (int)s_tileWidth);
+					coverage[r] = (stop > start ? (uint32_t)((1ULL << stop) - (1ULL << start)) : 0U);
+					any |= coverage[r];
+				}
+				if (any == 0U)
+					continue;
+
+				// Merged into the working layer, which replaces the tile's depth once it covers every pixel
+				uint32_t* masks = m_masks.data() + tile * s_tileHeight;
+				uint32_t full = 0xFFFFFFFFU;
+				for (unsigned int r = 0; r < s_tileHeight; ++r)
+				{
+					masks[r] |= coverage[r];
+					full &= masks[r];
+				}
+				m_layerDepth[tile] = std::max(m_layerDepth[tile], depth);
+				if (full == 0xFFFFFFFFU)
+				{
+					m_tileDepth[tile] = m_layerDepth[tile];
+					m_layerDepth[tile] = 0.0f;
+					for (unsigned int r = 0; r < s_tileHeight; ++r)
+						masks[r] = 0U;
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::IsVisible(const AABB& pBox) const
+	{
+		float minX = std::numeric_limits<float>::max(), minY = minX, minZ = minX;
+		float maxX = -minX, maxY = -minX;
+		for (unsigned int c = 0; c < 8U; ++c)
+		{
+			vec3 corner((c & 1U) ? pBox.max.x : pBox.min.x, (c & 2U) ? pBox.max.y : pBox.min.y, (c & 4U) ? pBox.max.z : pBox.min.z);
+			vec4 clip = m_worldToCamera * vec4(corner, 1.0f);
+			// Reaching past the near plane, nothing can be in front of it
+			if (clip.w <= 0.0f || clip.z < -clip.w)
+				return true;
+			vec3 ndc = vec3(clip) / clip.w;
+			float x = (ndc.x * 0.5f + 0.5f) * (float)s_width, y = (ndc.y * 0.5f + 0.5f) * (float)s_height;
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			minZ = std::min(minZ, ndc.z * 0.5f + 0.5f);
+		}
+		if (maxX < 0.0f || maxY < 0.0f || minX >= (float)s_width || minY >= (float)s_height)
+			return false;
+
+		int tileX0 = std::max(0, (int)minX / (int)s_tileWidth), tileX1 = std::min((int)s_tilesX - 1, (int)maxX / (int)s_tileWidth);
+		int tileY0 = std::max(0, (int)minY / (int)s_tileHeight), tileY1 = std::min((int)s_tilesY - 1, (int)maxY / (int)s_tileHeight);
+
+		// Visible if its nearest point is no farther than any tile it covers, an occluder never hides itself
+		#ifdef OCCLUSION_SSE
+		 __m128 depth = _mm_set1_ps(minZ);
+		 __m128i lastX = _mm_set1_epi32(tileX1), firstX = _mm_set1_epi32(tileX0 - 1);
+		 for (int tileY = tileY0; tileY <= tileY1; ++tileY)
+		 {
+		 	const float* row = m_tileDepth.data() + tileY * (int)s_tilesX;
+		 	// A row of tiles is a whole number of 4 wide groups, lanes outside the box are masked off
+		 	for (int tileX = tileX0 & ~3; tileX <= tileX1; tileX += 4)
+		 	{
+		 		__m128i lane = _mm_add_epi32(_mm_set1_epi32(tileX), _mm_set_epi32(3, 2, 1, 0));
+		 		__m128i within = _mm_andnot_si128(_mm_cmpgt_epi32(lane, lastX), _mm_cmpgt_epi32(lane, firstX));
+		 		__m128 nearer = _mm_cmple_ps(depth, _mm_loadu_ps(row + tileX));
+		 		if (_mm_movemask_ps(_mm_and_ps(nearer, _mm_castsi128_ps(within))) != 0)
+		 			return true;
+		 	}
+		 }
+		#else
+		 for (int tileY = tileY0; tileY <= tileY1; ++tileY)
+		 {
+		 	for (int tileX = tileX0; tileX <= tileX1; ++tileX)
+		 	{
+		 		if (minZ <= m_tileDepth[tileY * s_tilesX + tileX])
+		 			return true;
+		 	}
+		 }
+		#endif
+		return false;
+	}
+
+	void OcclusionCuller::Test(const AABB* pBoxes, unsigned int pCount, uint8_t* pVisible, WorkerPool& pWorkers)
+	{
+		unsigned int tested = 0U;
+		for (unsigned int i = 0; i < pCount; ++i)
+			tested += pVisible[i];
+
+		pWorkers.ParallelFor(pCount, 64U, [this, pBoxes, pVisible](unsigned int pStart, unsigned int pEnd)
+		{
+			for (unsigned int i = pStart; i < pEnd; ++i)
+			{
+				if (pVisible[i] != 0U && !IsVisible(pBoxes[i]))
+					pVisible[i] = 0U;
+			}
+		});
+
+		unsigned int visible = 0U;
+		for (unsigned int i = 0; i < pCount; ++i)
+			visible += pVisible[i];
+		m_tested += tested;
+		m_occluded += tested - visible;
+	}
+
+	void OcclusionCuller::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_frames == 0ULL)
+		 	return;
+
+		 printf("Occlusion culling (%ux%u) over %llu frames: %.1f occluder triangles a frame, %.1f boxes tested, %.1f occluded (%.1f%%)\n",
+		 	s_width, s_height, m_frames, (double)m_drawnTriangles / m_frames, (double)m_tested / m_frames,
+		 	(double)m_occluded / m_frames, (m_tested > 0ULL ? 100.0 * (double)m_occluded / (double)m_tested : 0.0));
+		#endif
+	}
+}
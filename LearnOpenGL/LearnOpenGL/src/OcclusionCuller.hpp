@@ -0,0 +1,131 @@
+#pragma region
+#pragma once
+#include "Bounds.hpp"
+#include "WorkerPool.hpp"
+#include <vector>
+#include <cstdint>
+
+using std::vector;
+#pragma endregion
+
+namespace Engine
+{
+	class Mesh;
+
+	// A masked software depth buffer at a low resolution, drawn from designated occluder meshes on the cpu so boxes
+	// behind them can be culled before anything reaches gl. The screen is split into tiles of 32 by 8 pixels, each
+	// keeping a coverage bit per pixel and two depths instead of a depth per pixel: the farthest depth of the whole
+	// tile, and the farthest depth of the triangles covering the pixels whose bits are set. Once every bit is set
+	// the second layer becomes the first. Triangles are set up in parallel per occluder then binned to rows of
+	// tiles, which are drawn in parallel as no two rows share a tile
+	class OcclusionCuller
+	{
+	public:
+		static const unsigned int s_tileWidth = 32U, s_tileHeight = 8U;	// A bit per pixel of a row fills a uint32
+		static const unsigned int s_tilesX = 12U, s_tilesY = 27U;
+		static const unsigned int s_width = s_tileWidth * s_tilesX, s_height = s_tileHeight * s_tilesY;
+
+		OcclusionCuller() = default;
+
+		#pragma region Delete copy/move
+		OcclusionCuller(const OcclusionCuller&) = delete;
+		OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+		OcclusionCuller(OcclusionCuller&&) = delete;
+		OcclusionCuller& operator=(OcclusionCuller&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Forgets the last frame's occluders and sets the camera the next are drawn from
+		 *
+		 * @param pWorldToCamera The view projection matrix
+		 */
+		void Begin(const mat4& pWorldToCamera);
+		/**
+		 * @brief Queues a mesh to be drawn into the depth buffer, it must be solid as everything behind it is hidden
+		 *
+		 * @param pMesh The mesh, its vertices and indices are read
+		 * @param pModel Its model matrix
+		 */
+		void AddOccluder(const Mesh* pMesh, const mat4& pModel);
+		/**
+		 * @brief Clears the depth buffer and draws every occluder queued since Begin
+		 *
+		 * @param pWorkers The threads the occluders then the rows of tiles are split between
+		 */
+		void Rasterise(WorkerPool& pWorkers);
+		/**
+		 * @brief Whether any of a box could be in front of the occluders
+		 *
+		 * @param pBox The box in world space
+		 * @return False only if every tile it covers is nearer than its nearest point
+		 */
+		bool IsVisible(const AABB& pBox) const;
+		/**
+		 * @brief Tests many boxes, clearing the flag of those found hidden and adding to the counters
+		 *
+		 * @param pBoxes The boxes in world space
+		 * @param pCount The amount of boxes
+		 * @param pVisible A flag for each box, only boxes already flagged are tested
+		 * @param pWorkers The threads the boxes are split between
+		 */
+		void Test(const AABB* pBoxes, unsigned int pCount, uint8_t* pVisible, WorkerPool& pWorkers);
+		/**
+		 * @brief Prints how many triangles were drawn and how many boxes were hidden
+		 */
+		void PrintReport() const;
+
+	private:
+		struct Occluder
+		{
+			const Mesh* mesh = nullptr;
+			mat4 model = mat4(1.0f);
+			unsigned int firstTriangle = 0U;	// Where its triangles are set up, in the order they were added
+		};
+
+		// A triangle in pixels with its vertices sorted top to bottom, and the plane its depth lies on
+		struct ScreenTriangle
+		{
+			float x[3], y[3];
+			float depthX, depthY, depthC;	// Depth is depthX * x + depthY * y + depthC
+			float depthMax;					// The farthest vertex
+			int tileX0, tileX1, tileY0, tileY1;	// The tiles its bounds cover, tileY0 > tileY1 when it isn't drawn
+		};
+
+		/**
+		 * @brief Projects an occluder's triangles, skipping those crossing the near plane or too thin to cover anything
+		 *
+		 * @param pOccluder The occluder
+		 */
+		void SetupTriangles(const Occluder& pOccluder);
+		/**
+		 * @brief Draws every triangle reaching a row of tiles into its tiles
+		 *
+		 * @param pRow The row of tiles
+		 */
+		void RasteriseRow(unsigned int pRow);
+		/**
+		 * @brief Finds the first and one past the last pixel each row of a tile row covers, by where each row's
+		 * centre crosses the triangle's edges
+		 *
+		 * @param pTriangle The triangle
+		 * @param pRow The row of tiles
+		 * @param pFirst Filled with the first pixel of each of the 8 rows
+		 * @param pEnd Filled with one past the last pixel of each row, no more than pFirst when it covers none
+		 */
+		static void GetSpans(const ScreenTriangle& pTriangle, unsigned int pRow, int* pFirst, int* pEnd);
+
+		mat4 m_worldToCamera = mat4(1.0f);
+		vector<Occluder> m_occluders;
+		vector<ScreenTriangle> m_triangles;
+		vector<unsigned int> m_binOffsets;		// Where each row of tiles' triangles start in m_binTriangles
+		vector<unsigned int> m_binTriangles;	// The triangles reaching each row, a row after another
+
+		vector<uint32_t> m_masks;		// s_tileHeight rows of bits for every tile
+		vector<float> m_tileDepth;		// The farthest depth anywhere in each tile
+		vector<float> m_layerDepth;		// The farthest depth of the pixels each tile's mask covers
+
+		// Totals for the report
+		unsigned long long m_frames = 0ULL, m_drawnTriangles = 0ULL;
+		unsigned long long m_tested = 0ULL, m_occluded = 0ULL;
+	};
+}
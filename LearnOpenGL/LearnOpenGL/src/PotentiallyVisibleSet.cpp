@@ -0,0 +1,371 @@
+#pragma region
+#include "PotentiallyVisibleSet.hpp"
+#include "BoundsTree.hpp"
+#include "Mesh.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+using std::ofstream;
+using std::ifstream;
+using std::ios;
+#pragma endregion
+
+namespace Engine
+{
+	// File layout, all little endian:
+	// uint32 magic, uint32 version, uint32 scene key, uint32 object count, uint32 cells x, y, z,
+	// float32 origin x, y, z, float32 cell size, then a uint32 per 32 objects for every cell
+
+	static const uint32_t s_magic = 0x31535650U;	// "PVS1"
+	static const uint32_t s_version = 1U;
+	static const float s_miss = std::numeric_limits<float>::max();
+
+	/**
+	 * @brief How far along a ray it hits the front of a triangle, or s_miss. Back faces let the ray through so
+	 * rays cast from inside an object still leave it
+	 */
+	static float IntersectFront(const vec3& pOrigin, const vec3& pDirection, const vec3* pCorners)
+	{
+		vec3 edge1 = pCorners[1] - pCorners[0];
+		vec3 edge2 = pCorners[2] - pCorners[0];
+		vec3 p = glm::cross(pDirection, edge2);
+		// Positive when the ray sees the corners counter-clockwise, the same front face gl culls by
+		float determinant = glm::dot(edge1, p);
+		if (determinant <= 1e-12f)
+			return s_miss;
+
+		float inverse = 1.0f / determinant;
+		vec3 offset = pOrigin - pCorners[0];
+		float u = glm::dot(offset, p) * inverse;
+		if (u < 0.0f || u > 1.0f)
+			return s_miss;
+		vec3 q = glm::cross(offset, edge1);
+		float v = glm::dot(pDirection, q) * inverse;
+		if (v < 0.0f || u + v > 1.0f)
+			return s_miss;
+		float distance = glm::dot(edge2, q) * inverse;
+		return (distance >= 0.0f ? distance : s_miss);
+	}
+
+	bool PotentiallyVisibleSet::Bake(const vector<Object>& pObjects, float pCellSize, float pMargin, WorkerPool& pWorkers)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Clear();
+		m_key = GetSceneKey(pObjects);
+		m_objectCount = (uint32_t)pObjects.size();
+		m_words = (m_objectCount + 31U) / 32U;
+
+		// Every triangle in world space, the corners of each object's after those of the one before
+		vector<vec3> corners;
+		vector<unsigned int> firstCorner(pObjects.size() + 1U, 0U);
+		BoundsTree tree;
+		AABB scene;
+		for (unsigned int i = 0; i < pObjects.size(); ++i)
+		{
+			const Object& object = pObjects[i];
+			firstCorner[i] = (unsigned int)corners.size();
+			if (object.bounds.IsEmpty())
+				continue;
+			scene.Grow(object.bounds);
+			tree.Insert(object.bounds, i);
+			if (object.mesh == nullptr)
+				continue;
+
+			// A mirroring transform turns the winding around, swapping two corners turns it back
+			const vector<Vertex>& vertices = *object.mesh->GetVertices();
+			const vector<unsigned int>& indices = *object.mesh->GetIndices();
+			bool mirrored = glm::determinant(glm::mat3(object.model)) < 0.0f;
+			for (size_t t = 0; t + 2U < indices.size(); t += 3U)
+			{
+				corners.push_back(vec3(object.model * vec4(vertices[indices[t]].position, 1.0f)));
+				corners.push_back(vec3(object.model * vec4(vertices[indices[t + (mirrored ? 2U : 1U)]].position, 1.0f)));
+				corners.push_back(vec3(object.model * vec4(vertices[indices[t + (mirrored ? 1U : 2U)]].position, 1.0f)));
+			}
+		}
+		firstCorner.back() = (unsigned int)corners.size();
+		m_baked = true;
+		if (scene.IsEmpty())
+			return true;
+
+		// Each sample casts up to a ray at the centre and corners of every object
+		const unsigned int samples = s_samplesPerAxis * s_samplesPerAxis * s_samplesPerAxis;
+		unsigned long long raysPerCell = (unsigned long long)samples * 9U * m_objectCount;
+		if (raysPerCell > s_maxRays)
+		{
+			#ifdef _DEBUG
+			 printf("Too many objects (%u) to bake potentially visible sets\n", m_objectCount);
+			#endif
+			Clear();
+			return false;
+		}
+
+		// The cells grow until the rays fit the budget
+		scene.min -= vec3(pMargin);
+		scene.max += vec3(pMargin);
+		vec3 size = scene.max - scene.min;
+		m_cellSize = std::max(pCellSize, std::max(std::max(size.x, size.y), size.z) / (float)s_maxCellsPerAxis);
+		for (;; m_cellSize *= 1.25f)
+		{
+			m_cellsX = std::max((uint32_t)std::ceil(size.x / m_cellSize), 1U);
+			m_cellsY = std::max((uint32_t)std::ceil(size.y / m_cellSize), 1U);
+			m_cellsZ = std::max((uint32_t)std::ceil(size.z / m_cellSize), 1U);
+			if ((unsigned long long)m_cellsX * m_cellsY * m_cellsZ * raysPerCell <= s_maxRays)
+				break;
+		}
+		m_origin = scene.min;
+		unsigned int cellCount = m_cellsX * m_cellsY * m_cellsZ;
+		m_bits.assign((size_t)cellCount * m_words, 0U);
+
+		// How many rays reach a triangle depends on what is in the way, so that is counted as the cells are baked
+		std::atomic<unsigned long long> tested(0ULL);
+		pWorkers.ParallelFor(cellCount, 1U, [&](unsigned int pStart, unsigned int pEnd)
+		{
+			// Every leaf a ray enters and where, only those entered before it stops are seen
+			vector<std::pair<unsigned int, float>> entered;
+			vec3 origin, direction;
+			float length = 0.0f;
+			unsigned long long objectTested = 0ULL;
+			function<float(unsigned int, float)> visit = [&](unsigned int pObject, float pEntry)
+			{
+				entered.push_back({ pObject, pEntry });
+				objectTested += (firstCorner[pObject + 1U] - firstCorner[pObject]) / 3U;
+				for (unsigned int c = firstCorner[pObject]; c < firstCorner[pObject + 1U]; c += 3U)
+					length = std::min(length, IntersectFront(origin, direction, &corners[c]));
+				return length;
+			};
+
+			for (unsigned int cell = pStart; cell < pEnd; ++cell)
+			{
+				uint32_t* bits = &m_bits[(size_t)cell * m_words];
+				vec3 corner = m_origin + vec3(cell % m_cellsX, (cell / m_cellsX) % m_cellsY, cell / (m_cellsX * m_cellsY)) * m_cellSize;
+				float step = m_cellSize / (float)(s_samplesPerAxis - 1U);
+				for (unsigned int i = 0; i < pObjects.size(); ++i)
+				{
+					const AABB& bounds = pObjects[i].bounds;
+					// Seen already by a ray cast at something else
+					if (bounds.IsEmpty() || (bits[i >> 5] & (1U << (i & 31U))) != 0U)
+						continue;
+					// Past the budget the rest is left, the bake is thrown away
+					if (tested.load(std::memory_order_relaxed) > s_maxTriangleTests)
+						return;
+
+					// Until one reaches it, from each sample to its centre then its corners. A ray that stops at its
+					// target can only see what is in between
+					for (unsigned int r = 0; r < samples * 9U && (bits[i >> 5] & (1U << (i & 31U))) == 0U; ++r)
+					{
+						unsigned int s = r % samples, target = r / samples;
+						origin = corner + vec3(s % s_samplesPerAxis, (s / s_samplesPerAxis) % s_samplesPerAxis,
+							s / (s_samplesPerAxis * s_samplesPerAxis)) * step;
+						vec3 point = (target == 0U ? bounds.GetCentre() : vec3((target & 1U) != 0U ? bounds.max.x : bounds.min.x,
+							(target & 2U) != 0U ? bounds.max.y : bounds.min.y, (target & 4U) != 0U ? bounds.max.z : bounds.min.z));
+						// Not normalised, so the target is a distance of 1 away
+						direction = point - origin;
+						length = 1.0f;
+						entered.clear();
+						tree.QueryRay(origin, direction, length, visit);
+						for (const std::pair<unsigned int, float>& entry : entered)
+						{
+							if (entry.second <= length)
+								bits[entry.first >> 5] |= 1U << (entry.first & 31U);
+						}
+					}
+					tested.fetch_add(objectTested, std::memory_order_relaxed);
+					objectTested = 0ULL;
+				}
+			}
+		});
+		if (tested.load() > s_maxTriangleTests)
+		{
+			#ifdef _DEBUG
+			 printf("Baking potentially visible sets for %u objects tested more than %llu triangles, gave up\n",
+			 	m_objectCount, s_maxTriangleTests);
+			#endif
+			Clear();
+			return false;
+		}
+		CountVisible();
+
+		#ifdef _DEBUG
+		 printf("Baked potentially visible sets for %u objects over %ux%ux%u cells in %.2fs, %.1f visible from each\n",
+		 	m_objectCount, m_cellsX, m_cellsY, m_cellsZ,
+		 	std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), m_averageVisible);
+		#else
+		 (void)start;
+		#endif
+		return true;
+	}
+
+	bool PotentiallyVisibleSet::Save(const string& pPath) const
+	{
+		ofstream outStream(pPath, ios::binary);
+		if (!outStream.is_open())
+		{
+			#ifdef _DEBUG
+			 printf("Failed to write potentially visible sets to \"%s\"\n", pPath.c_str());
+			#endif
+			return false;
+		}
+
+		uint32_t header[7] = { s_magic, s_version, m_key, m_objectCount, m_cellsX, m_cellsY, m_cellsZ };
+		float grid[4] = { m_origin.x, m_origin.y, m_origin.z, m_cellSize };
+		outStream.write((const char*)header, sizeof(header));
+		outStream.write((const char*)grid, sizeof(grid));
+		outStream.write((const char*)m_bits.data(), m_bits.size() * sizeof(uint32_t));
+		return (bool)outStream;
+	}
+
+	bool PotentiallyVisibleSet::Load(const string& pPath, const vector<Object>& pObjects)
+	{
+		Clear();
+		ifstream inStream(pPath, ios::binary | ios::ate);
+		if (!inStream.is_open())
+			return false;
+		// Opened at the end to find the size, which bounds how many cells the header can claim
+		unsigned long long fileSize = (unsigned long long)inStream.tellg();
+		inStream.seekg(0);
+
+		uint32_t header[7] = {};
+		float grid[4] = {};
+		inStream.read((char*)header, sizeof(header));
+		inStream.read((char*)grid, sizeof(grid));
+		// Baked for something else, or an older layout
+		if (!inStream || header[0] != s_magic || header[1] != s_version || header[2] != GetSceneKey(pObjects)
+			|| header[3] != (uint32_t)pObjects.size())
+		{
+			#ifdef _DEBUG
+			 printf("\"%s\" was not baked for this scene\n", pPath.c_str());
+			#endif
+			return false;
+		}
+
+		uint32_t words = (header[3] + 31U) / 32U;
+		unsigned long long cellCount = (unsigned long long)header[4] * header[5] * header[6];
+		if (header[4] > s_maxCellsPerAxis || header[5] > s_maxCellsPerAxis || header[6] > s_maxCellsPerAxis
+			|| cellCount * words * sizeof(uint32_t) > fileSize - sizeof(header) - sizeof(grid))
+		{
+			#ifdef _DEBUG
+			 printf("Potentially visible sets \"%s\" are truncated\n", pPath.c_str());
+			#endif
+			return false;
+		}
+
+		m_key = header[2];
+		m_objectCount = header[3];
+		m_words = words;
+		m_cellsX = header[4];
+		m_cellsY = header[5];
+		m_cellsZ = header[6];
+		m_origin = vec3(grid[0], grid[1], grid[2]);
+		m_cellSize = grid[3];
+		m_bits.resize((size_t)cellCount * m_words);
+		inStream.read((char*)m_bits.data(), m_bits.size() * sizeof(uint32_t));
+		if (!inStream)
+		{
+			#ifdef _DEBUG
+			 printf("Potentially visible sets \"%s\" are truncated\n", pPath.c_str());
+			#endif
+			Clear();
+			return false;
+		}
+
+		CountVisible();
+		#ifdef _DEBUG
+		 printf("Loaded potentially visible sets for %u objects over %ux%ux%u cells from \"%s\"\n",
+		 	m_objectCount, m_cellsX, m_cellsY, m_cellsZ, pPath.c_str());
+		#endif
+		m_baked = true;
+		return true;
+	}
+
+	void PotentiallyVisibleSet::Clear()
+	{
+		m_baked = false;
+		m_key = 0U;
+		m_objectCount = 0U;
+		m_words = 0U;
+		m_cellsX = m_cellsY = m_cellsZ = 0U;
+		m_bits.clear();
+		m_averageVisible = 0.0;
+	}
+
+	unsigned int PotentiallyVisibleSet::FindCell(const vec3& pPosition) const
+	{
+		if (m_bits.empty())
+			return s_noCell;
+
+		vec3 cell = glm::floor((pPosition - m_origin) / m_cellSize);
+		if (cell.x < 0.0f || cell.y < 0.0f || cell.z < 0.0f
+			|| cell.x >= (float)m_cellsX || cell.y >= (float)m_cellsY || cell.z >= (float)m_cellsZ)
+			return s_noCell;
+		return (unsigned int)cell.x + m_cellsX * ((unsigned int)cell.y + m_cellsY * (unsigned int)cell.z);
+	}
+
+	void PotentiallyVisibleSet::Filter(unsigned int pCell, vector<unsigned int>& pObjects)
+	{
+		++m_frames;
+		m_tested += pObjects.size();
+		if (pCell == s_noCell)
+		{
+			++m_framesOutside;
+			return;
+		}
+
+		size_t write = 0U;
+		for (unsigned int object : pObjects)
+		{
+			if (IsVisible(pCell, object))
+				pObjects[write++] = object;
+		}
+		m_skipped += pObjects.size() - write;
+		pObjects.resize(write);
+	}
+
+	uint32_t PotentiallyVisibleSet::GetSceneKey(const vector<Object>& pObjects)
+	{
+		// Fnv-1a over the bytes
+		uint32_t key = 2166136261U;
+		auto hash = [&key](const void* pData, size_t pSize)
+		{
+			for (size_t i = 0; i < pSize; ++i)
+				key = (key ^ ((const uint8_t*)pData)[i]) * 16777619U;
+		};
+		for (const Object& object : pObjects)
+		{
+			uint32_t triangles = (object.mesh != nullptr ? (uint32_t)object.mesh->GetIndices()->size() / 3U : 0U);
+			hash(&object.bounds.min, sizeof(vec3));
+			hash(&object.bounds.max, sizeof(vec3));
+			hash(&triangles, sizeof(triangles));
+		}
+		return key;
+	}
+
+	void PotentiallyVisibleSet::CountVisible()
+	{
+		size_t cellCount = (size_t)m_cellsX * m_cellsY * m_cellsZ;
+		unsigned long long visible = 0ULL;
+		for (uint32_t word : m_bits)
+		{
+			for (; word != 0U; word &= word - 1U)
+				++visible;
+		}
+		m_averageVisible = (cellCount > 0U ? (double)visible / (double)cellCount : 0.0);
+	}
+
+	void PotentiallyVisibleSet::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_frames == 0ULL)
+		 	return;
+
+		 printf("Potentially visible sets (%ux%ux%u cells of %.1f, %.1f of %u objects each) over %llu frames: %.1f objects tested, %.1f skipped (%.1f%%), %.1f%% of frames outside the grid\n",
+		 	m_cellsX, m_cellsY, m_cellsZ, m_cellSize, m_averageVisible, m_objectCount, m_frames,
+		 	(double)m_tested / m_frames, (double)m_skipped / m_frames,
+		 	(m_tested > 0ULL ? 100.0 * (double)m_skipped / (double)m_tested : 0.0),
+		 	100.0 * (double)m_framesOutside / m_frames);
+		#endif
+	}
+}
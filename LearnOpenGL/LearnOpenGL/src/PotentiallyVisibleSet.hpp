@@ -0,0 +1,135 @@
+#pragma region
+#pragma once
+#include "Bounds.hpp"
+#include "WorkerPool.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using std::vector;
+using std::string;
+#pragma endregion
+
+namespace Engine
+{
+	class Mesh;
+
+	// Which objects of a static scene can be seen from each cell of a grid around it, baked offline and stored next
+	// to the scene so finding what to draw is a lookup. Rays are cast from points over each cell to the centre and
+	// corners of each object's bounds, against every object's triangles, and an object is seen if any ray reaches
+	// its bounds before hitting a front face. Cells are baked in parallel, each into a row of bits of its own.
+	// Being sampled, an object seen only through a gap none of the rays pass through can be missed
+	class PotentiallyVisibleSet
+	{
+	public:
+		static const unsigned int s_noCell = 0xFFFFFFFFU;
+		static const unsigned int s_samplesPerAxis = 3U;	// Each cell's corners, the centres of its faces and edges, and its centre
+		static const unsigned int s_maxCellsPerAxis = 32U;	// The cells grow past the size asked for to fit
+		static const unsigned long long s_maxRays = 32000000ULL;			// The most rays a bake can cast, the cells grow to fit
+		static const unsigned long long s_maxTriangleTests = 1000000000ULL;	// Past this many the bake gives up
+
+		// What is baked, its index in the list is what it is looked up by
+		struct Object
+		{
+			const Mesh* mesh = nullptr;	// Its vertices and indices are read
+			mat4 model = mat4(1.0f);	// Where its triangles block rays
+			AABB bounds;				// Everywhere it can be seen in world space, must hold the triangles
+		};
+
+		PotentiallyVisibleSet() = default;
+
+		#pragma region Delete copy/move
+		PotentiallyVisibleSet(const PotentiallyVisibleSet&) = delete;
+		PotentiallyVisibleSet& operator=(const PotentiallyVisibleSet&) = delete;
+		PotentiallyVisibleSet(PotentiallyVisibleSet&&) = delete;
+		PotentiallyVisibleSet& operator=(PotentiallyVisibleSet&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Casts rays from every cell of a grid around the objects to find which can be seen from each. The
+		 * cells grow to keep the rays under s_maxRays. Takes seconds, so it is meant to run offline
+		 *
+		 * @param pObjects The objects, none of them can move afterwards
+		 * @param pCellSize How wide each cell is
+		 * @param pMargin How far the grid reaches past the objects, the camera is never in a cell outside it
+		 * @param pWorkers The threads the cells are split between
+		 * @return If the sets were baked, not with too many objects for one cell or past s_maxTriangleTests
+		 */
+		bool Bake(const vector<Object>& pObjects, float pCellSize, float pMargin, WorkerPool& pWorkers);
+		/**
+		 * @brief Writes the baked sets to a file
+		 *
+		 * @param pPath The file path
+		 * @return If the file was written
+		 */
+		bool Save(const string& pPath) const;
+		/**
+		 * @brief Reads sets baked before, only if they were baked for the same objects
+		 *
+		 * @param pPath The file path
+		 * @param pObjects The objects the sets are for
+		 * @return If the sets were read, otherwise they need baking
+		 */
+		bool Load(const string& pPath, const vector<Object>& pObjects);
+		/**
+		 * @brief Forgets the sets, they need loading or baking again
+		 */
+		void Clear();
+
+		/**
+		 * @brief The cell a point is in
+		 *
+		 * @param pPosition The point in world space
+		 * @return The cell, or s_noCell outside the grid
+		 */
+		unsigned int FindCell(const vec3& pPosition) const;
+		/**
+		 * @brief Whether an object can be seen from a cell, always true outside the grid
+		 *
+		 * @param pCell The cell from FindCell
+		 * @param pObject The object's index in the baked list
+		 */
+		bool IsVisible(unsigned int pCell, unsigned int pObject) const
+		{
+			if (pCell == s_noCell || pObject >= m_objectCount)
+				return true;
+			return (m_bits[(size_t)pCell * m_words + (pObject >> 5)] & (1U << (pObject & 31U))) != 0U;
+		}
+		/**
+		 * @brief Takes the objects a cell can't see out of a list, keeping the order, and counts them for the report
+		 *
+		 * @param pCell The cell from FindCell
+		 * @param pObjects The indices of the objects
+		 */
+		void Filter(unsigned int pCell, vector<unsigned int>& pObjects);
+
+		bool GetBaked() const { return m_baked; }
+		/**
+		 * @brief Prints how many objects the sets kept from being drawn
+		 */
+		void PrintReport() const;
+
+	private:
+		/**
+		 * @brief Tells apart the scenes sets were baked for, from the bounds and triangle counts of the objects
+		 */
+		static uint32_t GetSceneKey(const vector<Object>& pObjects);
+		/**
+		 * @brief Counts the objects each cell sees, for the report
+		 */
+		void CountVisible();
+
+		bool m_baked = false;
+		uint32_t m_key = 0U;
+		uint32_t m_objectCount = 0U;
+		uint32_t m_words = 0U;					// Per cell, a bit per object
+		uint32_t m_cellsX = 0U, m_cellsY = 0U, m_cellsZ = 0U;
+		vec3 m_origin = vec3(0.0f);				// The lowest corner of the grid
+		float m_cellSize = 1.0f;
+		vector<uint32_t> m_bits;				// A row of m_words for each cell, x first then y then z
+
+		// Totals for the report
+		double m_averageVisible = 0.0;			// Objects seen from a cell, over every cell
+		unsigned long long m_frames = 0ULL, m_framesOutside = 0ULL, m_tested = 0ULL, m_skipped = 0ULL;
+	};
+}
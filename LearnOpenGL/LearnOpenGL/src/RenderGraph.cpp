@@ -0,0 +1,335 @@
+#pragma region
+#include "RenderGraph.hpp"
+#include "GLState.hpp"
+#include "glad/glad.h" // Include glad to get all the required OpenGL headers
+#include <algorithm>
+#include <cstdio>
+#ifdef _DEBUG
+ #include <iostream>
+ using std::cout;
+#endif
+#pragma endregion
+
+namespace Engine
+{
+	/**
+	 * @brief How many bytes a pixel of a format takes
+	 */
+	static unsigned int GetPixelSize(unsigned int pFormat)
+	{
+		switch (pFormat)
+		{
+			case GL_RGBA16F: return 8U;
+			case GL_RGBA32F: return 16U;
+			case GL_R8: return 1U;
+			default: return 4U;
+		}
+	}
+
+	void RenderGraph::Reset()
+	{
+		m_passes.clear();
+		m_targets.clear();
+		m_order.clear();
+
+		TargetInfo backbuffer;
+		backbuffer.name = "Backbuffer";
+		m_targets.push_back(backbuffer);
+	}
+
+	RenderGraph::Target RenderGraph::CreateTarget(const char* pName, const TargetDesc& pDesc)
+	{
+		TargetInfo target;
+		target.name = pName;
+		target.desc = pDesc;
+		m_targets.push_back(target);
+		return (Target)m_targets.size() - 1U;
+	}
+
+	unsigned int RenderGraph::AddPass(const char* pName, function<void(RenderGraph&)> pExecute)
+	{
+		Pass pass;
+		pass.name = pName;
+		pass.execute = pExecute;
+		m_passes.push_back(pass);
+		return (unsigned int)m_passes.size() - 1U;
+	}
+
+	void RenderGraph::Read(unsigned int pPass, Target pTarget)
+	{
+		Depend(pPass, pTarget, false, true);
+		m_passes[pPass].reads.push_back(pTarget);
+	}
+
+	void RenderGraph::Write(unsigned int pPass, Target pTarget, TargetLoad pLoad)
+	{
+		Pass& pass = m_passes[pPass];
+		pass.colour.push_back(pTarget);
+		pass.clearColour |= (pLoad == TargetLoad::Clear);
+		Depend(pPass, pTarget, true, pLoad == TargetLoad::Keep);
+	}
+
+	void RenderGraph::WriteDepth(unsigned int pPass, Target pTarget, TargetLoad pLoad)
+	{
+		Pass& pass = m_passes[pPass];
+		pass.depth = pTarget;
+		pass.clearDepth = (pLoad == TargetLoad::Clear);
+		Depend(pPass, pTarget, true, pLoad == TargetLoad::Keep);
+	}
+
+	void RenderGraph::Depend(unsigned int pPass, Target pTarget, bool pWrites, bool pLoads)
+	{
+		TargetInfo& target = m_targets[pTarget];
+		vector<unsigned int>& dependencies = m_passes[pPass].dependencies;
+		// A cleared target doesn't need whatever was drawn to it before, so that pass can be culled
+		if (pLoads && target.lastWriter != s_none && target.lastWriter != pPass)
+			dependencies.push_back(target.lastWriter);
+
+		if (!pWrites)
+		{
+			target.readers.push_back(pPass);
+			return;
+		}
+
+		// Drawing over a target has to wait for every pass still reading what was there
+		for (unsigned int reader : target.readers)
+		{
+			if (reader != pPass)
+				dependencies.push_back(reader);
+		}
+		target.lastWriter = pPass;
+		target.readers.clear();
+	}
+
+	void RenderGraph::Compile()
+	{
+		++m_frame;
+		++m_frames;
+
+		// Only passes that draw to the backbuffer are wanted, any other pass is kept only if they depend on it
+		m_order.clear();
+		vector<bool> visited = vector<bool>(m_passes.size(), false);
+		for (unsigned int i = 0; i < m_passes.size(); ++i)
+		{
+			const Pass& pass = m_passes[i];
+			if (pass.depth == s_backbuffer || std::find(pass.colour.begin(), pass.colour.end(), s_backbuffer) != pass.colour.end())
+				Visit(i, visited);
+		}
+		m_culledPasses += m_passes.size() - m_order.size();
+
+		// Where in the order each target is first and last used
+		vector<unsigned int> first = vector<unsigned int>(m_targets.size(), s_none);
+		vector<unsigned int> last = vector<unsigned int>(m_targets.size(), 0U);
+		for (unsigned int i = 0; i < m_order.size(); ++i)
+		{
+			const Pass& pass = m_passes[m_order[i]];
+			auto use = [&](Target pTarget)
+			{
+				if (pTarget == s_backbuffer || pTarget == s_none)
+					return;
+				if (first[pTarget] == s_none)
+					first[pTarget] = i;
+				last[pTarget] = i;
+			};
+			for (Target target : pass.reads)
+				use(target);
+			for (Target target : pass.colour)
+				use(target);
+			use(pass.depth);
+		}
+
+		// Walking the order, a texture goes back to the pool once the last pass using its target has run
+		for (PooledTexture& pooled : m_pool)
+			pooled.inUse = false;
+		vector<unsigned int> assigned = vector<unsigned int>(m_targets.size(), s_none);
+		for (unsigned int i = 0; i < m_order.size(); ++i)
+		{
+			for (unsigned int t = 1; t < m_targets.size(); ++t)
+			{
+				if (first[t] != i)
+					continue;
+
+				assigned[t] = Acquire(m_targets[t].desc);
+				m_targets[t].texture = m_pool[assigned[t]].texture;
+				m_targetBytes += (unsigned long long)m_targets[t].desc.width * m_targets[t].desc.height * GetPixelSize(m_targets[t].desc.format);
+			}
+			for (unsigned int t = 1; t < m_targets.size(); ++t)
+			{
+				if (first[t] != s_none && last[t] == i)
+					m_pool[assigned[t]].inUse = false;
+			}
+		}
+
+		// Textures nothing has wanted for a while are deleted, along with the framebuffers they are part of
+		for (size_t i = 0; i < m_pool.size();)
+		{
+			PooledTexture& pooled = m_pool[i];
+			if (pooled.lastFrame == m_frame)
+				m_pooledBytes += (unsigned long long)pooled.desc.width * pooled.desc.height * GetPixelSize(pooled.desc.format);
+			if (m_frame - pooled.lastFrame <= s_retireFrames)
+			{
+				++i;
+				continue;
+			}
+
+			for (auto it = m_framebuffers.begin(); it != m_framebuffers.end();)
+			{
+				if (std::find(it->first.begin(), it->first.end(), pooled.texture) != it->first.end())
+				{
+					glDeleteFramebuffers(1, &it->second);
+					it = m_framebuffers.erase(it);
+				}
+				else
+					++it;
+			}
+			glDeleteTextures(1, &pooled.texture);
+			GLState::Invalidate();
+			m_pool.erase(m_pool.begin() + i);
+		}
+	}
+
+	void RenderGraph::Visit(unsigned int pPass, vector<bool>& pVisited)
+	{
+		if (pVisited[pPass])
+			return;
+
+		pVisited[pPass] = true;
+		for (unsigned int dependency : m_passes[pPass].dependencies)
+			Visit(dependency, pVisited);
+		m_order.push_back(pPass);
+	}
+
+	unsigned int RenderGraph::Acquire(const TargetDesc& pDesc)
+	{
+		for (unsigned int i = 0; i < m_pool.size(); ++i)
+		{
+			PooledTexture& pooled = m_pool[i];
+			if (!pooled.inUse && pooled.desc == pDesc)
+			{
+				pooled.inUse = true;
+				pooled.lastFrame = m_frame;
+				return i;
+			}
+		}
+
+		PooledTexture pooled;
+		pooled.desc = pDesc;
+		pooled.inUse = true;
+		pooled.lastFrame = m_frame;
+
+		bool depth = (pDesc.format == GL_DEPTH_COMPONENT24 || pDesc.format == GL_DEPTH_COMPONENT32F);
+		unsigned int layout = (depth ? GL_DEPTH_COMPONENT : (pDesc.format == GL_R8 ? GL_RED : GL_RGBA));
+		unsigned int type = (depth ? GL_UNSIGNED_INT : (GetPixelSize(pDesc.format) > 4U ? GL_FLOAT : GL_UNSIGNED_BYTE));
+		glGenTextures(1, &pooled.texture);
+		GLState::BindTexture(s_creationUnit, GL_TEXTURE_2D, pooled.texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, pDesc.format, pDesc.width, pDesc.height, 0, layout, type, nullptr);
+		// Read a texel at a time, never filtered
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		m_pool.push_back(pooled);
+		return (unsigned int)m_pool.size() - 1U;
+	}
+
+	void RenderGraph::Execute()
+	{
+		for (unsigned int index : m_order)
+		{
+			Pass& pass = m_passes[index];
+			if (pass.depth == s_backbuffer || std::find(pass.colour.begin(), pass.colour.end(), s_backbuffer) != pass.colour.end())
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			else
+			{
+				vector<unsigned int> colour;
+				for (Target target : pass.colour)
+					colour.push_back(m_targets[target].texture);
+				glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer(colour, pass.depth != s_none ? m_targets[pass.depth].texture : 0U));
+			}
+
+			unsigned int clear = (pass.clearColour ? GL_COLOR_BUFFER_BIT : 0U) | (pass.clearDepth ? GL_DEPTH_BUFFER_BIT : 0U);
+			if (clear != 0U)
+			{
+				// Clearing depth obeys the depth mask
+				if (pass.clearDepth)
+					GLState::DepthMask(true);
+				glClear(clear);
+			}
+			pass.execute(*this);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	unsigned int RenderGraph::GetTexture(Target pTarget) const
+	{
+		return (pTarget < m_targets.size() ? m_targets[pTarget].texture : 0U);
+	}
+
+	unsigned int RenderGraph::GetFramebuffer(Target pTarget)
+	{
+		if (pTarget == s_backbuffer)
+			return 0U;
+
+		vector<unsigned int> colour = { GetTexture(pTarget) };
+		return GetFramebuffer(colour, 0U);
+	}
+
+	unsigned int RenderGraph::GetFramebuffer(const vector<unsigned int>& pColour, unsigned int pDepth)
+	{
+		vector<unsigned int> key = pColour;
+		key.push_back(pDepth);
+		auto found = m_framebuffers.find(key);
+		if (found != m_framebuffers.end())
+			return found->second;
+
+		unsigned int framebuffer = 0U;
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		vector<unsigned int> attachments;
+		for (unsigned int i = 0; i < pColour.size(); ++i)
+		{
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, pColour[i], 0);
+			attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+		}
+		if (pDepth != 0U)
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, pDepth, 0);
+
+		if (attachments.empty())
+			glDrawBuffer(GL_NONE);
+		else
+			glDrawBuffers((GLsizei)attachments.size(), attachments.data());
+
+		#ifdef _DEBUG
+		 if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		 	cout << "Error: Render graph framebuffer is incomplete\n";
+		#endif
+		m_framebuffers[key] = framebuffer;
+		return framebuffer;
+	}
+
+	void RenderGraph::Destroy(bool pValidate)
+	{
+		if (pValidate)
+		{
+			for (auto& framebuffer : m_framebuffers)
+				glDeleteFramebuffers(1, &framebuffer.second);
+			for (PooledTexture& pooled : m_pool)
+				glDeleteTextures(1, &pooled.texture);
+			GLState::Invalidate();
+		}
+		m_framebuffers.clear();
+		m_pool.clear();
+	}
+
+	void RenderGraph::PrintReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_frames == 0ULL || m_targetBytes == 0ULL)
+		 	return;
+
+		 const double megabyte = 1024.0 * 1024.0;
+		 printf("Render graph over %llu frames: %llu passes culled, targets %.1fMB a frame in %.1fMB of pooled textures\n",
+		 	m_frames, m_culledPasses, (double)m_targetBytes / m_frames / megabyte, (double)m_pooledBytes / m_frames / megabyte);
+		#endif
+	}
+}
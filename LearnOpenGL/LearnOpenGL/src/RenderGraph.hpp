@@ -0,0 +1,209 @@
+#pragma region
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+using std::vector;
+using std::string;
+using std::function;
+#pragma endregion
+
+namespace Engine
+{
+	// What a pass does with the contents a target had before it
+	enum class TargetLoad : uint8_t
+	{
+		Keep,	// Draws on top of the earlier passes
+		Clear	// Starts from the clear colour or depth, earlier contents are never read
+	};
+
+	// The size and format of a render target, targets with the same description can share a texture
+	struct TargetDesc
+	{
+		unsigned int width = 0U, height = 0U;
+		unsigned int format = 0U;	// A sized internal format such as GL_RGBA8, or GL_DEPTH_COMPONENT24 for depth
+
+		bool operator==(const TargetDesc& pOther) const
+		{
+			return width == pOther.width && height == pOther.height && format == pOther.format;
+		}
+	};
+
+	// Passes are described each frame with the targets they read and draw to. Compiling culls passes whose
+	// output never reaches the backbuffer, orders the rest by their dependencies and hands out textures
+	// from a pool, so targets that are never alive at the same time share one
+	class RenderGraph
+	{
+	public:
+		using Target = unsigned int;
+		static const Target s_backbuffer = 0U;			// The default framebuffer, its colour and depth
+		static const unsigned int s_none = 0xFFFFFFFFU;
+
+		RenderGraph() = default;
+
+		#pragma region Delete copy/move
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+		RenderGraph(RenderGraph&&) = delete;
+		RenderGraph& operator=(RenderGraph&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Forgets the last frame's passes and targets, the pooled textures are kept
+		 */
+		void Reset();
+		/**
+		 * @brief Declares a target that only lives for this frame
+		 *
+		 * @param pName What the target is called in reports
+		 * @param pDesc The size and format
+		 * @return The handle passes refer to it by
+		 */
+		Target CreateTarget(const char* pName, const TargetDesc& pDesc);
+		/**
+		 * @brief Adds a pass, its reads and writes are then declared with the index returned
+		 *
+		 * @param pName What the pass is called in reports
+		 * @param pExecute Draws the pass, called with its framebuffer bound and cleared
+		 * @return The index of the pass
+		 */
+		unsigned int AddPass(const char* pName, function<void(RenderGraph&)> pExecute);
+		/**
+		 * @brief Declares a target a pass samples from, the pass runs after whatever last drew to it
+		 *
+		 * @param pPass The pass
+		 * @param pTarget The target
+		 */
+		void Read(unsigned int pPass, Target pTarget);
+		/**
+		 * @brief Declares a colour target a pass draws to, attached in the order they are declared.
+		 * Clearing any colour target clears all of the pass's colour targets
+		 *
+		 * @param pPass The pass
+		 * @param pTarget The target
+		 * @param pLoad Whether to keep or clear what was there
+		 */
+		void Write(unsigned int pPass, Target pTarget, TargetLoad pLoad = TargetLoad::Keep);
+		/**
+		 * @brief Declares the depth target a pass tests against or draws to
+		 *
+		 * @param pPass The pass
+		 * @param pTarget The target
+		 * @param pLoad Whether to keep or clear what was there
+		 */
+		void WriteDepth(unsigned int pPass, Target pTarget, TargetLoad pLoad = TargetLoad::Keep);
+		/**
+		 * @brief Culls unused passes, orders the rest and assigns every target a pooled texture
+		 */
+		void Compile();
+		/**
+		 * @brief Runs the compiled passes in order, must be called on the thread that owns the context
+		 */
+		void Execute();
+		/**
+		 * @brief Deletes the pooled textures and framebuffers
+		 *
+		 * @param pValidate Whether the context is still alive
+		 */
+		void Destroy(bool pValidate);
+		/**
+		 * @brief Prints how much memory the pool saved by sharing textures between targets
+		 */
+		void PrintReport() const;
+
+		/**
+		 * @brief The texture a target was given, only valid while executing
+		 *
+		 * @param pTarget The target
+		 * @return The texture id
+		 */
+		unsigned int GetTexture(Target pTarget) const;
+		/**
+		 * @brief A framebuffer with only the target attached, to copy from
+		 *
+		 * @param pTarget The target
+		 * @return The framebuffer id, 0 for the backbuffer
+		 */
+		unsigned int GetFramebuffer(Target pTarget);
+		unsigned int GetCompiledPassCount() const { return (unsigned int)m_order.size(); }
+
+	private:
+		struct Pass
+		{
+			string name;
+			function<void(RenderGraph&)> execute;
+			vector<Target> reads;
+			vector<Target> colour;
+			Target depth = s_none;
+			bool clearColour = false, clearDepth = false;
+			vector<unsigned int> dependencies;	// Passes that must run first
+		};
+
+		struct TargetInfo
+		{
+			string name;
+			TargetDesc desc;
+			unsigned int lastWriter = s_none;	// While declaring, the pass a read of it depends on
+			vector<unsigned int> readers;		// While declaring, passes reading what lastWriter drew
+			unsigned int texture = 0U;			// The pooled texture, once compiled
+		};
+
+		struct PooledTexture
+		{
+			TargetDesc desc;
+			unsigned int texture = 0U;
+			bool inUse = false;
+			unsigned int lastFrame = 0U;	// Textures unused for a while are deleted
+		};
+
+		/**
+		 * @brief Makes a pass depend on whatever last drew to a target if it uses what is there,
+		 * and on every pass that read it if the pass draws over it
+		 *
+		 * @param pPass The pass
+		 * @param pTarget The target
+		 * @param pWrites Whether the pass draws to the target
+		 * @param pLoads Whether the pass uses what was already there
+		 */
+		void Depend(unsigned int pPass, Target pTarget, bool pWrites, bool pLoads);
+		/**
+		 * @brief Adds a pass after its dependencies to the order, depth first
+		 *
+		 * @param pPass The pass
+		 * @param pVisited Which passes were already added
+		 */
+		void Visit(unsigned int pPass, vector<bool>& pVisited);
+		/**
+		 * @brief Finds or creates a free texture of a description
+		 *
+		 * @param pDesc The size and format
+		 * @return The index of the pooled texture
+		 */
+		unsigned int Acquire(const TargetDesc& pDesc);
+		/**
+		 * @brief Finds or creates the framebuffer with a set of textures attached
+		 *
+		 * @param pColour The colour textures in attachment order
+		 * @param pDepth The depth texture, 0 for none
+		 * @return The framebuffer id
+		 */
+		unsigned int GetFramebuffer(const vector<unsigned int>& pColour, unsigned int pDepth);
+
+		static const unsigned int s_retireFrames = 8U;		// How long a pooled texture can go unused
+		static const unsigned int s_creationUnit = 10U;		// Texture unit new textures are bound to while created
+
+		vector<Pass> m_passes;
+		vector<TargetInfo> m_targets;	// The backbuffer is always the first
+		vector<unsigned int> m_order;	// The passes kept, in the order they run
+		vector<PooledTexture> m_pool;
+		std::map<vector<unsigned int>, unsigned int> m_framebuffers;	// Keyed by the attached textures, depth last
+		unsigned int m_frame = 0U;
+
+		// Totals for the report
+		unsigned long long m_frames = 0ULL, m_culledPasses = 0ULL;
+		unsigned long long m_targetBytes = 0ULL, m_pooledBytes = 0ULL;	// Summed each frame
+	};
+}
@@ -0,0 +1,111 @@
+#pragma region
+#include "RenderQueue.hpp"
+#include "Mesh.hpp"
+#include "Camera.hpp"
+#include <algorithm>
+#include <cmath>
+#pragma endregion
+
+namespace Engine
+{
+	void RenderQueue::Clear()
+	{
+		m_items.clear();
+		m_keys.clear();
+		m_order.clear();
+	}
+
+	void RenderQueue::Submit(const DrawItem& pItem, RenderPass pPass, float pDepth)
+	{
+		const vector<Texture>* textures = pItem.mesh->GetTextures();
+		unsigned int material = (textures != nullptr && !textures->empty() ? textures->front().GetId() + 1U : 0U);
+		uint64_t key = MakeKey(pPass, pItem.shader->GetProgram(), material, *pItem.mesh->GetVAO(), pDepth);
+
+		m_order.push_back((uint32_t)m_items.size());
+		m_keys.push_back(key);
+		m_items.push_back(pItem);
+		m_items.back().sortKey = key;
+	}
+
+	void RenderQueue::Flush(vector<DrawItem>& pOut)
+	{
+		RadixSort();
+
+		pOut.clear();
+		for (uint32_t index : m_order)
+			pOut.push_back(m_items[index]);
+	}
+
+	// Static
+	uint64_t RenderQueue::MakeKey(RenderPass pPass, unsigned int pShader, unsigned int pMaterial, unsigned int pVAO, float pDepth)
+	{
+		// Linear depth over the whole view range, 28 bits is well below a millimetre
+		const uint64_t depthMax = (1ULL << 28) - 1ULL;
+		double normalised = std::clamp((double)pDepth / Camera::s_farPlane, 0.0, 1.0);
+		uint64_t depth = (uint64_t)std::llround(normalised * (double)depthMax);
+
+		uint64_t key = (uint64_t)pPass << 62;
+		if (pPass == RenderPass::Transparent)
+		{
+			// Furthest first
+			key |= (depthMax - depth) << 34;
+			key |= ((uint64_t)pShader & 0x3FFULL) << 24;
+			key |= ((uint64_t)pMaterial & 0xFFFULL) << 12;
+			key |= (uint64_t)pVAO & 0xFFFULL;
+		}
+		else
+		{
+			key |= ((uint64_t)pShader & 0x3FFULL) << 52;
+			key |= ((uint64_t)pMaterial & 0xFFFULL) << 40;
+			key |= ((uint64_t)pVAO & 0xFFFULL) << 28;
+			key |= depth;
+		}
+		return key;
+	}
+
+	void RenderQueue::RadixSort()
+	{
+		size_t count = m_keys.size();
+		if (count < 2)
+			return;
+
+		m_keysScratch.resize(count);
+		m_orderScratch.resize(count);
+
+		// Scattering reorders the keys but not their digits, so every pass's counts come from one read
+		std::fill(&m_histograms[0][0], &m_histograms[0][0] + 8 * 256, 0U);
+		for (uint64_t key : m_keys)
+		{
+			for (unsigned int digit = 0; digit < 8; ++digit)
+				++m_histograms[digit][(key >> (digit * 8)) & 0xFFULL];
+		}
+
+		for (unsigned int digit = 0; digit < 8; ++digit)
+		{
+			const unsigned int shift = digit * 8;
+			uint32_t* histogram = m_histograms[digit];
+			// All in one bucket means this digit is already in order
+			if (histogram[(m_keys[0] >> shift) & 0xFFULL] == count)
+				continue;
+
+			// Counts to starting offsets
+			uint32_t offset = 0U;
+			for (unsigned int bucket = 0; bucket < 256; ++bucket)
+			{
+				uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			// Stable scatter, keeps the order of the previous digits
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t destination = histogram[(m_keys[i] >> shift) & 0xFFULL]++;
+				m_keysScratch[destination] = m_keys[i];
+				m_orderScratch[destination] = m_order[i];
+			}
+			m_keys.swap(m_keysScratch);
+			m_order.swap(m_orderScratch);
+		}
+	}
+}
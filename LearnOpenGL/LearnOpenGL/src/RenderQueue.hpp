@@ -0,0 +1,79 @@
+#pragma region
+#pragma once
+#include "FrameSnapshot.hpp"
+#pragma endregion
+
+namespace Engine
+{
+	// Drawn in this order, the pass is the top of the sort key
+	enum class RenderPass : uint8_t
+	{
+		Opaque,
+		Transparent,
+		Count
+	};
+
+	// Collects a frame's draw items and radix sorts them by a 64 bit key so state changes are grouped.
+	// Opaque items are front to back within the same state, transparent items are back to front
+	class RenderQueue
+	{
+	public:
+		RenderQueue() = default;
+		~RenderQueue() {}
+
+		/**
+		 * @brief Empties the queue, keeping its memory
+		 */
+		void Clear();
+		/**
+		 * @brief Adds an item to be drawn, its key is built from its state and depth
+		 *
+		 * @param pItem The item, mesh and shader must be set
+		 * @param pPass The pass the item belongs to
+		 * @param pDepth The item's distance from the camera
+		 */
+		void Submit(const DrawItem& pItem, RenderPass pPass, float pDepth);
+		/**
+		 * @brief Sorts the submitted items and writes them out in draw order
+		 *
+		 * @param pOut Replaced with the sorted items
+		 */
+		void Flush(vector<DrawItem>& pOut);
+
+		unsigned int GetCount() const { return (unsigned int)m_items.size(); }
+
+		/**
+		 * @brief Packs the draw state into a sort key, from the top: pass 2 bits, then for opaque
+		 * shader 10, material 12, vertex array 12, depth 28. Transparent puts the inverted depth straight
+		 * after the pass as blending needs the order more than fewer state changes
+		 *
+		 * @param pPass The pass
+		 * @param pShader The shader program id
+		 * @param pMaterial The material or first texture id
+		 * @param pVAO The vertex array id
+		 * @param pDepth The distance from the camera
+		 * @return The key, smaller is drawn first
+		 */
+		static uint64_t MakeKey(RenderPass pPass, unsigned int pShader, unsigned int pMaterial, unsigned int pVAO, float pDepth);
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, there is one queue per renderer.
+		RenderQueue(const RenderQueue&) = delete;
+		RenderQueue& operator=(const RenderQueue&) = delete;
+		RenderQueue(RenderQueue&&) = delete;
+		RenderQueue& operator=(RenderQueue&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief Least significant digit radix sort of m_keys, 8 bits per pass, carrying m_order along. Every
+		 * digit is counted in one read of the keys, and passes where every key has the same digit are skipped
+		 */
+		void RadixSort();
+
+		vector<DrawItem> m_items;						// In submission order
+		vector<uint64_t> m_keys, m_keysScratch;
+		vector<uint32_t> m_order, m_orderScratch;		// Index into m_items for each key
+		uint32_t m_histograms[8][256] = {};				// Each 8 bit digit's counts, small enough to stay in cache
+	};
+}
@@ -0,0 +1,91 @@
+#pragma region
+#include "RenderThread.hpp"
+
+using std::unique_lock;
+using std::lock_guard;
+using std::mutex;
+#pragma endregion
+
+namespace Engine
+{
+	RenderThread::~RenderThread()
+	{
+		Stop();
+	}
+
+	void RenderThread::Start(function<void()> pOnStart, function<void(const FrameSnapshot&)> pOnFrame, function<void()> pOnStop)
+	{
+		if (GetRunning())
+			return;
+
+		m_onStart = pOnStart;
+		m_onFrame = pOnFrame;
+		m_onStop = pOnStop;
+		m_stopping = false;
+		m_writeSlot = m_readSlot = 0U;
+		for (unsigned int i = 0; i < s_slotCount; ++i)
+			m_states[i] = SlotState::Free;
+
+		m_thread = std::thread(&RenderThread::Loop, this);
+	}
+
+	void RenderThread::Stop()
+	{
+		if (!GetRunning())
+			return;
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_readyCondition.notify_one();
+		m_thread.join();
+	}
+
+	FrameSnapshot& RenderThread::BeginWrite()
+	{
+		// Back-pressure, the game thread can only get one frame ahead of the one being drawn
+		unique_lock<mutex> lock(m_mutex);
+		m_freeCondition.wait(lock, [this] { return m_states[m_writeSlot] == SlotState::Free; });
+		return m_slots[m_writeSlot];
+	}
+
+	void RenderThread::Publish()
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_states[m_writeSlot] = SlotState::Ready;
+			m_writeSlot = (m_writeSlot + 1U) % s_slotCount;
+		}
+		m_readyCondition.notify_one();
+	}
+
+	void RenderThread::Loop()
+	{
+		if (m_onStart)
+			m_onStart();
+
+		while (true)
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_readyCondition.wait(lock, [this] { return m_states[m_readSlot] == SlotState::Ready || m_stopping; });
+			// Anything already published is still drawn when stopping
+			if (m_states[m_readSlot] != SlotState::Ready)
+				break;
+			m_states[m_readSlot] = SlotState::Reading;
+			lock.unlock();
+
+			// The snapshot is left alone by the game thread until it is freed
+			m_onFrame(m_slots[m_readSlot]);
+
+			lock.lock();
+			m_states[m_readSlot] = SlotState::Free;
+			m_readSlot = (m_readSlot + 1U) % s_slotCount;
+			lock.unlock();
+			m_freeCondition.notify_one();
+		}
+
+		if (m_onStop)
+			m_onStop();
+	}
+}
@@ -0,0 +1,83 @@
+#pragma region
+#pragma once
+#include "FrameSnapshot.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using std::function;
+#pragma endregion
+
+namespace Engine
+{
+	// Owns the gl context on its own thread and draws the snapshots the game thread publishes.
+	// Two snapshots are double buffered so the next frame can be built while the last is drawn
+	class RenderThread
+	{
+	public:
+		RenderThread() = default;
+		~RenderThread();
+
+		/**
+		 * @brief Starts the thread, the gl context must no longer be current on the calling thread
+		 *
+		 * @param pOnStart Called first on the render thread, used to make the context current
+		 * @param pOnFrame Called on the render thread for every published snapshot, in order
+		 * @param pOnStop Called last on the render thread, used to release the context
+		 */
+		void Start(function<void()> pOnStart, function<void(const FrameSnapshot&)> pOnFrame, function<void()> pOnStop);
+		/**
+		 * @brief Draws any snapshots already published then joins the thread
+		 */
+		void Stop();
+
+		/**
+		 * @brief Gets the snapshot to build the next frame into, blocks while both are still waiting to be drawn
+		 *
+		 * @return The snapshot, only valid until Publish()
+		 */
+		FrameSnapshot& BeginWrite();
+		/**
+		 * @brief Hands the snapshot from BeginWrite() to the render thread
+		 */
+		void Publish();
+
+		bool GetRunning() const { return m_thread.joinable(); }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, the thread holds a pointer to this instance.
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+		RenderThread(RenderThread&&) = delete;
+		RenderThread& operator=(RenderThread&&) = delete;
+		#pragma endregion
+
+		enum class SlotState : uint8_t
+		{
+			Free,		// Can be written by the game thread
+			Ready,		// Published and waiting to be drawn
+			Reading		// Being drawn
+		};
+
+		/**
+		 * @brief The body of the render thread
+		 */
+		void Loop();
+
+		static const unsigned int s_slotCount = 2U;
+
+		FrameSnapshot m_slots[s_slotCount];
+		SlotState m_states[s_slotCount] = {};
+		unsigned int m_writeSlot = 0U, m_readSlot = 0U;	// Both walk the slots in the same order so no frame is skipped
+
+		std::mutex m_mutex;
+		std::condition_variable m_readyCondition, m_freeCondition;
+		bool m_stopping = false;
+		std::thread m_thread;
+
+		function<void()> m_onStart, m_onStop;
+		function<void(const FrameSnapshot&)> m_onFrame;
+	};
+}
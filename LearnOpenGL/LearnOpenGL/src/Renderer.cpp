@@ -1,7 +1,11 @@
 #pragma region
 #include "Renderer.hpp"
+#include "GLState.hpp"
 #include "glad/glad.h" // Include glad to get all the required OpenGL headers
 #include "glm/gtc/matrix_transform.hpp"
+#include <limits>
+#include <cmath>
+#include <cstdio>
 #ifdef _DEBUG
  #include <iostream>
  using std::cout;
@@ -15,7 +19,7 @@ namespace Engine
 	void Renderer::Init(float pAspect)
 	{
 		// Enables the use of the depth buffer
-		glEnable(GL_DEPTH_TEST);
+		GLState::SetEnabled(GL_DEPTH_TEST, true);
 
 		// Initialise camera
 		m_cameraRef = new Camera(pAspect, 75.0f);
@@ -26,9 +30,31 @@ namespace Engine
 		m_lightDirectional = new Light(LightType::Directional, vec3(0, -1, 0), vec3(0.8f));
 		m_lightPoint = new Light(LightType::Point, vec4(-4, 2, -2, 1), vec3(1.0f));
 		m_lightSpot = new Light(LightType::Spot, vec4(4.5f, 3, 3.5f, 1), vec3(-0.7f, -0.6f, -1), vec3(1.0f), 17.0f, 0.1f);
+		m_lights.Init();
+		m_lights.Add(m_lightDirectional);
+		m_lights.Add(m_lightPoint);
+		m_lights.Add(m_lightSpot);
+		SetPointLightCount(m_pointLightCount);
+		m_clusters.Init();
+		m_workers.Start();
+
+		// Holds the model matrices of every instanced draw
+		glGenBuffers(1, &m_instanceVBO);
+		// Shared by every shader so the camera is uploaded once a frame instead of once per shader
+		glGenBuffers(1, &m_frameUBO);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_frameUBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+		GLState::BindBufferBase(GL_UNIFORM_BUFFER, FrameUniforms::s_binding, m_frameUBO);
 
 		// Initialise shader array
 		m_shaders = make_unique<vector<unique_ptr<Shader>>>();
+		CreateDeferredPasses();
+		m_hiz.Init();
+		for (PrepassQueries& queries : m_prepassQueries)
+		{
+			glGenQueries(1, &queries.depth);
+			glGenQueries(1, &queries.shaded);
+		}
 
 		#ifdef LEGACY
 		 m_meshes = make_unique<vector<unique_ptr<Mesh>>>();
@@ -67,28 +93,503 @@ namespace Engine
 
 			if (m_model != nullptr)
 				m_model->Destroy(pValidate);
+
+			glDeleteBuffers(1, &m_instanceVBO);
+			glDeleteBuffers(1, &m_frameUBO);
+			m_lights.Destroy(pValidate);
+			m_clusters.Destroy(pValidate);
+			m_graph.Destroy(pValidate);
+			m_hiz.Destroy(pValidate);
+			m_directionalPass->Destroy(pValidate);
+			m_lightVolumePass->Destroy(pValidate);
+			m_lightVolume->Destroy(pValidate);
+			glDeleteVertexArrays(1, &m_emptyVAO);
+			for (PrepassQueries& queries : m_prepassQueries)
+			{
+				glDeleteQueries(1, &queries.depth);
+				glDeleteQueries(1, &queries.shaded);
+			}
+			GLState::Invalidate();
 		}
 
+		m_workers.Stop();
 		delete m_cameraRef;
 		delete m_model;
 	}
 
 	void Renderer::Draw(double pTime)
 	{
-		// Clears to background colour
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		BuildSnapshot(m_snapshot, pTime);
+		DrawSnapshot(m_snapshot);
+	}
 
+	void Renderer::BuildSnapshot(FrameSnapshot& pSnapshot, double pTime)
+	{
+		if (GetAnimating())
+			m_animationTime += pTime - m_lastDrawTime;
+
+		pSnapshot.time = pTime;
+		pSnapshot.viewportWidth = m_viewportWidth;
+		pSnapshot.viewportHeight = m_viewportHeight;
+		pSnapshot.wireframe = m_wireframe;
+		pSnapshot.deferred = m_deferred;
+		pSnapshot.depthPrepass = m_depthPrepass;
+		pSnapshot.gpuOcclusion = m_gpuOcclusion;
+
+		// Camera
+		pSnapshot.view = m_cameraRef->GetView();
+		pSnapshot.projection = m_cameraRef->GetProjection();
+		pSnapshot.viewProjection = m_cameraRef->GetWorldToCameraMatrix();
+		pSnapshot.viewPosition = m_cameraRef->GetPosition();
+		m_culler.SetFrustum(pSnapshot.viewProjection);
+		m_occlusion.Begin(pSnapshot.viewProjection);
+
+		// Lights, only the bytes of the light buffer that changed are uploaded
+		pSnapshot.lightsChanged = m_lights.GetDirty();
+		pSnapshot.point.colour = m_lightPoint->GetColour();
+		pSnapshot.point.position = m_lightPoint->GetPosition();
+		pSnapshot.spot.colour = m_lightSpot->GetColour();
+		pSnapshot.spot.position = m_lightSpot->GetPosition();
+		m_lights.Sync(pSnapshot.lightUpload);
+		pSnapshot.lightVolumes = m_lights.GetPointCount() + m_lights.GetSpotCount();
+		pSnapshot.clusters.enabled = m_clustered;
+		if (m_clustered)
+			m_clusters.Build(m_lights, pSnapshot.view, pSnapshot.projection, m_workers, pSnapshot.clusters);
+
+		m_renderQueue.Clear();
+		m_culler.Clear();
+		m_cullItems.clear();
+		m_cullBoxes.clear();
+		pSnapshot.instances.clear();
 		#ifdef LEGACY
-		 RenderBoxScene(pTime);
+		 BuildBoxScene(pSnapshot);
 		#else
-		 m_model->Draw(GetShaderAt(0U), m_cameraRef);
+		 m_treeResults.clear();
+		 for (unsigned int i = 0; i < m_model->GetMeshCount(); ++i)
+		 	m_treeResults.push_back(i);
+		 if (m_pvsCulling)
+		 	m_pvs.Filter(FindPvsCell(pSnapshot), m_treeResults);
+		 for (unsigned int i : m_treeResults)
+		 {
+		 	DrawItem item;
+		 	item.mesh = m_model->GetMeshAt(i);
+		 	item.shader = GetShaderAt(0U);
+		 	SubmitOpaque(item, pSnapshot);
+		 }
+		#endif
+		QueueVisible(pSnapshot);
+		// Grouped by shader, texture and vertex array, then front to back for early depth rejection
+		m_renderQueue.Flush(pSnapshot.drawList);
+		MergeInstances(pSnapshot);
+
+		// Everything up to now is captured
+		m_dirty = false;
+		m_lastDrawTime = pTime;
+		m_cameraRef->ClearDirty();
+	}
+
+	void Renderer::DrawSnapshot(const FrameSnapshot& pSnapshot)
+	{
+		if (pSnapshot.viewportWidth != m_appliedWidth || pSnapshot.viewportHeight != m_appliedHeight)
+		{
+			glViewport(0, 0, pSnapshot.viewportWidth, pSnapshot.viewportHeight);
+			m_appliedWidth = pSnapshot.viewportWidth;
+			m_appliedHeight = pSnapshot.viewportHeight;
+		}
+		GLState::PolygonMode(pSnapshot.wireframe ? GL_LINE : GL_FILL);
+
+		m_lights.Upload(pSnapshot.lightUpload);
+		m_clusters.Upload(pSnapshot.clusters);
+		#ifdef LEGACY
+		 if (pSnapshot.lightsChanged)
+		 	UploadLightCubes(pSnapshot);
+		#endif
+
+		UploadFrameUniforms(pSnapshot);
+
+		if (!pSnapshot.instances.empty())
+		{
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+			size_t size = pSnapshot.instances.size() * sizeof(mat4);
+			if (pSnapshot.instances.size() > m_instanceCapacity)
+			{
+				glBufferData(GL_ARRAY_BUFFER, size, pSnapshot.instances.data(), GL_STREAM_DRAW);
+				m_instanceCapacity = pSnapshot.instances.size();
+			}
+			else
+			{
+				// Orphaning lets the driver hand out new storage instead of waiting on frames still reading the old
+				glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(mat4), nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, size, pSnapshot.instances.data());
+			}
+		}
+
+		// Every pass draws the same culled copies
+		if (pSnapshot.gpuOcclusion)
+			m_hiz.Cull(pSnapshot, m_instanceVBO);
+		else
+			m_hiz.Skip();
+
+		// The passes are described again each frame, so switching paths only changes which are added
+		m_graph.Reset();
+		if (pSnapshot.deferred && pSnapshot.viewportWidth > 0U && pSnapshot.viewportHeight > 0U)
+			AddDeferredPasses(pSnapshot);
+		else
+			AddForwardPasses(pSnapshot);
+		m_graph.Compile();
+		m_graph.Execute();
+	}
+
+	void Renderer::AddForwardPasses(const FrameSnapshot& pSnapshot)
+	{
+		const RenderGraph::Target backbuffer = RenderGraph::s_backbuffer;
+		if (!pSnapshot.depthPrepass)
+		{
+			// Clears to background colour
+			unsigned int forward = m_graph.AddPass("Forward", [this, &pSnapshot](RenderGraph&)
+			{
+				DrawItems(pSnapshot, DrawSet::All);
+			});
+			m_graph.Write(forward, backbuffer, TargetLoad::Clear);
+			m_graph.WriteDepth(forward, backbuffer, TargetLoad::Clear);
+			AddHiZPass(pSnapshot, backbuffer);
+			return;
+		}
+
+		unsigned int depth = m_graph.AddPass("DepthPrepass", [this, &pSnapshot](RenderGraph&)
+		{
+			DrawPrepassDepth(pSnapshot);
+		});
+		m_graph.Write(depth, backbuffer, TargetLoad::Clear);
+		m_graph.WriteDepth(depth, backbuffer, TargetLoad::Clear);
+
+		unsigned int shading = m_graph.AddPass("Shading", [this, &pSnapshot](RenderGraph&)
+		{
+			DrawPrepassShading(pSnapshot);
+		});
+		m_graph.Write(shading, backbuffer);
+		m_graph.WriteDepth(shading, backbuffer);
+		AddHiZPass(pSnapshot, backbuffer);
+	}
+
+	void Renderer::DrawPrepassDepth(const FrameSnapshot& pSnapshot)
+	{
+		// The oldest pair is read before it is reused, the gpu finished it frames ago
+		PrepassQueries& queries = m_prepassQueries[m_prepassFrame++ % s_prepassQueryFrames];
+		if (queries.pending)
+		{
+			GLuint64 depthSamples = 0ULL, shadedSamples = 0ULL;
+			glGetQueryObjectui64v(queries.depth, GL_QUERY_RESULT, &depthSamples);
+			glGetQueryObjectui64v(queries.shaded, GL_QUERY_RESULT, &shadedSamples);
+			m_prepassDepthSamples += depthSamples;
+			m_prepassShadedSamples += shadedSamples;
+			++m_prepassFrames;
+		}
+
+		// Depth only. Every fragment passing here would have been shaded without the pre-pass, as the
+		// draws are in the same order
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		glBeginQuery(GL_SAMPLES_PASSED, queries.depth);
+		DrawItems(pSnapshot, DrawSet::Depth);
+		glEndQuery(GL_SAMPLES_PASSED);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+
+	void Renderer::DrawPrepassShading(const FrameSnapshot& pSnapshot)
+	{
+		// The pair the depth pass just began
+		PrepassQueries& queries = m_prepassQueries[(m_prepassFrame - 1U) % s_prepassQueryFrames];
+
+		// Only the nearest surface of each pixel matches the depth already there
+		GLState::DepthFunc(GL_EQUAL);
+		GLState::DepthMask(false);
+		glBeginQuery(GL_SAMPLES_PASSED, queries.shaded);
+		DrawItems(pSnapshot, DrawSet::Prepassed);
+		glEndQuery(GL_SAMPLES_PASSED);
+		GLState::DepthMask(true);
+		GLState::DepthFunc(GL_LESS);
+		queries.pending = true;
+
+		DrawItems(pSnapshot, DrawSet::NotPrepassed);
+	}
+
+	void Renderer::PrintPrepassReport() const
+	{
+		#ifdef _DEBUG
+		 if (m_prepassFrames == 0ULL)
+		 	return;
+
+		 unsigned long long saved = m_prepassDepthSamples - m_prepassShadedSamples;
+		 printf("Depth pre-pass over %llu frames: %llu fragments passed depth, %llu shaded, %llu saved (%.1f%%)\n",
+		 	m_prepassFrames, m_prepassDepthSamples, m_prepassShadedSamples, saved,
+		 	(m_prepassDepthSamples > 0ULL ? 100.0 * (double)saved / (double)m_prepassDepthSamples : 0.0));
 		#endif
 	}
 
+	void Renderer::AddDeferredPasses(const FrameSnapshot& pSnapshot)
+	{
+		const unsigned int width = pSnapshot.viewportWidth, height = pSnapshot.viewportHeight;
+		RenderGraph::Target albedoSpec = m_graph.CreateTarget("AlbedoSpec", { width, height, GL_RGBA8 });
+		RenderGraph::Target normal = m_graph.CreateTarget("Normal", { width, height, GL_RGBA16F });
+		RenderGraph::Target depth = m_graph.CreateTarget("Depth", { width, height, GL_DEPTH_COMPONENT24 });
+		RenderGraph::Target lit = m_graph.CreateTarget("Lit", { width, height, GL_RGBA8 });
+
+		unsigned int geometry = m_graph.AddPass("GBuffer", [this, &pSnapshot](RenderGraph&)
+		{
+			DrawItems(pSnapshot, DrawSet::Surfaces);
+		});
+		m_graph.Write(geometry, albedoSpec, TargetLoad::Clear);
+		m_graph.Write(geometry, normal, TargetLoad::Clear);
+		m_graph.WriteDepth(geometry, depth, TargetLoad::Clear);
+
+		// Lighting reads the surfaces into the lit target but never writes depth. The lit target is cleared so
+		// empty pixels come out as the background colour
+		unsigned int lighting = m_graph.AddPass("Lighting", [this, &pSnapshot, albedoSpec, normal, depth](RenderGraph& pGraph)
+		{
+			GLState::BindTexture(s_albedoSpecUnit, GL_TEXTURE_2D, pGraph.GetTexture(albedoSpec));
+			GLState::BindTexture(s_normalUnit, GL_TEXTURE_2D, pGraph.GetTexture(normal));
+			GLState::BindTexture(s_depthUnit, GL_TEXTURE_2D, pGraph.GetTexture(depth));
+			GLState::PolygonMode(GL_FILL);
+			GLState::SetEnabled(GL_DEPTH_TEST, false);
+			GLState::DepthMask(false);
+
+			// The directional light reaches everything so it covers the screen, and brings the ambient light.
+			// It overwrites the background colour under surfaces, empty pixels are discarded and keep it
+			m_directionalPass->Use();
+			GLState::BindVertexArray(m_emptyVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			// Other lights add on top, only over the pixels their volume covers. Back faces are drawn without
+			// clipping so a volume still counts when the camera is inside it or it reaches past the far plane
+			if (pSnapshot.lightVolumes > 0U)
+			{
+				GLState::SetEnabled(GL_BLEND, true);
+				GLState::BlendFunc(GL_ONE, GL_ONE);
+				GLState::SetEnabled(GL_CULL_FACE, true);
+				glCullFace(GL_FRONT);
+				GLState::SetEnabled(GL_DEPTH_CLAMP, true);
+				m_lightVolumePass->Use();
+				m_lightVolume->DrawInstanced(pSnapshot.lightVolumes);
+				GLState::SetEnabled(GL_DEPTH_CLAMP, false);
+				glCullFace(GL_BACK);
+				GLState::SetEnabled(GL_CULL_FACE, false);
+				GLState::SetEnabled(GL_BLEND, false);
+			}
+
+			GLState::DepthMask(true);
+			GLState::SetEnabled(GL_DEPTH_TEST, true);
+			GLState::PolygonMode(pSnapshot.wireframe ? GL_LINE : GL_FILL);
+		});
+		m_graph.Read(lighting, albedoSpec);
+		m_graph.Read(lighting, normal);
+		m_graph.Read(lighting, depth);
+		m_graph.Write(lighting, lit, TargetLoad::Clear);
+
+		// Such as the light cubes, tested against the g-buffer's depth
+		unsigned int unlit = m_graph.AddPass("Unlit", [this, &pSnapshot](RenderGraph&)
+		{
+			DrawItems(pSnapshot, DrawSet::Unlit);
+		});
+		m_graph.Write(unlit, lit);
+		m_graph.WriteDepth(unlit, depth);
+
+		unsigned int present = m_graph.AddPass("Present", [lit, width, height](RenderGraph& pGraph)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, pGraph.GetFramebuffer(lit));
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		});
+		m_graph.Read(present, lit);
+		m_graph.Write(present, RenderGraph::s_backbuffer);
+		AddHiZPass(pSnapshot, depth);
+	}
+
+	void Renderer::AddHiZPass(const FrameSnapshot& pSnapshot, RenderGraph::Target pDepth)
+	{
+		if (!pSnapshot.gpuOcclusion)
+			return;
+
+		// The backbuffer's texture is 0, which the culler copies the depth of
+		unsigned int hiz = m_graph.AddPass("HiZ", [this, &pSnapshot, pDepth](RenderGraph& pGraph)
+		{
+			m_hiz.Build(pGraph.GetTexture(pDepth), pSnapshot.viewportWidth, pSnapshot.viewportHeight, pSnapshot.viewProjection);
+			GLState::PolygonMode(pSnapshot.wireframe ? GL_LINE : GL_FILL);
+		});
+		if (pDepth != RenderGraph::s_backbuffer)
+			m_graph.Read(hiz, pDepth);
+		// Nothing is drawn to the backbuffer, but declaring it runs the pass last and keeps it from being culled
+		m_graph.Write(hiz, RenderGraph::s_backbuffer);
+	}
+
+	void Renderer::DrawItems(const FrameSnapshot& pSnapshot, DrawSet pSet)
+	{
+		// The shader a draw uses in this set, nullptr if it isn't part of it
+		auto pick = [pSet](Shader* pShader) -> Shader*
+		{
+			switch (pSet)
+			{
+				case DrawSet::Surfaces: return pShader->GetDeferredVariant();
+				case DrawSet::Unlit: return (pShader->GetDeferredVariant() == nullptr ? pShader : nullptr);
+				case DrawSet::Depth: return pShader->GetDepthVariant();
+				case DrawSet::Prepassed: return (pShader->GetDepthVariant() != nullptr ? pShader : nullptr);
+				case DrawSet::NotPrepassed: return (pShader->GetDepthVariant() == nullptr ? pShader : nullptr);
+				default: return pShader;
+			}
+		};
+
+		Shader* current = nullptr;
+		for (const DrawItem& item : pSnapshot.drawList)
+		{
+			Shader* shader = pick(item.shader);
+			if (shader == nullptr)
+				continue;
+
+			if (shader != current)
+			{
+				current = shader;
+				current->Use();
+			}
+			if (item.instanceCount > 0U)
+			{
+				DrawInstances(item.mesh, item.firstInstance, item.instanceCount, pSet == DrawSet::Depth);
+				continue;
+			}
+			current->SetMat4("u_model", item.model);
+			if (pSet == DrawSet::Depth)
+			{
+				item.mesh->DrawDepth();
+				continue;
+			}
+			current->SetMat3("u_transposeInverseOfModel", item.normalMatrix);
+			item.mesh->Draw(current);
+		}
+	}
+
+	void Renderer::DrawInstances(Mesh* pMesh, unsigned int pFirst, unsigned int pCount, bool pDepth)
+	{
+		unsigned int buffer = m_hiz.GetDrawBuffer(m_instanceVBO, pFirst);
+		if (pDepth)
+			pMesh->DrawDepthInstanced(buffer, pFirst, pCount);
+		else
+			pMesh->DrawInstanced(buffer, pFirst, pCount);
+	}
+
+	void Renderer::UploadFrameUniforms(const FrameSnapshot& pSnapshot)
+	{
+		FrameUniforms uniforms;
+		uniforms.view = pSnapshot.view;
+		uniforms.projection = pSnapshot.projection;
+		uniforms.viewProjection = pSnapshot.viewProjection;
+		uniforms.viewPosition = pSnapshot.viewPosition;
+		uniforms.time = (float)pSnapshot.time;
+		if (pSnapshot.clusters.enabled && pSnapshot.viewportWidth > 0U && pSnapshot.viewportHeight > 0U)
+		{
+			glm::vec2 slices = LightClusters::GetSliceScaleBias();
+			uniforms.clusterCount = glm::uvec4(LightClusters::s_tilesX, LightClusters::s_tilesY, LightClusters::s_slices, 1U);
+			uniforms.clusterScale = vec4((float)LightClusters::s_tilesX / pSnapshot.viewportWidth,
+				(float)LightClusters::s_tilesY / pSnapshot.viewportHeight, slices.x, slices.y);
+		}
+
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_frameUBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+	}
+
+	void Renderer::SetViewport(unsigned int pWidth, unsigned int pHeight)
+	{
+		m_viewportWidth = pWidth;
+		m_viewportHeight = pHeight;
+		m_dirty = true;
+	}
+
+	void Renderer::SetWireframe(bool pValue)
+	{
+		if (m_wireframe == pValue)
+			return;
+
+		m_wireframe = pValue;
+		m_dirty = true;
+	}
+
+	bool Renderer::NeedsDraw(double pTime) const
+	{
+		if (!m_renderOnDemand || m_dirty || GetAnimating())
+			return true;
+
+		if (m_cameraRef->GetDirty() || m_lights.GetDirty())
+			return true;
+
+		return GetTimeUntilKeepAlive(pTime) <= 0.0;
+	}
+
+	double Renderer::GetTimeUntilKeepAlive(double pTime) const
+	{
+		if (m_keepAlive <= 0.0)
+			return std::numeric_limits<double>::infinity();
+
+		double remaining = m_keepAlive - (pTime - m_lastDrawTime);
+		return (remaining > 0.0 ? remaining : 0.0);
+	}
+
+	void Renderer::StartClock(double pTime)
+	{
+		m_lastDrawTime = pTime;
+		m_animationTime = 0.0;
+	}
+
+	void Renderer::SetRenderOnDemand(bool pValue, double pKeepAlive)
+	{
+		m_renderOnDemand = pValue;
+		m_keepAlive = pKeepAlive;
+		m_dirty = true;
+	}
+
+	void Renderer::SetAnimating(bool pValue)
+	{
+		m_animationPaused = !pValue;
+		m_dirty = true;
+	}
+
 	void Renderer::CreateModelScene()
 	{
 		m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/backpack"));
+		// Writes the g-buffer while deferred shading
+		m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/cube", "assets/shaders/gbuffer"));
+		GetShaderAt(0U)->SetDeferredVariant(GetShaderAt(1U));
+		GetShaderAt(1U)->Use();
+		GetShaderAt(1U)->SetFloat("u_material.shininess", 32.0f);
 		m_model = new Model((char*)"assets/models/backpack/backpack.obj");
+		m_pvsPath = "assets/models/backpack/backpack.obj.pvs";
+		m_dirty = true;
+	}
+
+	void Renderer::CreateDeferredPasses()
+	{
+		m_directionalPass = make_unique<Shader>("assets/shaders/deferredDirectional");
+		m_lightVolumePass = make_unique<Shader>("assets/shaders/deferredLights");
+		Shader* passes[2] = { m_directionalPass.get(), m_lightVolumePass.get() };
+		for (Shader* pass : passes)
+		{
+			pass->Use();
+			pass->SetInt("u_gAlbedoSpec", (int)s_albedoSpecUnit);
+			pass->SetInt("u_gNormal", (int)s_normalUnit);
+			pass->SetInt("u_gDepth", (int)s_depthUnit);
+		}
+		glGenVertexArrays(1, &m_emptyVAO);
+
+		// Unlike the box mesh every face is wound outwards, so culling front faces leaves only the far side
+		vector<Vertex> corners = vector<Vertex>(8);
+		for (unsigned int i = 0; i < 8U; ++i)
+			corners[i].position = vec3((i & 1U) ? 0.5f : -0.5f, (i & 2U) ? 0.5f : -0.5f, (i & 4U) ? 0.5f : -0.5f);
+		vector<unsigned int> faces = {
+			0, 4, 6, 0, 6, 2,	// -x
+			5, 1, 3, 5, 3, 7,	// +x
+			0, 1, 5, 0, 5, 4,	// -y
+			3, 2, 6, 3, 6, 7,	// +y
+			1, 0, 2, 1, 2, 3,	// -z
+			4, 5, 7, 4, 7, 6	// +z
+		};
+		m_lightVolume = make_unique<Mesh>(corners, faces);
 	}
 
 	Shader* Renderer::GetShaderAt(unsigned int pPos)
@@ -107,6 +608,242 @@ namespace Engine
 		return (*m_shaders.get())[pPos].get();
 	}
 
+	void Renderer::SubmitOpaque(const DrawItem& pItem, const FrameSnapshot& pSnapshot)
+	{
+		const AABB& bounds = pItem.mesh->GetBounds();
+		if (!bounds.IsEmpty())
+		{
+			// Held back until the whole scene is in, so the boxes are tested in batches
+			m_cullBoxes.push_back(bounds.Transformed(pItem.model));
+			m_culler.Add(m_cullBoxes.back());
+			m_cullItems.push_back(pItem);
+			return;
+		}
+
+		float depth = -(pSnapshot.view * pItem.model[3]).z;
+		m_renderQueue.Submit(pItem, RenderPass::Opaque, (depth > 0.0f ? depth : 0.0f));
+	}
+
+	void Renderer::QueueVisible(const FrameSnapshot& pSnapshot)
+	{
+		m_culler.Cull();
+		m_cullVisible.resize(m_cullItems.size());
+		for (unsigned int i = 0; i < m_cullItems.size(); ++i)
+			m_cullVisible[i] = (m_culler.IsVisible(i) ? 1U : 0U);
+
+		// Only what survived the frustum is tested against the occluders
+		if (m_occlusionCulling)
+		{
+			m_occlusion.Rasterise(m_workers);
+			m_occlusion.Test(m_cullBoxes.data(), (unsigned int)m_cullBoxes.size(), m_cullVisible.data(), m_workers);
+		}
+
+		for (unsigned int i = 0; i < m_cullItems.size(); ++i)
+		{
+			if (m_cullVisible[i] == 0U)
+				continue;
+
+			float depth = -(pSnapshot.view * m_cullItems[i].model[3]).z;
+			m_renderQueue.Submit(m_cullItems[i], RenderPass::Opaque, (depth > 0.0f ? depth : 0.0f));
+		}
+	}
+
+	unsigned int Renderer::FindPvsCell(const FrameSnapshot& pSnapshot)
+	{
+		if (!m_pvs.GetBaked())
+		{
+			vector<PotentiallyVisibleSet::Object> objects;
+			GetPvsObjects(objects);
+			// Baking takes seconds, so it is only done offline with --bake-pvs
+			if (!m_pvs.Load(m_pvsPath, objects))
+			{
+				std::fprintf(stderr, "No potentially visible sets baked for this scene in \"%s\", run with --bake-pvs first. "
+					"Culling with them is off\n", m_pvsPath.c_str());
+				m_pvsCulling = false;
+				return PotentiallyVisibleSet::s_noCell;
+			}
+		}
+		return m_pvs.FindCell(pSnapshot.viewPosition);
+	}
+
+	void Renderer::GetPvsObjects(vector<PotentiallyVisibleSet::Object>& pObjects)
+	{
+		pObjects.clear();
+		#ifdef LEGACY
+		 // The boxes spin about their centres, so only a box shrunk to fit inside them at every angle blocks rays,
+		 // and each can be seen anywhere a corner could reach. The box mesh fills its bounds
+		 const AABB& box = GetMeshAt(0U)->GetBounds();
+		 vec3 inner = glm::min(-box.min, box.max);
+		 float outer = glm::length(glm::max(-box.min, box.max));
+		 for (const vec3& position : m_boxPositions)
+		 {
+		 	PotentiallyVisibleSet::Object object;
+		 	object.mesh = GetMeshAt(0U);
+		 	object.model = glm::scale(glm::translate(mat4(1.0f), position), vec3(std::min(std::min(inner.x, inner.y), inner.z) / outer));
+		 	object.bounds.min = position - vec3(outer);
+		 	object.bounds.max = position + vec3(outer);
+		 	pObjects.push_back(object);
+		 }
+		#else
+		 for (unsigned int i = 0; i < m_model->GetMeshCount(); ++i)
+		 {
+		 	PotentiallyVisibleSet::Object object;
+		 	object.mesh = m_model->GetMeshAt(i);
+		 	object.bounds = object.mesh->GetBounds();
+		 	pObjects.push_back(object);
+		 }
+		#endif
+	}
+
+	void Renderer::MergeInstances(FrameSnapshot& pSnapshot)
+	{
+		vector<DrawItem>& items = pSnapshot.drawList;
+		size_t write = 0U;
+		for (size_t read = 0U; read < items.size();)
+		{
+			// Textures belong to the mesh so a shared mesh is a shared material, the sort already put copies together
+			size_t end = read + 1U;
+			while (end < items.size() && items[end].mesh == items[read].mesh && items[end].shader == items[read].shader)
+				++end;
+
+			Shader* instanced = items[read].shader->GetInstancedVariant();
+			if (instanced != nullptr && end - read >= s_minInstances)
+			{
+				DrawItem merged = items[read];
+				merged.shader = instanced;
+				merged.firstInstance = (unsigned int)pSnapshot.instances.size();
+				merged.instanceCount = (unsigned int)(end - read);
+				for (size_t i = read; i < end; ++i)
+					pSnapshot.instances.push_back(items[i].model);
+				items[write++] = merged;
+			}
+			else
+			{
+				for (size_t i = read; i < end; ++i)
+				{
+					items[i].normalMatrix = mat3(glm::transpose(glm::inverse(items[i].model)));
+					items[write++] = items[i];
+				}
+			}
+			read = end;
+		}
+		items.resize(write);
+	}
+
+	void Renderer::SetBoxCount(unsigned int pCount)
+	{
+		m_boxCount = pCount;
+		m_boxPositions.clear();
+		m_boxPositions.reserve(pCount);
+
+		for (unsigned int i = 0; i < pCount && i < 10U; ++i)
+			m_boxPositions.push_back(m_cubePositions[i]);
+
+		if (pCount <= 10U)
+			return;
+
+		// The rest fill a cube shaped grid behind the originals
+		unsigned int extra = pCount - 10U;
+		unsigned int side = (unsigned int)std::ceil(std::cbrt((double)extra));
+		float centre = (side - 1U) * 0.5f;
+		for (unsigned int i = 0; i < extra; ++i)
+		{
+			float x = (float)(i % side) - centre;
+			float y = (float)((i / side) % side) - centre;
+			float z = (float)(i / (side * side));
+			m_boxPositions.push_back(vec3(x * 2.0f, y * 2.0f, -20.0f - z * 2.0f));
+		}
+	}
+
+	void Renderer::SetClustered(bool pValue)
+	{
+		m_clustered = pValue;
+		m_dirty = true;
+	}
+
+	void Renderer::SetDeferred(bool pValue)
+	{
+		if (m_deferred == pValue)
+			return;
+
+		m_deferred = pValue;
+		m_dirty = true;
+	}
+
+	void Renderer::SetDepthPrepass(bool pValue)
+	{
+		if (m_depthPrepass == pValue)
+			return;
+
+		m_depthPrepass = pValue;
+		m_dirty = true;
+	}
+
+	void Renderer::SetOcclusionCulling(bool pValue)
+	{
+		if (m_occlusionCulling == pValue)
+			return;
+
+		m_occlusionCulling = pValue;
+		m_dirty = true;
+	}
+
+	void Renderer::SetGpuOcclusion(bool pValue)
+	{
+		if (m_gpuOcclusion == pValue)
+			return;
+
+		m_gpuOcclusion = pValue;
+		m_dirty = true;
+	}
+
+	void Renderer::SetPvsCulling(bool pValue)
+	{
+		if (m_pvsCulling == pValue)
+			return;
+
+		m_pvsCulling = pValue;
+		m_dirty = true;
+	}
+
+	bool Renderer::BakePvs()
+	{
+		vector<PotentiallyVisibleSet::Object> objects;
+		GetPvsObjects(objects);
+		// Cells of 4 units, reaching 8 past the scene so the camera can back away from it
+		return m_pvs.Bake(objects, 4.0f, 8.0f, m_workers) && m_pvs.Save(m_pvsPath);
+	}
+
+	void Renderer::SetPointLightCount(unsigned int pCount)
+	{
+		m_pointLightCount = pCount;
+		// The lights are made in Init, until then only the count is kept
+		if (m_lightPoint == nullptr)
+			return;
+
+		for (unique_ptr<Light>& light : m_extraLights)
+			m_lights.Remove(light.get());
+		m_extraLights.clear();
+
+		// A fixed seed so every run lights the scene the same way
+		uint32_t seed = 12345U;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525U + 1013904223U;
+			return (float)(seed >> 8) / (float)(1U << 24);
+		};
+		for (unsigned int i = 1; i < pCount && i < LightRegistry::s_maxPointLights; ++i)
+		{
+			vec4 position = vec4(random() * 16.0f - 8.0f, random() * 10.0f - 5.0f, random() * -30.0f + 2.0f, 1.0f);
+			vec3 colour = vec3(0.2f) + vec3(random(), random(), random()) * 0.6f;
+			m_extraLights.push_back(make_unique<Light>(LightType::Point, position, colour));
+			// Falls off quickly so each light only reaches a few clusters
+			m_extraLights.back()->SetAttenuation(0.7f, 1.8f);
+			m_lights.Add(m_extraLights.back().get());
+		}
+		m_dirty = true;
+	}
+
 	#ifdef LEGACY
 	 void Renderer::CreateBoxScene()
 	 {
@@ -128,83 +865,124 @@ namespace Engine
  
 	 	m_meshes.get()->push_back(make_unique<Mesh>(Mesh::GenerateVertices(), Mesh::GenerateIndices(), textures));
 
-	 	GetMeshAt(0U)->LoadTextures(*GetShaderAt(0U));
-	 	GetShaderAt(0U)->SetFloat("u_material.shininess", 32.0f);
-
 	 	#pragma region Lights
-	 	 // Directional
-	 	 GetShaderAt(0U)->SetVec3("u_directional.colour.ambient", m_lightDirectional->GetColour() * 0.15f);
-	 	 GetShaderAt(0U)->SetVec3("u_directional.colour.diffuse", m_lightDirectional->GetColour());
-	 	 GetShaderAt(0U)->SetVec3("u_directional.colour.specular", m_lightDirectional->GetColour());
-	 	 GetShaderAt(0U)->SetVec4("u_directional.direction", m_lightDirectional->GetDirection());
-
-	 	 // Point
-	 	 //GetShaderAt(0U)->SetVec3("u_pointLights[0].colour.ambient", m_lightPoint->GetColour() * 0.15f);
-	 	 GetShaderAt(0U)->SetVec3("u_pointLights[0].colour.diffuse", m_lightPoint->GetColour());
-	 	 GetShaderAt(0U)->SetVec3("u_pointLights[0].colour.specular", m_lightPoint->GetColour());
-	 	 GetShaderAt(0U)->SetVec4("u_pointLights[0].position", m_lightPoint->GetPosition());
-	 	 GetShaderAt(0U)->SetFloat("u_pointLights[0].linear", 0.045f);
-	 	 GetShaderAt(0U)->SetFloat("u_pointLights[0].quadratic", 0.0075f);
-
-	 	 // Spot
-	 	 //GetShaderAt(0U)->SetVec3("u_spotLights[0].colour.ambient", m_lightSpot->GetColour() * 0.15f);
-	 	 GetShaderAt(0U)->SetVec3("u_spotLights[0].colour.diffuse", m_lightSpot->GetColour());
-	 	 GetShaderAt(0U)->SetVec3("u_spotLights[0].colour.specular", m_lightSpot->GetColour());
-	 	 GetShaderAt(0U)->SetVec4("u_spotLights[0].position", m_lightSpot->GetPosition());
-	 	 GetShaderAt(0U)->SetVec4("u_spotLights[0].direction", m_lightSpot->GetDirection());
-	 	 GetShaderAt(0U)->SetFloat("u_spotLights[0].linear", 0.045f);
-	 	 GetShaderAt(0U)->SetFloat("u_spotLights[0].quadratic", 0.0075f);
-	 	 GetShaderAt(0U)->SetFloat("u_spotLights[0].cutoff", m_lightSpot->GetAngle());
-	 	 GetShaderAt(0U)->SetFloat("u_spotLights[0].blur", m_lightSpot->GetBlur());
-
 	 	 // Point light cube
 	 	 m_meshes.get()->push_back(make_unique<Mesh>(Mesh::GenerateVertices(), Mesh::GenerateIndices()));
 	 	 m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/light"));
 	 	 GetMeshAt(1U)->LoadTextures(*GetShaderAt(1U));
-	 	 GetShaderAt(1U)->SetVec3("u_colour", m_lightPoint->GetColour());
-	 	 mat4 lightModel = mat4(1.0f);
-	 	 lightModel = glm::translate(lightModel, vec3(m_lightPoint->GetPosition()));
-	 	 GetShaderAt(1U)->SetMat4("u_model", (mat4)lightModel);
 
 	 	 // Spot light cube
 	 	 m_meshes.get()->push_back(make_unique<Mesh>(Mesh::GenerateVertices(), Mesh::GenerateIndices()));
 	 	 m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/light"));
 	 	 GetMeshAt(2U)->LoadTextures(*GetShaderAt(2U));
-	 	 GetShaderAt(2U)->SetVec3("u_colour", m_lightSpot->GetColour());
-	 	 lightModel = mat4(1.0f);
-	 	 lightModel = glm::translate(lightModel, vec3(m_lightSpot->GetPosition()));
-	 	 GetShaderAt(2U)->SetMat4("u_model", (mat4)lightModel);
 	 	#pragma endregion
+
+	 	// Draws every box in one call, with the same fragment shader as the regular box shader
+	 	m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/cubeInstanced", "assets/shaders/cube"));
+	 	GetShaderAt(0U)->SetInstancedVariant(GetShaderAt(3U));
+
+	 	// Write the g-buffer instead while deferred shading, one for each of the above
+	 	m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/cube", "assets/shaders/gbuffer"));
+	 	m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/cubeInstanced", "assets/shaders/gbuffer"));
+	 	GetShaderAt(0U)->SetDeferredVariant(GetShaderAt(4U));
+	 	GetShaderAt(3U)->SetDeferredVariant(GetShaderAt(5U));
+
+	 	// Only place the vertices, for the depth pre-pass
+	 	m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/depth"));
+	 	m_shaders.get()->push_back(make_unique<Shader>("assets/shaders/depthInstanced", "assets/shaders/depth"));
+	 	GetShaderAt(0U)->SetDepthVariant(GetShaderAt(6U));
+	 	GetShaderAt(3U)->SetDepthVariant(GetShaderAt(7U));
+
+	 	Shader* boxShaders[4] = { GetShaderAt(0U), GetShaderAt(3U), GetShaderAt(4U), GetShaderAt(5U) };
+	 	for (Shader* shader : boxShaders)
+	 	{
+	 		shader->Use();
+	 		GetMeshAt(0U)->LoadTextures(*shader);
+	 		shader->SetFloat("u_material.shininess", 32.0f);
+	 		// Given units of their own, samplers left on unit 0 would clash with the box's textures
+	 		shader->SetInt("u_clusterGrid", (int)LightClusters::s_gridUnit);
+	 		shader->SetInt("u_clusterIndices", (int)LightClusters::s_indexUnit);
+	 	}
+	 	SetBoxCount(m_boxCount);
+	 	m_pvsPath = "assets/boxes.pvs";
+
+	 	// The boxes spin
+	 	m_hasAnimation = true;
+	 	m_dirty = true;
 	 }
 
-	 void Renderer::RenderBoxScene(double pTime)
+	 void Renderer::CreateBoxEntities()
 	 {
-	 	for (unsigned int i = 0; i < m_meshes.get()->size(); ++i)
+	 	m_boxTree.Clear();
+	 	// The sets were baked for the boxes before
+	 	m_pvs.Clear();
+	 	m_boxes.clear();
+	 	m_boxes.reserve(m_boxPositions.size());
+	 	for (unsigned int j = 0; j < m_boxPositions.size(); j++)
 	 	{
-	 		glBindVertexArray(*GetMeshAt(i)->GetVAO());
-	 		GetShaderAt(i)->Use();
-	 		GetShaderAt(i)->SetMat4("u_camera", m_cameraRef->GetWorldToCameraMatrix());
-	 		GetShaderAt(i)->SetVec3("u_viewPos", m_cameraRef->GetPosition());
-			// I don't like updating this every frame but I don't really have a choice
-			GetShaderAt(0U)->SetFloat("u_spotLights[0].cutoff", m_lightSpot->GetAngle());
-			GetShaderAt(0U)->SetFloat("u_spotLights[0].blur", m_lightSpot->GetBlur());
-	 		if (i > 0)
-	 			GetMeshAt(i)->Draw(GetShaderAt(i));
-	 		else
+	 		unique_ptr<Entity> box = make_unique<Entity>();
+	 		box->SetMesh(GetMeshAt(0U));
+	 		box->SetPosition(m_boxPositions[j]);
+	 		box->SetTreeLeaf(m_boxTree.Insert(box->GetWorldBounds(), j));
+	 		box->SetOccluder(true);
+	 		box->ClearDirty();
+	 		m_boxes.push_back(std::move(box));
+	 	}
+	 }
+
+	 void Renderer::BuildBoxScene(FrameSnapshot& pSnapshot)
+	 {
+	 	if (m_boxes.size() != m_boxPositions.size())
+	 		CreateBoxEntities();
+
+	 	for (unsigned int j = 0; j < m_boxes.size(); j++)
+	 	{
+	 		Entity& box = *m_boxes[j];
+	 		mat4 model = glm::translate(mat4(1.0f), m_boxPositions[j]);
+	 		float angle = (float)m_animationTime * 5.0f * ((j + 1) / (j * 0.2f + 1));
+	 		box.SetTransform(glm::rotate(model, glm::radians(angle), vec3(1.0f, 0.3f, 0.5f)));
+	 		// Most frames the spun box still fits the margin of its leaf and the tree is untouched
+	 		if (box.GetWorldDirty())
 	 		{
-	 			for (unsigned int j = 0; j < 10; j++)
-	 			{
-	 				mat4 model = mat4(1.0f);
-	 				model = glm::translate(model, m_cubePositions[j]);
-	 				float angle = (float)pTime * 5.0f * ((j + 1) / (j * 0.2f + 1));
-	 				model = glm::rotate(model, glm::radians(angle), vec3(1.0f, 0.3f, 0.5f));
-	 				GetShaderAt(0U)->SetMat4("u_model", (mat4)model);
-	 				mat3 transposeInverseOfModel = mat3(glm::transpose(glm::inverse(model)));
-	 				GetShaderAt(0U)->SetMat3("u_transposeInverseOfModel", (mat3)transposeInverseOfModel);
-	 				GetMeshAt(i)->Draw(GetShaderAt(i));
-	 			}
+	 			m_boxTree.Move(box.GetTreeLeaf(), box.GetWorldBounds());
+	 			box.ClearDirty();
 	 		}
 	 	}
+
+	 	// Whole branches outside the frustum are skipped, the boxes found are culled exactly with everything else
+	 	m_treeResults.clear();
+	 	m_boxTree.QueryFrustum(m_culler, m_treeResults);
+	 	if (m_pvsCulling)
+	 		m_pvs.Filter(FindPvsCell(pSnapshot), m_treeResults);
+	 	for (unsigned int j : m_treeResults)
+	 	{
+	 		DrawItem item;
+	 		item.mesh = m_boxes[j]->GetMesh();
+	 		item.shader = GetShaderAt(0U);
+	 		item.model = m_boxes[j]->GetWorldTransform();
+	 		if (m_occlusionCulling && m_boxes[j]->IsOccluder())
+	 			m_occlusion.AddOccluder(item.mesh, item.model);
+	 		SubmitOpaque(item, pSnapshot);
+	 	}
+
+	 	// Light cubes sit on their lights
+	 	const LightState* lights[2] = { &pSnapshot.point, &pSnapshot.spot };
+	 	for (unsigned int i = 1; i < m_meshes.get()->size(); ++i)
+	 	{
+	 		DrawItem item;
+	 		item.mesh = GetMeshAt(i);
+	 		item.shader = GetShaderAt(i);
+	 		item.model = glm::translate(item.model, vec3(lights[i - 1]->position));
+	 		SubmitOpaque(item, pSnapshot);
+	 	}
+	 }
+
+	 void Renderer::UploadLightCubes(const FrameSnapshot& pSnapshot)
+	 {
+	 	GetShaderAt(1U)->Use();
+	 	GetShaderAt(1U)->SetVec3("u_colour", pSnapshot.point.colour);
+	 	GetShaderAt(2U)->Use();
+	 	GetShaderAt(2U)->SetVec3("u_colour", pSnapshot.spot.colour);
 	 }
 
 	 Mesh* Renderer::GetMeshAt(unsigned int pPos)
@@ -2,6 +2,18 @@
 #pragma once
 #include "Model.hpp"
 #include "Light.hpp"
+#include "RenderQueue.hpp"
+#include "FrameUniforms.hpp"
+#include "LightRegistry.hpp"
+#include "LightClusters.hpp"
+#include "WorkerPool.hpp"
+#include "RenderGraph.hpp"
+#include "FrustumCuller.hpp"
+#include "OcclusionCuller.hpp"
+#include "HiZCuller.hpp"
+#include "BoundsTree.hpp"
+#include "PotentiallyVisibleSet.hpp"
+#include "Entity.hpp"
 #define LEGACY
 #pragma endregion
 
@@ -43,11 +55,146 @@ namespace Engine
 		/**
 		 * @brief Draws the scene
 		 *
-		 * @param pCamera TEMPORARY! The viewprojection matrix used as the camera
 		 * @param pTime TEMPORARY! Used for basic shape animation
 		 * @remark Only Application is able to call this function
 		 */
 		void Draw(double pTime);
+		/**
+		 * @brief Captures everything needed to draw the frame, advances animations and clears the dirty flags.
+		 * Makes no gl calls so it can run on the game thread while the previous snapshot is drawn
+		 *
+		 * @param pSnapshot The snapshot to fill, its draw list keeps its capacity between frames
+		 * @param pTime The current time
+		 */
+		void BuildSnapshot(FrameSnapshot& pSnapshot, double pTime);
+		/**
+		 * @brief Submits a snapshot to the gpu, must be called on the thread that owns the context
+		 *
+		 * @param pSnapshot The snapshot to draw, only read
+		 */
+		void DrawSnapshot(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Writes the camera and time of a snapshot to the uniform buffer every shader reads them from
+		 *
+		 * @param pSnapshot The snapshot being drawn
+		 */
+		void UploadFrameUniforms(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Adds the passes that draw the scene straight to the backbuffer, after a depth pre-pass if it is on
+		 *
+		 * @param pSnapshot The snapshot being drawn, its uniforms and instances already uploaded
+		 */
+		void AddForwardPasses(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Adds the passes that draw the g-buffer, light it with a fullscreen pass then the light volumes,
+		 * draw anything without a g-buffer shader forward on top and copy the result to the backbuffer
+		 *
+		 * @param pSnapshot The snapshot being drawn, its uniforms and instances already uploaded
+		 */
+		void AddDeferredPasses(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Adds the pass that builds the depth pyramid for the next frame's gpu culling, if it is on
+		 *
+		 * @param pSnapshot The snapshot being drawn
+		 * @param pDepth The target the frame's depth ends up in
+		 */
+		void AddHiZPass(const FrameSnapshot& pSnapshot, RenderGraph::Target pDepth);
+
+		// Which of a snapshot's draws a pass makes, and with which shader
+		enum class DrawSet : uint8_t
+		{
+			All,		// Every draw with its own shader
+			Surfaces,	// Only draws with a deferred variant, drawn with it
+			Unlit,		// Only draws without a deferred variant
+			Depth,		// Only draws with a depth variant, drawn with it from the positions only
+			Prepassed,	// Only draws with a depth variant, with their own shader
+			NotPrepassed	// Only draws without a depth variant
+		};
+		/**
+		 * @brief Draws the draw list of a snapshot
+		 *
+		 * @param pSnapshot The snapshot being drawn
+		 * @param pSet Which draws to make
+		 */
+		void DrawItems(const FrameSnapshot& pSnapshot, DrawSet pSet);
+		/**
+		 * @brief Draws a range of instances, from the culled copies when the gpu culled them
+		 *
+		 * @param pMesh The mesh
+		 * @param pFirst The first instance
+		 * @param pCount The amount of instances
+		 * @param pDepth Whether to draw from the positions only
+		 */
+		void DrawInstances(Mesh* pMesh, unsigned int pFirst, unsigned int pCount, bool pDepth);
+		/**
+		 * @brief Draws depth for everything that can be pre-passed, counting the fragments that pass
+		 *
+		 * @param pSnapshot The snapshot being drawn
+		 */
+		void DrawPrepassDepth(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Shades the pre-passed draws where the depth is equal, then draws the rest normally. Counts the
+		 * fragments shaded to see how many the pre-pass saved
+		 *
+		 * @param pSnapshot The snapshot being drawn
+		 */
+		void DrawPrepassShading(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Creates the light pass shaders and the volume every point and spot light is drawn as
+		 */
+		void CreateDeferredPasses();
+		/**
+		 * @brief Sets the area drawn to, applied by the next snapshot
+		 *
+		 * @param pWidth The width in pixels
+		 * @param pHeight The height in pixels
+		 */
+		void SetViewport(unsigned int pWidth, unsigned int pHeight);
+		/**
+		 * @brief Draws triangles as lines, applied by the next snapshot
+		 *
+		 * @param pValue Whether wireframe is enabled
+		 */
+		void SetWireframe(bool pValue);
+		/**
+		 * @brief Whether anything visible has changed since the last draw, always true unless
+		 * render on demand is enabled
+		 *
+		 * @param pTime The current time, used for the keepalive
+		 * @return If Draw and the buffer swap should happen this frame
+		 */
+		bool NeedsDraw(double pTime) const;
+		/**
+		 * @brief How long until the keepalive forces a redraw
+		 *
+		 * @param pTime The current time
+		 * @return The time in seconds, 0 if a draw is already due or infinity without a keepalive
+		 */
+		double GetTimeUntilKeepAlive(double pTime) const;
+		/**
+		 * @brief Starts the animations from zero at a time, so a replay animates the same as its recording
+		 *
+		 * @param pTime The time the first frame's delta is measured from
+		 */
+		void StartClock(double pTime);
+		/**
+		 * @brief Only draw when the camera, a light, a model or an animation changes the image
+		 *
+		 * @param pValue Whether render on demand is enabled
+		 * @param pKeepAlive The longest time in seconds to go without drawing regardless, 0 for no limit
+		 */
+		void SetRenderOnDemand(bool pValue, double pKeepAlive);
+		/**
+		 * @brief Pauses or resumes scene animations, a running animation redraws every frame
+		 *
+		 * @param pValue Whether animations are running
+		 */
+		void SetAnimating(bool pValue);
+		bool GetAnimating() const { return m_hasAnimation && !m_animationPaused; }
+		/**
+		 * @brief Forces the next frame to be drawn, for changes the renderer can't see such as gl state
+		 */
+		void MarkDirty() { m_dirty = true; }
 
 		void CreateModelScene();
 
@@ -58,14 +205,165 @@ namespace Engine
 		 * @return Shader* The pointer to the shader object
 		 */
 		Shader* GetShaderAt(unsigned int pPos);
+		/**
+		 * @brief Queues an item with its view depth taken from the model's translation, once it is known to be
+		 * inside the view frustum
+		 *
+		 * @param pItem The item to draw
+		 * @param pSnapshot The snapshot being built, for the view matrix
+		 */
+		void SubmitOpaque(const DrawItem& pItem, const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Culls every item submitted this frame against the view frustum and queues the ones left
+		 *
+		 * @param pSnapshot The snapshot being built, for the view matrix
+		 */
+		void QueueVisible(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief The camera's cell of the static scene's potentially visible sets, loading them first. Sets that
+		 * were never baked for this scene turn the culling off rather than being baked mid-frame
+		 *
+		 * @param pSnapshot The snapshot being built, for the camera's position
+		 * @return The cell, or PotentiallyVisibleSet::s_noCell outside the grid
+		 */
+		unsigned int FindPvsCell(const FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Lists what the potentially visible sets are baked for, the static scene's meshes
+		 *
+		 * @param pObjects Filled with the objects
+		 */
+		void GetPvsObjects(vector<PotentiallyVisibleSet::Object>& pObjects);
+		/**
+		 * @brief Merges runs of consecutive items that share a mesh and shader into instanced draws, and works out
+		 * the normal matrix of the items left on their own
+		 *
+		 * @param pSnapshot The snapshot with its draw list already sorted
+		 */
+		void MergeInstances(FrameSnapshot& pSnapshot);
+		/**
+		 * @brief Sets how many boxes the box scene has, past the first ten they are laid out in a grid
+		 *
+		 * @param pCount The amount of boxes
+		 */
+		void SetBoxCount(unsigned int pCount);
+		/**
+		 * @brief Shades with only the lights binned into each fragment's cluster instead of every light
+		 *
+		 * @param pValue Whether clustered shading is on
+		 */
+		void SetClustered(bool pValue);
+		/**
+		 * @brief Sets how many point lights light the scene, past the first they are scattered through the boxes
+		 *
+		 * @param pCount The amount of point lights, capped at LightRegistry::s_maxPointLights
+		 */
+		void SetPointLightCount(unsigned int pCount);
+		/**
+		 * @brief Switches between lighting every surface as it is drawn and lighting the g-buffer afterwards
+		 *
+		 * @param pValue Whether deferred shading is on
+		 */
+		void SetDeferred(bool pValue);
+		/**
+		 * @brief Lays down depth for the scene before shading it, so only the nearest surface of each pixel is
+		 * shaded. Only applies to forward shading
+		 *
+		 * @param pValue Whether the depth pre-pass is on
+		 */
+		void SetDepthPrepass(bool pValue);
+		/**
+		 * @brief Draws the occluders into a small depth buffer on the cpu and skips items hidden behind them
+		 *
+		 * @param pValue Whether occlusion culling is on
+		 */
+		void SetOcclusionCulling(bool pValue);
+		/**
+		 * @brief Culls instanced copies on the gpu against a depth pyramid of the frame before
+		 *
+		 * @param pValue Whether gpu occlusion culling is on
+		 */
+		void SetGpuOcclusion(bool pValue);
+		/**
+		 * @brief Skips whatever can't be seen from the camera's cell of a grid, using sets baked for the static scene
+		 *
+		 * @param pValue Whether potentially visible sets are used
+		 */
+		void SetPvsCulling(bool pValue);
+		/**
+		 * @brief Bakes the static scene's potentially visible sets and stores them next to it, for SetPvsCulling
+		 *
+		 * @return If the sets were baked and written
+		 */
+		bool BakePvs();
+		/**
+		 * @brief Prints how many fragments the depth pre-pass kept from being shaded
+		 */
+		void PrintPrepassReport() const;
 
 		Camera* m_cameraRef = nullptr;	// A reference to a camera
+
+		bool m_renderOnDemand = false;	// Skip drawing frames where nothing has changed
+		bool m_dirty = true;			// Changes not tracked by a Transform, such as loading a model
+		bool m_hasAnimation = false;	// If the scene has any animations at all
+		bool m_animationPaused = false;	// Animations are frozen and don't cause redraws
+		double m_keepAlive = 1.0;		// Seconds between forced redraws while on demand
+		double m_lastDrawTime = 0.0;
+		double m_animationTime = 0.0;	// Time that only advances while animating
+		unsigned int m_viewportWidth = 0U, m_viewportHeight = 0U;
+		bool m_wireframe = false;
+		FrameSnapshot m_snapshot;		// Used by Draw() when there is no render thread
+		RenderQueue m_renderQueue;		// Sorts each snapshot's draw list, only used while building
+		FrustumCuller m_culler;			// Tests the submitted items' boxes, only used while building
+		vector<DrawItem> m_cullItems;	// The items submitted this frame, in the order they were added to the culler
+		vector<AABB> m_cullBoxes;		// The world bounds of each of m_cullItems
+		vector<uint8_t> m_cullVisible;	// Which of m_cullItems passed every test
+		OcclusionCuller m_occlusion;	// Drawn from the occluders found each frame, only used while building
+		bool m_occlusionCulling = false;
+		PotentiallyVisibleSet m_pvs;	// Loaded the first time it is needed, only used while building
+		string m_pvsPath;				// Where the sets are stored, next to the scene they were baked for
+		bool m_pvsCulling = false;
+
+		// Gl state last applied by DrawSnapshot, only touched by the thread that owns the context
+		unsigned int m_appliedWidth = 0U, m_appliedHeight = 0U;
+		unsigned int m_instanceVBO = 0U;	// Refilled with the snapshot's instances every frame
+		size_t m_instanceCapacity = 0U;		// How many matrices the instance buffer has room for
+		unsigned int m_frameUBO = 0U;		// Holds FrameUniforms, bound to its binding point for good
 		Model* m_model = nullptr;
 		unique_ptr<vector<unique_ptr<Shader>>> m_shaders;
 
 		Light* m_lightDirectional = nullptr;
 		Light* m_lightPoint = nullptr;
 		Light* m_lightSpot = nullptr;
+		LightRegistry m_lights;			// Every light shaded, packed for the gpu
+		vector<unique_ptr<Light>> m_extraLights;	// The point lights added past the first for stress testing
+		unsigned int m_pointLightCount = 1U;
+		LightClusters m_clusters;		// Which lights reach each part of the view, when clustered
+		bool m_clustered = false;
+		WorkerPool m_workers;			// Shares out the light binning
+		bool m_deferred = false;
+		RenderGraph m_graph;			// Rebuilt with the passes of every snapshot drawn
+		static const unsigned int s_albedoSpecUnit = 11U;	// Texture units the light passes read the g-buffer from
+		static const unsigned int s_normalUnit = 12U;
+		static const unsigned int s_depthUnit = 13U;
+		unique_ptr<Shader> m_directionalPass, m_lightVolumePass;
+		unique_ptr<Mesh> m_lightVolume;	// A unit cube wound outwards, scaled to each light's range
+		unsigned int m_emptyVAO = 0U;	// Bound for the fullscreen pass, which has no vertex data
+
+		// Fragments passed by the depth pre-pass and by the shading pass after it, counted a few frames
+		// behind so reading them never waits on the gpu
+		struct PrepassQueries
+		{
+			unsigned int depth = 0U, shaded = 0U;
+			bool pending = false;
+		};
+		static const unsigned int s_prepassQueryFrames = 3U;
+		bool m_depthPrepass = false;
+		PrepassQueries m_prepassQueries[s_prepassQueryFrames];
+		unsigned int m_prepassFrame = 0U;
+		unsigned long long m_prepassFrames = 0ULL, m_prepassDepthSamples = 0ULL, m_prepassShadedSamples = 0ULL;
+
+		HiZCuller m_hiz;				// Only touched by the thread that owns the context
+		bool m_gpuOcclusion = false;
 
 		const vec3 m_cubePositions[10] = {
 			glm::vec3(0.0f,  0.0f,  0.0f),
@@ -80,9 +378,33 @@ namespace Engine
 			glm::vec3(-1.3f,  1.0f, -1.5f)
 		};
 
+		static const unsigned int s_minInstances = 2U;	// The shortest run of copies merged into one draw
+
+		unsigned int m_boxCount = 10U;
+		vector<vec3> m_boxPositions;
+		vector<unique_ptr<Entity>> m_boxes;	// One for each position, made once the box mesh exists
+		BoundsTree m_boxTree;				// The boxes' world bounds, the user data is the box's index
+		vector<unsigned int> m_treeResults;	// Reused by every query of the tree
+
 		#ifdef LEGACY
 		 void CreateBoxScene();
-		 void RenderBoxScene(double pTime);
+		 /**
+		  * @brief Makes an entity for every box position and inserts it into the bounds tree
+		  */
+		 void CreateBoxEntities();
+		 /**
+		  * @brief Spins the boxes, moving their leaves of the tree when their bounds escape them, and submits those
+		  * the tree finds in the view frustum along with the light cubes
+		  *
+		  * @param pSnapshot The snapshot being built
+		  */
+		 void BuildBoxScene(FrameSnapshot& pSnapshot);
+		 /**
+		  * @brief Uploads the colours of the light cubes
+		  *
+		  * @param pSnapshot The snapshot holding the light state
+		  */
+		 void UploadLightCubes(const FrameSnapshot& pSnapshot);
 		 Mesh* GetMeshAt(unsigned int pPos);
 		 unique_ptr<vector<unique_ptr<Mesh>>> m_meshes;
 		#endif
@@ -1,5 +1,8 @@
 #pragma region
 #include "Shader.hpp"
+#include "GLState.hpp"
+#include "FrameUniforms.hpp"
+#include "LightRegistry.hpp"
 #include <glad/glad.h> // Include glad to get all the required OpenGL headers
 #include <glm/gtc/type_ptr.hpp>
 #include <sstream>
@@ -16,6 +19,19 @@ using glm::vec3;
 
 namespace Engine
 {
+	/**
+	 * @brief The name a type of shader is logged with
+	 */
+	static const char* GetTypeName(ShaderType pType)
+	{
+		switch (pType)
+		{
+			case ShaderType::VERTEX: return "VERTEX";
+			case ShaderType::FRAGMENT: return "FRAGMENT";
+			default: return "PROGRAM";
+		}
+	}
+
 	Shader::Shader()
 	{
 		//LoadVertexShader();
@@ -30,26 +46,44 @@ namespace Engine
 		LoadPaths(pShaderPath);
 	}
 
+	Shader::Shader(string pVertexPath, string pFragmentPath)
+	{
+		LoadPaths(pVertexPath, pFragmentPath);
+	}
+
+	Shader::Shader(string pVertexPath, const vector<string>& pFeedbackVaryings)
+	{
+		m_shaderPath = pVertexPath;
+		m_feedbackVaryings = pFeedbackVaryings;
+
+		LoadShader(ShaderType::VERTEX);
+		CreateShaderProgram();
+	}
+
 	#pragma region Copy constructors
 	Shader::Shader(const Shader& pOther)
 	{
 		m_shaderPath = pOther.m_shaderPath;
+		m_fragmentPath = pOther.m_fragmentPath;
+		m_feedbackVaryings = pOther.m_feedbackVaryings;
 	}
 	
 	Shader::Shader(Shader&& pOther) noexcept
 	{
 		m_shaderPath = pOther.m_shaderPath;
+		m_fragmentPath = pOther.m_fragmentPath;
+		m_feedbackVaryings = pOther.m_feedbackVaryings;
 	}
 	
 	Shader& Shader::operator=(const Shader& pOther)
 	{
-		Shader* newObj = new Shader(pOther.m_shaderPath);
+		Shader* newObj = new Shader(pOther.m_shaderPath, pOther.m_fragmentPath);
 		return *newObj;
 	}
 	
 	Shader& Shader::operator=(Shader&& pOther) noexcept
 	{
-		Shader* newObj = new Shader(pOther.m_shaderPath);
+		Shader* newObj = new Shader(pOther.m_shaderPath, pOther.m_fragmentPath);
 		return *newObj;
 	}
 	#pragma endregion
@@ -57,17 +91,26 @@ namespace Engine
 	void Shader::Destroy(bool pValidate)
 	{
 		if (pValidate && m_shaderLoaded)
+		{
 			glDeleteProgram(m_idProgram);
+			GLState::Invalidate();
+		}
 	}
 
 	void Shader::Use()
 	{
-		glUseProgram(m_idProgram);
+		GLState::UseProgram(m_idProgram);
 	}
 
 	void Shader::LoadPaths(string pShaderPath)
 	{
-		m_shaderPath = pShaderPath;
+		LoadPaths(pShaderPath, pShaderPath);
+	}
+
+	void Shader::LoadPaths(string pVertexPath, string pFragmentPath)
+	{
+		m_shaderPath = pVertexPath;
+		m_fragmentPath = pFragmentPath;
 
 		//LoadVertexShader();
 		//LoadFragmentShadepShaderPathr();
@@ -94,7 +137,7 @@ layout (location=2) in vec2 aTexCoord;\
 out vec3 FragPos;\
 out vec3 Normal;\
 out vec2 TexCoord;\
-uniform mat4 u_camera;\
+layout(std140) uniform FrameData{mat4 u_view;mat4 u_projection;mat4 u_camera;vec3 u_viewPos;float u_time;uvec4 u_clusterCount;vec4 u_clusterScale;};\
 uniform mat4 u_model;\
 uniform mat3 u_transposeInverseOfModel;\
 void main(){\
@@ -103,64 +146,44 @@ FragPos=vec3(u_model*vec4(aPos,1.0));\
 Normal=u_transposeInverseOfModel*aNormal;\
 TexCoord=aTexCoord;}";
 		 const char* fragmentFallback = "#version 330 core\n\
-#define normalise normalize\
-const int NR_POINT_LIGHTS=10;\
-const int NR_SPOT_LIGHTS=10;\
+const int MAX_POINT_LIGHTS=192;const int MAX_SPOT_LIGHTS=32;\
 out vec4 FragCol;\
 in vec3 FragPos;\
 in vec3 Normal;\
 in vec2 TexCoord;\
 struct Material {sampler2D texture_diffuse0;sampler2D texture_specular0;float shininess;};\
-struct Colour {vec3 ambient;vec3 diffuse;vec3 specular;};\
-struct LightDirectional {Colour colour;vec4 direction;};\
-struct LightPoint {Colour colour;vec4 position;float linear;float quadratic;};\
-struct LightSpot {Colour colour;vec4 position;vec4 direction;float linear;float quadratic;float cutoff;float blur;};\
-uniform vec3 u_viewPos;\
+struct Light {vec4 colour;vec4 position;vec4 direction;vec4 cone;};\
+layout(std140) uniform FrameData{mat4 u_view;mat4 u_projection;mat4 u_camera;vec3 u_viewPos;float u_time;uvec4 u_clusterCount;vec4 u_clusterScale;};\
+layout(std140) uniform LightData{vec4 u_directionalColour;vec4 u_directionalDirection;uvec4 u_lightCounts;\
+Light u_pointLights[MAX_POINT_LIGHTS];Light u_spotLights[MAX_SPOT_LIGHTS];};\
 uniform Material u_material;\
-uniform LightDirectional u_directional;\
-uniform LightPoint[NR_POINT_LIGHTS] u_pointLights;\
-uniform LightSpot[NR_SPOT_LIGHTS] u_spotLights;\
 vec3 m_normal;\
 vec3 m_viewDir;\
-vec3 PhongShading(Colour pColour,vec3 pLightDir,float pIntensity){\
+vec3 PhongShading(vec3 pAmbient,vec3 pColour,vec3 pLightDir,float pIntensity){\
 vec3 diffuseTex=texture(u_material.texture_diffuse0,TexCoord).rgb;\
 vec3 specularTex=texture(u_material.texture_specular0,TexCoord).rgb;\
 float diff=max(dot(m_normal,pLightDir),0.0);\
 vec3 reflectDir=reflect(-pLightDir,m_normal);\
 float spec=pow(max(dot(m_viewDir,reflectDir),0.0),u_material.shininess);\
-vec3 ambient=pColour.ambient*diffuseTex;\
-vec3 diffuse=pColour.diffuse*diffuseTex*diff*pIntensity;\
-vec3 specular=pColour.specular*specularTex*spec*pIntensity;\
-return ambient+diffuse+specular;}\
+return pAmbient*diffuseTex+pColour*diffuseTex*diff*pIntensity+pColour*specularTex*spec*pIntensity;}\
 float CalculateAttentuation(float pDist,float pLinear,float pQuadratic){\
 return 1.0/(1.0+pLinear*pDist+pQuadratic*(pDist*pDist));}\
-vec3 CalculateDirectionalLighting(LightDirectional pLight){\
-vec3 lightDir=normalize(u_directional.direction.xyz);\
-return PhongShading(pLight.colour,lightDir,1);}\
-vec3 CalculatePointLight(LightPoint pLight){\
-if (length(pLight.linear)==0)return vec3(0);\
+vec3 CalculateLight(Light pLight,bool pSpot){\
 vec3 lightDiff=pLight.position.xyz-FragPos;\
 vec3 lightDir=normalize(lightDiff);\
-float lightDist=length(lightDiff);\
-float attenuation=CalculateAttentuation(lightDist,pLight.linear,pLight.quadratic);\
-return PhongShading(pLight.colour,lightDir,1)*attenuation;}\
-vec3 CalculateSpotLight(LightSpot pLight){\
-if (length(pLight.linear)==0)return vec3(0);\
-vec3 lightDiff=pLight.position.xyz-FragPos;\
-vec3 lightDir=normalize(lightDiff);\
-float lightDist=length(lightDiff);\
-float attenuation=CalculateAttentuation(lightDist, pLight.linear, pLight.quadratic);\
+float attenuation=CalculateAttentuation(length(lightDiff),pLight.position.w,pLight.direction.w);\
 float intensity=1;\
+if(pSpot){\
 float theta=dot(lightDir,normalize(pLight.direction.xyz));\
-float epsilon=(pLight.blur*(1-pLight.cutoff)+pLight.cutoff)-pLight.cutoff;\
-intensity=clamp((theta-pLight.cutoff)/epsilon,0.0,1.0);\
-return PhongShading(pLight.colour,lightDir,intensity)*attenuation;}\
+float epsilon=(pLight.cone.y*(1-pLight.cone.x)+pLight.cone.x)-pLight.cone.x;\
+intensity=clamp((theta-pLight.cone.x)/epsilon,0.0,1.0);}\
+return PhongShading(vec3(0),pLight.colour.rgb,lightDir,intensity)*attenuation;}\
 void main(){\
 m_normal=normalize(Normal);\
 m_viewDir=normalize(u_viewPos-FragPos);\
-vec3 result=CalculateDirectionalLighting(u_directional);\
-for(int i=0;i<NR_POINT_LIGHTS;++i)result+=CalculatePointLight(u_pointLights[i]);\
-for(int i=0;i<NR_SPOT_LIGHTS;++i)result+=CalculateSpotLight(u_spotLights[i]);\
+vec3 result=PhongShading(u_directionalColour.rgb*u_directionalColour.a,u_directionalColour.rgb,normalize(u_directionalDirection.xyz),1);\
+for(uint i=0u;i<u_lightCounts.x;++i)result+=CalculateLight(u_pointLights[i],false);\
+for(uint i=0u;i<u_lightCounts.y;++i)result+=CalculateLight(u_spotLights[i],true);\
 FragCol=vec4(result,1);return;}";
 		#pragma endregion
 
@@ -169,6 +192,10 @@ FragCol=vec4(result,1);return;}";
 		ifstream inStream;
 		string codeString;
 
+		// Where the stage is read from and compiled to
+		string path = (pType == ShaderType::VERTEX ? m_shaderPath + string(".vert") : m_fragmentPath + string(".frag"));
+		unsigned int* id = (pType == ShaderType::VERTEX ? &m_idVertex : &m_idFragment);
+
 		// Ensure ifstream objects can throw exceptions
 		inStream.exceptions(ifstream::failbit | ifstream::badbit);
 
@@ -182,7 +209,7 @@ FragCol=vec4(result,1);return;}";
 			* Convert stream into string
 			*/
 			stringstream codeStream;
-			inStream.open((pType == ShaderType::VERTEX ? m_shaderPath + string(".vert") : m_shaderPath + string(".frag")));
+			inStream.open(path);
 			codeStream << inStream.rdbuf();
 			inStream.close();
 			codeString = codeStream.str();
@@ -191,22 +218,22 @@ FragCol=vec4(result,1);return;}";
 		catch (ifstream::failure e)
 		{
 			#ifdef _DEBUG
-			 cout << "ERROR::SHADER::" << (pType == ShaderType::VERTEX ? "VERTEX" : "FRAGMENT") << "::FILE_NOT_SUCCESFULLY_READ::USING_FALLBACK" << endl;
+			 cout << "ERROR::SHADER::" << GetTypeName(pType) << "::FILE_NOT_SUCCESFULLY_READ::USING_FALLBACK" << endl;
 			#endif
 
 			code = (pType == ShaderType::VERTEX ? vertexFallback : fragmentFallback);
 		}
 
 		// 2. compile shaders
-		if (!CompileShader((pType == ShaderType::VERTEX ? &m_idVertex : &m_idFragment), pType, code))
+		if (!CompileShader(id, pType, code))
 		{
 			#ifdef _DEBUG
-			 cout << "ERROR::SHADER::" << (pType == ShaderType::VERTEX ? "VERTEX" : "FRAGMENT") << "::USING_FALLBACK_CODE\n" << endl;
+			 cout << "ERROR::SHADER::" << GetTypeName(pType) << "::USING_FALLBACK_CODE\n" << endl;
 			#endif
-			if (!CompileShader((pType == ShaderType::VERTEX ? &m_idVertex : &m_idFragment), pType, vertexFallback))
+			if (!CompileShader(id, pType, vertexFallback))
 			{
 				#ifdef _DEBUG
-			 	 cout << "ERROR::SHADER::" << (pType == ShaderType::VERTEX ? "VERTEX" : "FRAGMENT") << "::FALLBACK_CODE_FAILURE\n" << endl;
+			 	 cout << "ERROR::SHADER::" << GetTypeName(pType) << "::FALLBACK_CODE_FAILURE\n" << endl;
 				#endif
 				exit(0);
 			}
@@ -238,24 +265,47 @@ FragCol=vec4(result,1);return;}";
 
 	void Shader::CreateShaderProgram()
 	{
+		bool feedback = !m_feedbackVaryings.empty();
+
 		// Creates a shader program object assigned to id, this sets it as the active shader
 		m_idProgram = glCreateProgram();
-		// Link the vertex and fragment shaders
+		// Link the vertex and fragment shaders, only the vertex shader when capturing
 		glAttachShader(m_idProgram, m_idVertex);
-		glAttachShader(m_idProgram, m_idFragment);
+		if (!feedback)
+			glAttachShader(m_idProgram, m_idFragment);
+		else
+		{
+			// Which outputs are captured has to be set before linking
+			vector<const char*> names;
+			for (const string& varying : m_feedbackVaryings)
+				names.push_back(varying.c_str());
+			glTransformFeedbackVaryings(m_idProgram, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+		}
 		glLinkProgram(m_idProgram);
 		// Performs error checking on the shader program
 		ShaderErrorChecking(&m_idProgram, ShaderType::PROGRAM);
 		// We no longer need the vertex and fragment shaders
 		glDeleteShader(m_idVertex);
-		glDeleteShader(m_idFragment);
+		if (!feedback)
+			glDeleteShader(m_idFragment);
+
+		// Gl 3.3 can't set the binding in the shader so the shared blocks are pointed at theirs here
+		BindUniformBlock("FrameData", FrameUniforms::s_binding);
+		BindUniformBlock("LightData", LightRegistry::s_binding);
 
 		// Sets the shader as the active one
-		glUseProgram(m_idProgram);
+		GLState::UseProgram(m_idProgram);
 
 		m_shaderLoaded = true;
 	}
 		
+	void Shader::BindUniformBlock(const char* pName, unsigned int pBinding)
+	{
+		unsigned int block = glGetUniformBlockIndex(m_idProgram, pName);
+		if (block != GL_INVALID_INDEX)
+			glUniformBlockBinding(m_idProgram, block, pBinding);
+	}
+
 	bool Shader::ShaderErrorChecking(unsigned int *pShaderID, ShaderType pType)
 	{
 		// Variables used in error checking and handling
@@ -285,7 +335,7 @@ FragCol=vec4(result,1);return;}";
 				// In the case of a failure it loads the log and outputs
 				glGetShaderInfoLog(*pShaderID, 512, NULL, infoLog);
 				#ifdef _DEBUG
-				 cout << "ERROR::SHADER::" << (pType == ShaderType::VERTEX ? "VERTEX" : "FRAGMENT") << "::COMPILATION_FAILED\n" << infoLog << endl;
+				 cout << "ERROR::SHADER::" << GetTypeName(pType) << "::COMPILATION_FAILED\n" << infoLog << endl;
 				#endif
 				return false;
 			}
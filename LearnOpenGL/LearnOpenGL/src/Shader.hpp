@@ -1,10 +1,12 @@
 #pragma region
 #pragma once
 #include <string>
+#include <vector>
 #include <fstream>
 #include "glm/glm.hpp"
 
 using std::string;
+using std::vector;
 #pragma endregion
 
 namespace Engine
@@ -27,6 +29,21 @@ namespace Engine
 		 * @param pFragmentPath The file path to the fragment shader
 		 */
 		Shader(string pShaderPath);
+		/**
+		 * @brief Construct a new Shader object from a vertex and fragment shader that don't share a name
+		 *
+		 * @param pVertexPath The file path to the vertex shader, without the extension
+		 * @param pFragmentPath The file path to the fragment shader, without the extension
+		 */
+		Shader(string pVertexPath, string pFragmentPath);
+		/**
+		 * @brief Construct a new Shader object whose vertex outputs are captured with transform feedback instead of
+		 * drawn, it has no fragment shader
+		 *
+		 * @param pVertexPath The file path to the vertex shader, without the extension
+		 * @param pFeedbackVaryings The outputs captured, interleaved in this order
+		 */
+		Shader(string pVertexPath, const vector<string>& pFeedbackVaryings);
 
 		#pragma region Copy constructors
 		Shader(const Shader& pOther);
@@ -48,8 +65,32 @@ namespace Engine
 		 */
 		void Use();
 		void LoadPaths(string pShaderPath);
+		void LoadPaths(string pVertexPath, string pFragmentPath);
 
+		/**
+		 * @brief Sets the shader used instead when copies drawn with this one are merged into an instanced draw,
+		 * it must read its model matrix from the per instance attribute
+		 *
+		 * @param pShader The instanced shader, nullptr to never merge
+		 */
+		void SetInstancedVariant(Shader* pShader) { m_instancedVariant = pShader; }
+		Shader* GetInstancedVariant() const { return m_instancedVariant; }
+		/**
+		 * @brief Sets the shader used instead while deferred shading, it must write the surface to the g-buffer
+		 *
+		 * @param pShader The g-buffer shader, nullptr to draw forward after lighting
+		 */
+		void SetDeferredVariant(Shader* pShader) { m_deferredVariant = pShader; }
+		Shader* GetDeferredVariant() const { return m_deferredVariant; }
+		/**
+		 * @brief Sets the shader the depth pre-pass draws with, it must place vertices exactly as this one does
+		 *
+		 * @param pShader The depth only shader, nullptr to leave draws with this shader out of the pre-pass
+		 */
+		void SetDepthVariant(Shader* pShader) { m_depthVariant = pShader; }
+		Shader* GetDepthVariant() const { return m_depthVariant; }
 		bool GetLoaded() const { return m_shaderLoaded; }
+		unsigned int GetProgram() const { return m_idProgram; }
 
 	private:
 		/**
@@ -71,6 +112,13 @@ namespace Engine
 		 * @brief Create a Shader Program object and link the vertex and fragment code
 		 */
 		void CreateShaderProgram();
+		/**
+		 * @brief Points a uniform block at a binding point, if the shader uses it
+		 *
+		 * @param pName The name of the block
+		 * @param pBinding The binding point
+		 */
+		void BindUniformBlock(const char* pName, unsigned int pBinding);
 
 		/**
 		 * @brief Checks a shader for errors while loading and logs them
@@ -84,6 +132,11 @@ namespace Engine
 		bool m_shaderLoaded = false;
 		unsigned int m_idProgram, m_idVertex, m_idFragment;
 		string m_shaderPath;	// The file path of the shaders
+		string m_fragmentPath;	// The file path of the fragment shader, the same as above unless given separately
+		vector<string> m_feedbackVaryings;	// Captured with transform feedback, there is no fragment shader when set
+		Shader* m_instancedVariant = nullptr;
+		Shader* m_deferredVariant = nullptr;
+		Shader* m_depthVariant = nullptr;
 
 		#pragma region Setters
 	public:
@@ -0,0 +1,76 @@
+#pragma region
+#pragma once
+#include <atomic>
+#include <cstddef>
+#pragma endregion
+
+namespace Engine
+{
+	/**
+	 * @brief A fixed size lock-free queue for exactly one producer thread and one consumer thread
+	 *
+	 * @tparam T The type held, copied in and out
+	 * @tparam N The capacity, must be a power of two
+	 */
+	template<typename T, size_t N>
+	class SpscRing
+	{
+		static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+	public:
+		SpscRing() = default;
+		~SpscRing() {}
+
+		/**
+		 * @brief Adds a value to the back, only call from the producer
+		 *
+		 * @param pValue The value to add
+		 * @return False if the ring was full and the value was dropped
+		 */
+		bool Push(const T& pValue)
+		{
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if (head - m_tail.load(std::memory_order_acquire) == N)
+				return false;
+
+			m_items[head & (N - 1)] = pValue;
+			// Publishes the write of the item along with the new head
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+		/**
+		 * @brief Takes the value from the front, only call from the consumer
+		 *
+		 * @param pValue Filled with the value
+		 * @return False if the ring was empty
+		 */
+		bool Pop(T& pValue)
+		{
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail == m_head.load(std::memory_order_acquire))
+				return false;
+
+			pValue = m_items[tail & (N - 1)];
+			// Hands the slot back to the producer only after it has been read
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool GetEmpty() const { return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire); }
+		static constexpr size_t GetCapacity() { return N; }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, the atomics can't be copied safely while in use.
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+		SpscRing(SpscRing&&) = delete;
+		SpscRing& operator=(SpscRing&&) = delete;
+		#pragma endregion
+
+		// Kept on separate cache lines so the two threads don't fight over them
+		alignas(64) std::atomic<size_t> m_head = 0;	// Next slot to write, only written by the producer
+		alignas(64) std::atomic<size_t> m_tail = 0;	// Next slot to read, only written by the consumer
+		T m_items[N];
+	};
+}
@@ -3,6 +3,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 #include "Texture.hpp"
+#include "GLState.hpp"
 #ifdef _DEBUG
  #include <iostream>
  using std::cout;
@@ -24,6 +25,7 @@ namespace Engine
 	void Texture::Destroy()
 	{
 		glDeleteTextures(1, &s_idTex[m_id]);
+		GLState::Invalidate();
 	}
 
 	// Static
@@ -32,6 +34,7 @@ namespace Engine
 		if (pValidate)
 		{
 			glDeleteTextures(s_numTex, s_idTex);
+			GLState::Invalidate();
 		}
 	}
 
@@ -58,10 +61,9 @@ namespace Engine
 		{
 			float borderColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
 			// Generates a texture object in vram
-			glActiveTexture(GL_TEXTURE0 + s_numTex);
 			glGenTextures(1, &s_idTex[s_numTex]);
 			// Remember this works like a pointer to the object using the ID
-			glBindTexture(GL_TEXTURE_2D, s_idTex[s_numTex]);
+			GLState::BindTexture(s_numTex, GL_TEXTURE_2D, s_idTex[s_numTex]);
 			// Sets some parameters to the currently bound texture object
 			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColour);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
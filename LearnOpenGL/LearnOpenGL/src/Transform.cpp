@@ -40,36 +40,47 @@ namespace Engine
 	void Transform::SetTransform(mat4 pValue)
 	{
 		m_transform = pValue;
+		m_dirty = true;
 	}
 
 	void Transform::SetPosition(vec3 pValue)
 	{
 		m_transform[3] = vec4(pValue, m_transform[3][3]);
+		m_dirty = true;
 	}
 
 	void Transform::SetPosition(vec4 pValue)
 	{
 		m_transform[3] = pValue;
+		m_dirty = true;
 	}
 
 	void Transform::Translate(vec3 pValue)
 	{
+		// Translating by nothing happens every frame without input so it shouldn't dirty
+		if (pValue == vec3(0))
+			return;
+
 		m_transform[3] = vec4((vec3)m_transform[3] + pValue, m_transform[3][3]);
+		m_dirty = true;
 	}
 
 	void Transform::SetRight(vec3 pValue)
 	{
 		m_transform[0] = vec4(pValue, 0);
+		m_dirty = true;
 	}
 
 	void Transform::SetUp(vec3 pValue)
 	{
 		m_transform[1] = vec4(pValue, 0);
+		m_dirty = true;
 	}
 
 	void Transform::SetForward(vec3 pValue)
 	{
 		m_transform[2] = vec4(pValue, 0);
+		m_dirty = true;
 	}
 	#pragma endregion
 	#pragma region Getters
@@ -39,9 +39,19 @@ namespace Engine
 		virtual vec3 GetRight() const;
 		virtual vec3 GetUp() const;
 		virtual vec3 GetForward() const;
+		/**
+		 * @brief Whether the transform has changed since ClearDirty() was last called
+		 */
+		bool GetDirty() const { return m_dirty; }
 		#pragma endregion
 
+		/**
+		 * @brief Marks the current state as seen, used by the renderer to skip redrawing unchanged scenes
+		 */
+		void ClearDirty() { m_dirty = false; }
+
 	protected:
 		mat4 m_transform = mat4(1);
+		bool m_dirty = true;	// Set by every setter that changes the transform
 	};
 }
@@ -0,0 +1,111 @@
+#pragma region
+#include "WorkerPool.hpp"
+#include <algorithm>
+
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+#pragma endregion
+
+namespace Engine
+{
+	WorkerPool::~WorkerPool()
+	{
+		Stop();
+	}
+
+	void WorkerPool::Start(unsigned int pThreads)
+	{
+		if (!m_threads.empty())
+			return;
+
+		if (pThreads == 0U)
+		{
+			unsigned int hardware = std::thread::hardware_concurrency();
+			pThreads = (hardware > 1U ? hardware - 1U : 0U);
+		}
+
+		m_stopping = false;
+		for (unsigned int i = 0; i < pThreads; ++i)
+			m_threads.emplace_back(&WorkerPool::Loop, this);
+	}
+
+	void WorkerPool::Stop()
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wakeCondition.notify_all();
+
+		for (std::thread& thread : m_threads)
+			thread.join();
+		m_threads.clear();
+	}
+
+	void WorkerPool::ParallelFor(unsigned int pCount, unsigned int pGrain, const function<void(unsigned int, unsigned int)>& pJob)
+	{
+		if (pCount == 0U)
+			return;
+
+		pGrain = std::max(pGrain, 1U);
+		// Not worth waking anyone for a single chunk
+		if (m_threads.empty() || pCount <= pGrain)
+		{
+			pJob(0U, pCount);
+			return;
+		}
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_job = &pJob;
+			m_count = pCount;
+			m_grain = pGrain;
+			m_next.store(0U);
+			m_busy = (unsigned int)m_threads.size();
+			++m_generation;
+		}
+		m_wakeCondition.notify_all();
+
+		RunChunks();
+
+		// The job is on the caller's stack so every worker has to be out of it before returning
+		unique_lock<mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this] { return m_busy == 0U; });
+		m_job = nullptr;
+	}
+
+	void WorkerPool::Loop()
+	{
+		unsigned int seen = 0U;
+		while (true)
+		{
+			{
+				unique_lock<mutex> lock(m_mutex);
+				m_wakeCondition.wait(lock, [this, seen] { return m_stopping || m_generation != seen; });
+				if (m_stopping)
+					return;
+				seen = m_generation;
+			}
+
+			RunChunks();
+
+			{
+				lock_guard<mutex> lock(m_mutex);
+				--m_busy;
+			}
+			m_doneCondition.notify_one();
+		}
+	}
+
+	void WorkerPool::RunChunks()
+	{
+		while (true)
+		{
+			unsigned int begin = m_next.fetch_add(m_grain);
+			if (begin >= m_count)
+				return;
+			(*m_job)(begin, std::min(begin + m_grain, m_count));
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma region
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using std::vector;
+using std::function;
+#pragma endregion
+
+namespace Engine
+{
+	// A fixed set of threads that split loops between them, the calling thread helps so nothing waits idle
+	class WorkerPool
+	{
+	public:
+		WorkerPool() = default;
+		~WorkerPool();
+
+		/**
+		 * @brief Starts the worker threads, does nothing if already started
+		 *
+		 * @param pThreads How many threads to start, 0 for one less than the hardware has
+		 */
+		void Start(unsigned int pThreads = 0U);
+		/**
+		 * @brief Joins the worker threads, loops still run on the calling thread afterwards
+		 */
+		void Stop();
+		/**
+		 * @brief Runs a job over a range split into chunks shared between the threads, returns once all are done.
+		 * Chunks of the same call can run at the same time so they must not write to the same memory
+		 *
+		 * @param pCount The size of the range
+		 * @param pGrain The most items handed out at once, bigger means less contention
+		 * @param pJob Called with the start and end of each chunk
+		 */
+		void ParallelFor(unsigned int pCount, unsigned int pGrain, const function<void(unsigned int, unsigned int)>& pJob);
+
+		/**
+		 * @brief How many threads a loop is split between, including the calling thread
+		 */
+		unsigned int GetThreadCount() const { return (unsigned int)m_threads.size() + 1U; }
+
+	private:
+		#pragma region Constructors
+		// Delete copy/move, the threads hold a pointer to this instance.
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		WorkerPool(WorkerPool&&) = delete;
+		WorkerPool& operator=(WorkerPool&&) = delete;
+		#pragma endregion
+
+		/**
+		 * @brief The body of each worker thread
+		 */
+		void Loop();
+		/**
+		 * @brief Takes chunks of the current job until there are none left
+		 */
+		void RunChunks();
+
+		vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeCondition, m_doneCondition;
+		const function<void(unsigned int, unsigned int)>* m_job = nullptr;
+		std::atomic<unsigned int> m_next = { 0U };	// The start of the next chunk handed out
+		unsigned int m_count = 0U, m_grain = 1U;
+		unsigned int m_generation = 0U;		// Bumped for every job so sleeping workers know there is a new one
+		unsigned int m_busy = 0U;			// Workers yet to finish the current job
+		bool m_stopping = false;
+	};
+}
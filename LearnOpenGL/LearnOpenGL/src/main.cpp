@@ -13,10 +13,140 @@
 */
 
 #include "Project.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
 
-int main()
+/* Optional arguments:
+* --headless			Render offscreen through EGL, needs a HEADLESS_EGL build
+* --frames <n>			Record a benchmark and exit after n frames
+* --seconds <s>			Record a benchmark and exit after s seconds
+* --output <file>		Where the benchmark json is written, defaults to benchmark.json
+* --tick-rate <hz>		How many fixed updates run per second, defaults to 60
+* --fps <n>				Limit the frame rate, defaults to unlimited
+* --on-demand <s>		Only redraw when the scene changes, or at least every s seconds (0 for never)
+* --paused				Start with scene animations paused
+* --boxes <n>			How many boxes the box scene draws, defaults to 10
+* --point-lights <n>	How many point lights light the scene, defaults to 1
+* --clustered			Shade with only the lights binned into each fragment's cluster
+* --deferred			Draw surfaces into a g-buffer then light them with light volumes
+* --depth-prepass		Lay down depth first so each pixel is only shaded once
+* --occlusion			Skip boxes hidden behind other boxes, tested against a small depth buffer drawn on the cpu
+* --gpu-occlusion		Cull instanced copies on the gpu against a depth pyramid of the frame before
+* --pvs					Skip what the camera's cell can't see, using sets stored next to the scene by --bake-pvs
+* --bake-pvs			Bake the scene's potentially visible sets, store them next to it and exit
+* --render-thread		Draw and swap on a separate thread fed with frame snapshots
+* --late-latch			Sample the cursor again right before drawing to cut mouse latency
+* --record <file>		Record the input of every frame to a file
+* --replay <file>		Play back recorded input with its delta times, exits at the end of the recording
+* --frames-in-flight <n>	Limit how many frames the gpu can have queued, 1 to 3, defaults to unlimited
+* --stats <file>		Where the per-phase frame timings csv is written, defaults to frame_stats.csv
+*/
+int main(int argc, char* argv[])
 {
+	bool headless = false;
+	unsigned int frames = 0U;
+	double seconds = 0.0;
+	const char* output = "benchmark.json";
+	const char* stats = "frame_stats.csv";
+	const char* record = nullptr;
+	const char* replay = nullptr;
+	double tickRate = 60.0;
+	double targetFps = 0.0;
+	bool onDemand = false, paused = false, renderThread = false, lateLatch = false;
+	unsigned int framesInFlight = 0U;
+	unsigned int boxes = 10U, pointLights = 1U;
+	bool clustered = false, deferred = false, depthPrepass = false, occlusion = false, gpuOcclusion = false, pvs = false, bakePvs = false;
+	double keepAlive = 1.0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frames = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+			seconds = std::strtod(argv[++i], nullptr);
+		else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+			stats = argv[++i];
+		else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+			tickRate = std::strtod(argv[++i], nullptr);
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			targetFps = std::strtod(argv[++i], nullptr);
+		else if (std::strcmp(argv[i], "--on-demand") == 0 && i + 1 < argc)
+		{
+			onDemand = true;
+			keepAlive = std::strtod(argv[++i], nullptr);
+		}
+		else if (std::strcmp(argv[i], "--paused") == 0)
+			paused = true;
+		else if (std::strcmp(argv[i], "--boxes") == 0 && i + 1 < argc)
+			boxes = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--point-lights") == 0 && i + 1 < argc)
+			pointLights = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--clustered") == 0)
+			clustered = true;
+		else if (std::strcmp(argv[i], "--deferred") == 0)
+			deferred = true;
+		else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+			depthPrepass = true;
+		else if (std::strcmp(argv[i], "--occlusion") == 0)
+			occlusion = true;
+		else if (std::strcmp(argv[i], "--gpu-occlusion") == 0)
+			gpuOcclusion = true;
+		else if (std::strcmp(argv[i], "--pvs") == 0)
+			pvs = true;
+		else if (std::strcmp(argv[i], "--bake-pvs") == 0)
+			bakePvs = true;
+		else if (std::strcmp(argv[i], "--render-thread") == 0)
+			renderThread = true;
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			record = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			replay = argv[++i];
+		else if (std::strcmp(argv[i], "--late-latch") == 0)
+			lateLatch = true;
+		else if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+			framesInFlight = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+	}
+
+	// Headless has no window to close so it always needs a limit, a replay ends by itself
+	if (headless && frames == 0U && seconds <= 0.0 && replay == nullptr)
+		frames = 1000U;
+
 	Project* app = new Project();
+	app->SetHeadless(headless);
+	app->SetStatsOutput(stats);
+	if (tickRate > 0.0)
+		app->SetFixedDeltaTime(1.0 / tickRate);
+	app->SetTargetFrameRate(targetFps);
+	app->SetRenderOnDemand(onDemand, keepAlive);
+	app->SetAnimating(!paused);
+	app->SetBoxCount(boxes);
+	app->SetPointLightCount(pointLights);
+	app->SetClustered(clustered);
+	app->SetDeferred(deferred);
+	app->SetDepthPrepass(depthPrepass);
+	app->SetOcclusionCulling(occlusion);
+	app->SetGpuOcclusion(gpuOcclusion);
+	app->SetPvsCulling(pvs);
+	app->SetPvsBake(bakePvs);
+	app->SetRenderThreaded(renderThread);
+	app->SetMaxFramesInFlight(framesInFlight);
+	app->SetLateLatch(lateLatch);
+	if (record != nullptr)
+		app->SetInputRecording(record);
+	// Without its recording a replay would never end, headless or not
+	if (replay != nullptr && !app->SetInputReplay(replay))
+	{
+		std::fprintf(stderr, "Could not load the input replay \"%s\"\n", replay);
+		delete app;
+		return 1;
+	}
+	if ((frames > 0U || seconds > 0.0) && !bakePvs)
+		app->SetBenchmark(frames, seconds, output);
 	app->Run(1600, 900, "OpenGL", false);
 	delete app;
 	return 0;